@@ -0,0 +1,261 @@
+#include "accuracy_benchmark.hpp"
+
+#include "runge_kutta.hpp"
+#include "scheme.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <omp.h>
+#include <utility>
+#include <vector>
+
+namespace {
+    /// Assez de tâches pour occuper tous les threads avec l'échantillon
+    constexpr std::size_t particlesPerTask = 256;
+    constexpr std::size_t maxParticles = 4096;
+    /// Mesures de chaque configuration, dont la médiane est retenue
+    constexpr std::size_t nbRepeats = 5;
+    /// Pas de temps balayés, du plus grand au plus petit
+    constexpr double timeSteps[] = { 0.4, 0.2, 0.1, 0.05, 0.025 };
+    /// Pas de grille balayés, relatifs à celui du scénario ; 0 : vitesse
+    /// sommée directement sur les tourbillons
+    constexpr double gridFactors[] = { 2., 1., 0.5, 0.25, 0. };
+    constexpr Numeric::Scheme schemes[] = { Numeric::Scheme::Heun, Numeric::Scheme::RK3,
+                                            Numeric::Scheme::RK4, Numeric::Scheme::RK5 };
+    /// Pas de la référence : celui du plus petit pas balayé divisé par
+    /// referenceRefinement
+    constexpr std::size_t referenceRefinement = 16;
+
+    struct Configuration {
+        double dt;
+        std::size_t nbSteps;
+        /// Pas de la grille, 0 pour la vitesse directe
+        double h;
+        Numeric::Scheme scheme;
+        const char * precision;
+        double rmsError = 0., maxError = 0.;
+        double seconds = 0.;
+        bool isPareto = false;
+    };
+
+    struct Errors {
+        double max = 0., rms = 0.;
+    };
+
+    /// Distances sur le tore entre les positions de deux nuages
+    template <typename RealType>
+    Errors distances(const Geometry::BasicCloudOfPoints<RealType> & t_points,
+                     const Geometry::BasicCloudOfPoints<double> & t_reference,
+                     double t_width,
+                     double t_height) {
+        std::size_t nbPoints = t_reference.numberOfPoints();
+        double maxDist = 0., sumSqrDist = 0.;
+#pragma omp parallel for reduction(max : maxDist) reduction(+ : sumSqrDist)
+        for (std::size_t iPoint = 0; iPoint < nbPoints; ++iPoint) {
+            double dx = std::abs(double(t_points[iPoint].x) - t_reference[iPoint].x);
+            double dy = std::abs(double(t_points[iPoint].y) - t_reference[iPoint].y);
+            dx = std::min(dx, t_width - dx);
+            dy = std::min(dy, t_height - dy);
+            double sqrDist = dx * dx + dy * dy;
+            maxDist = std::max(maxDist, std::sqrt(sqrDist));
+            sumSqrDist += sqrDist;
+        }
+        return { maxDist, nbPoints > 0 ? std::sqrt(sumSqrDist / nbPoints) : 0. };
+    }
+
+    /**
+     * @brief Advect t_sample over t_nbSteps steps of t_dt in RealType, with
+     * the velocity interpolated in a grid of step t_h (direct if t_h is 0),
+     * and return the final positions and the median wall time of
+     * t_nbRepeats runs, field included
+     */
+    template <typename RealType>
+    std::pair<Geometry::BasicCloudOfPoints<RealType>, double>
+    advect(Numeric::Scheme t_scheme,
+           double t_dt,
+           std::size_t t_nbSteps,
+           double t_h,
+           const Simulation::Vortices & t_vortices,
+           const Numeric::CartesianGridOfSpeed & t_grid,
+           const Geometry::CloudOfPoints & t_sample,
+           std::size_t t_nbRepeats) {
+        using point = typename Geometry::BasicCloudOfPoints<RealType>::point;
+        std::size_t nbPoints = t_sample.numberOfPoints();
+        Geometry::BasicCloudOfPoints<RealType> points(nbPoints), newPoints(nbPoints);
+        std::vector<double> seconds;
+        for (std::size_t iRepeat = 0; iRepeat < t_nbRepeats; ++iRepeat) {
+            for (std::size_t iPoint = 0; iPoint < nbPoints; ++iPoint)
+                points[iPoint] = point { t_sample[iPoint] };
+
+            double t0 = omp_get_wtime();
+            // Même domaine, avec des cellules carrées de pas voisin de t_h
+            auto origin = t_grid.getLeftBottomVertex();
+            double width = t_grid.getRightTopVertex().x - origin.x;
+            double height = t_grid.getRightTopVertex().y - origin.y;
+            auto dimensions = t_grid.cellGeometry();
+            double step = t_grid.getStep();
+            if (t_h > 0.) {
+                dimensions.first = std::max<std::size_t>(1, std::llround(width / t_h));
+                step = width / dimensions.first;
+                dimensions.second = std::max<std::size_t>(1, std::llround(height / step));
+            }
+            Numeric::BasicCartesianGridOfSpeed<RealType> grid(dimensions, origin, step);
+            if (t_h > 0.)
+                grid.updateVelocityField(t_vortices);
+            for (std::size_t iStep = 0; iStep < t_nbSteps; ++iStep) {
+#pragma omp parallel for schedule(static)
+                for (std::size_t first = 0; first < nbPoints; first += particlesPerTask) {
+                    std::size_t last = std::min(first + particlesPerTask, nbPoints);
+                    if (t_h > 0.)
+                        Numeric::solve_particles(t_scheme, t_dt, grid, points, newPoints,
+                                                 first, last);
+                    else
+                        Numeric::solve_particles_direct(t_scheme, t_dt, t_vortices, grid,
+                                                        points, newPoints, first, last);
+                }
+                std::swap(points, newPoints);
+            }
+            seconds.push_back(omp_get_wtime() - t0);
+        }
+        std::nth_element(seconds.begin(), seconds.begin() + seconds.size() / 2, seconds.end());
+        return { std::move(points), seconds[seconds.size() / 2] };
+    }
+} // namespace
+
+int runAccuracyBenchmark(double t_duration,
+                         double t_errorBudget,
+                         const std::string & t_output,
+                         const Simulation::Vortices & t_vortices,
+                         bool isMobile,
+                         const Numeric::CartesianGridOfSpeed & t_grid,
+                         const Geometry::CloudOfPoints & t_cloud) {
+    if (isMobile) {
+        std::cerr << "The accuracy benchmark needs fixed vortices!" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::ofstream output(t_output);
+    if (!output) {
+        std::cerr << "Cannot open " << t_output << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Échantillon régulier des particules du scénario
+    std::size_t stride = std::max<std::size_t>(1, t_cloud.numberOfPoints() / maxParticles);
+    Geometry::CloudOfPoints sample(t_cloud.numberOfPoints() / stride);
+    for (std::size_t iPoint = 0; iPoint < sample.numberOfPoints(); ++iPoint)
+        sample[iPoint] = t_cloud[iPoint * stride];
+    std::size_t nbPoints = sample.numberOfPoints();
+    double width = t_grid.getRightTopVertex().x - t_grid.getLeftBottomVertex().x;
+    double height = t_grid.getRightTopVertex().y - t_grid.getLeftBottomVertex().y;
+    auto nbStepsOf = [&](double t_dt) {
+        return std::max<std::size_t>(1, std::llround(t_duration / t_dt));
+    };
+
+    std::cout << "Accuracy benchmark : " << nbPoints << " particles over a duration of "
+              << t_duration << std::endl;
+    std::size_t nbReferenceSteps =
+        referenceRefinement * nbStepsOf(timeSteps[std::size(timeSteps) - 1]);
+    auto reference = advect<double>(Numeric::Scheme::RK5, t_duration / nbReferenceSteps,
+                                    nbReferenceSteps, 0., t_vortices, t_grid, sample, 1)
+                         .first;
+    auto coarser = advect<double>(Numeric::Scheme::RK5, 2. * t_duration / nbReferenceSteps,
+                                  nbReferenceSteps / 2, 0., t_vortices, t_grid, sample, 1)
+                       .first;
+    auto referenceError = distances(coarser, reference, width, height);
+    std::cout << std::scientific << std::setprecision(3) << "reference : " << nbReferenceSteps
+              << " steps of rk5 with the direct velocity, distance to half as many steps : max "
+              << referenceError.max << ", rms " << referenceError.rms << std::endl;
+
+    std::vector<Configuration> configurations;
+    for (double factor : gridFactors) {
+        for (Numeric::Scheme scheme : schemes) {
+            for (double dt : timeSteps) {
+                for (const char * precision : { "float", "double" }) {
+                    std::size_t nbSteps = nbStepsOf(dt);
+                    Configuration configuration { t_duration / nbSteps, nbSteps,
+                                                  factor * t_grid.getStep(), scheme,
+                                                  precision };
+                    Errors errors;
+                    if (precision[0] == 'f') {
+                        auto [points, seconds] =
+                            advect<float>(scheme, configuration.dt, nbSteps, configuration.h,
+                                          t_vortices, t_grid, sample, nbRepeats);
+                        errors = distances(points, reference, width, height);
+                        configuration.seconds = seconds;
+                    } else {
+                        auto [points, seconds] =
+                            advect<double>(scheme, configuration.dt, nbSteps, configuration.h,
+                                           t_vortices, t_grid, sample, nbRepeats);
+                        errors = distances(points, reference, width, height);
+                        configuration.seconds = seconds;
+                    }
+                    configuration.maxError = errors.max;
+                    configuration.rmsError = errors.rms;
+                    configurations.push_back(configuration);
+                }
+            }
+        }
+    }
+
+    // Front de Pareto : aucune configuration moins chère n'est plus précise
+    std::vector<Configuration *> byCost;
+    for (auto & configuration : configurations)
+        byCost.push_back(&configuration);
+    std::sort(byCost.begin(), byCost.end(),
+              [](const Configuration * a, const Configuration * b) {
+                  return a->seconds < b->seconds;
+              });
+    double bestError = HUGE_VAL;
+    for (Configuration * configuration : byCost) {
+        if (configuration->rmsError < bestError) {
+            configuration->isPareto = true;
+            bestError = configuration->rmsError;
+        }
+    }
+
+    output << "velocity,h,dt,steps,scheme,precision,rms_error,max_error,seconds,pareto\n"
+           << std::setprecision(6);
+    for (const auto & configuration : configurations)
+        output << (configuration.h > 0. ? "grid" : "direct") << ',' << configuration.h << ','
+               << configuration.dt << ',' << configuration.nbSteps << ','
+               << Numeric::schemeName(configuration.scheme) << ',' << configuration.precision
+               << ',' << configuration.rmsError << ',' << configuration.maxError << ','
+               << configuration.seconds << ',' << (configuration.isPareto ? 1 : 0) << '\n';
+
+    auto print = [](const Configuration & t_configuration) {
+        std::cout << std::setprecision(3) << std::scientific << "  rms " << t_configuration.rmsError
+                  << " max " << t_configuration.maxError << std::fixed << " time "
+                  << 1.E3 * t_configuration.seconds << " ms : "
+                  << Numeric::schemeName(t_configuration.scheme) << ", dt = "
+                  << std::defaultfloat << t_configuration.dt << ", ";
+        if (t_configuration.h > 0.)
+            std::cout << "grid h = " << t_configuration.h;
+        else
+            std::cout << "direct velocity";
+        std::cout << ", " << t_configuration.precision << std::endl;
+    };
+    std::cout << "Pareto front of the time and of the rms error (" << configurations.size()
+              << " configurations written in " << t_output << ") :" << std::endl;
+    for (const Configuration * configuration : byCost)
+        if (configuration->isPareto)
+            print(*configuration);
+    if (t_errorBudget > 0.) {
+        auto cheapest = std::find_if(byCost.begin(), byCost.end(),
+                                     [&](const Configuration * t_configuration) {
+                                         return t_configuration->rmsError <= t_errorBudget;
+                                     });
+        std::cout << std::defaultfloat << "Cheapest configuration within an rms error of "
+                  << t_errorBudget << " :" << std::endl;
+        if (cheapest != byCost.end())
+            print(**cheapest);
+        else
+            std::cout << "  none" << std::endl;
+    }
+    std::cout << std::defaultfloat;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,40 @@
+#ifndef _ACCURACY_BENCHMARK_HPP_
+#define _ACCURACY_BENCHMARK_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "cloud_of_points.hpp"
+#include "vortex.hpp"
+
+#include <string>
+
+/**
+ * @brief Compare the accuracy and the cost of the configurations of the
+ * advection of the particles around fixed vortices
+ *
+ * For a single vortex of intensity K, a particle at a distance r >= 1 of the
+ * center orbits at the angular speed K/r², perturbed by the periodic images
+ * of the vortex. The reference trajectories are those of the exact velocity
+ * (the vortices and their images, see Vortices::computeSpeed) integrated with
+ * RK5 on steps 16 times smaller than the smallest step of the sweep ; their
+ * own error is estimated against twice larger steps.
+ *
+ * A sample of the particles of t_cloud is then advected over the duration
+ * t_duration for every time step, grid step (multiple of the one of t_grid,
+ * or the direct velocity), scheme and precision. The distances to the
+ * reference at the end (maximum and root mean square) and the median wall
+ * time of 5 runs of each configuration, field included, are written as CSV in
+ * t_output, and the Pareto front of the cost and of the rms error is printed
+ * along with the cheapest configuration within t_errorBudget (if positive).
+ *
+ * Runs in a single process, without display nor MPI.
+ *
+ * @return The exit code of the program
+ */
+int runAccuracyBenchmark(double t_duration,
+                         double t_errorBudget,
+                         const std::string & t_output,
+                         const Simulation::Vortices & t_vortices,
+                         bool isMobile,
+                         const Numeric::CartesianGridOfSpeed & t_grid,
+                         const Geometry::CloudOfPoints & t_cloud);
+
+#endif
@@ -1,26 +1,54 @@
 #include "cartesian_grid_of_speed.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <omp.h>
 
 using namespace Numeric;
 
-CartesianGridOfSpeed::CartesianGridOfSpeed(std::pair<std::size_t, std::size_t> t_dimensions,
-                                           Geometry::Point<double> t_origin,
-                                           double t_hStep)
+template <typename RealType>
+BasicCartesianGridOfSpeed<RealType>::BasicCartesianGridOfSpeed(
+    std::pair<std::size_t, std::size_t> t_dimensions,
+    Geometry::Point<double> t_origin,
+    double t_hStep)
     : m_width(t_dimensions.first),
       m_height(t_dimensions.second),
       m_left(t_origin.x),
       m_bottom(t_origin.y),
       m_step(t_hStep),
-      m_velocityField(t_dimensions.first * t_dimensions.second) {
+      m_velocityField(t_dimensions.first * t_dimensions.second),
+      m_pendingVelocityField(t_dimensions.first * t_dimensions.second) {
     assert(m_width > 0);
     assert(m_height > 0);
     assert(m_step > 0.);
+    m_nbTilesX = (m_width + tileSize - 1) / tileSize;
+    m_tiles = DirtyTiles(m_nbTilesX * ((m_height + tileSize - 1) / tileSize));
 }
 
-void CartesianGridOfSpeed::updateVelocityField(const Simulation::Vortices & t_vortices) {
+template <typename RealType>
+BasicCartesianGridOfSpeed<RealType>::BasicCartesianGridOfSpeed(
+    std::pair<std::size_t, std::size_t> t_dimensions,
+    Geometry::Point<double> t_origin,
+    double t_hStep,
+    const allocator_type & t_allocator)
+    : m_width(t_dimensions.first),
+      m_height(t_dimensions.second),
+      m_left(t_origin.x),
+      m_bottom(t_origin.y),
+      m_step(t_hStep),
+      m_velocityField(t_dimensions.first * t_dimensions.second, t_allocator),
+      m_pendingVelocityField(t_dimensions.first * t_dimensions.second) {
+    assert(m_width > 0);
+    assert(m_height > 0);
+    assert(m_step > 0.);
+    m_nbTilesX = (m_width + tileSize - 1) / tileSize;
+    m_tiles = DirtyTiles(m_nbTilesX * ((m_height + tileSize - 1) / tileSize));
+}
+
+template <typename RealType>
+void BasicCartesianGridOfSpeed<RealType>::updateVelocityField(
+    const Simulation::Vortices & t_vortices) {
     using point = Simulation::Vortices::point;
     double halfStep = 0.5 * m_step;
 
@@ -31,35 +59,167 @@ void CartesianGridOfSpeed::updateVelocityField(const Simulation::Vortices & t_vo
             std::size_t index = iRow * m_width + jCol;
             // Calcul de la coordonnée du centre de la cellule :
             point p { m_left + m_step * jCol + halfStep, yP };
-            m_velocityField[index] = t_vortices.computeSpeed(p);
+            m_velocityField[index] = vector(t_vortices.computeSpeed(p));
         }
     }
+    m_tiles.markAllClean();
+    m_isLazy = false;
+    fieldChanged();
+}
+
+template <typename RealType>
+void BasicCartesianGridOfSpeed<RealType>::invalidateVelocityField(
+    const Simulation::Vortices & t_vortices) {
+    // Copie sans allocation une fois la capacité atteinte
+    m_fieldVortices = t_vortices;
+    m_tiles.markAllDirty();
+    m_isLazy = true;
+    ++m_generation;
 }
 
-auto CartesianGridOfSpeed::computeVelocityFor(const point & p) const -> vector {
+template <typename RealType>
+void BasicCartesianGridOfSpeed<RealType>::computeTile(std::size_t t_tile) const {
+    using point = Simulation::Vortices::point;
     double halfStep = 0.5 * m_step;
-    // Localise le point dans la grille cartésienne :
-    std::int64_t iLoc = (p.x - m_left) / m_step;
-    std::int64_t jLoc = (p.y - m_bottom) / m_step;
-    point centerCell { getLeftBottomVertex().x + iLoc * m_step + halfStep,
-                       getLeftBottomVertex().y + jLoc * m_step + halfStep };
+    std::size_t firstRow = (t_tile / m_nbTilesX) * tileSize;
+    std::size_t firstCol = (t_tile % m_nbTilesX) * tileSize;
+    std::size_t lastRow = std::min(firstRow + tileSize, m_height);
+    std::size_t lastCol = std::min(firstCol + tileSize, m_width);
+    // Mêmes formules que updateVelocityField
+    for (std::size_t iRow = firstRow; iRow < lastRow; ++iRow) {
+        double yP = m_bottom + iRow * m_step + halfStep;
+        for (std::size_t jCol = firstCol; jCol < lastCol; ++jCol) {
+            point p { m_left + m_step * jCol + halfStep, yP };
+            m_velocityField[iRow * m_width + jCol] = vector(m_fieldVortices.computeSpeed(p));
+        }
+    }
+}
+
+template <typename RealType>
+void BasicCartesianGridOfSpeed<RealType>::ensureTile(std::size_t iRow, std::size_t jCol) const {
+    std::size_t tile = (iRow / tileSize) * m_nbTilesX + jCol / tileSize;
+    m_tiles.ensure(tile, [this, tile]() { computeTile(tile); });
+}
+
+template <typename RealType>
+void BasicCartesianGridOfSpeed<RealType>::completeVelocityFieldRows(std::size_t t_firstRow,
+                                                                    std::size_t t_lastRow) {
+    assert(t_lastRow <= m_height);
+    if (!m_isLazy || t_firstRow >= t_lastRow)
+        return;
+    for (std::size_t iTileRow = t_firstRow / tileSize; iTileRow * tileSize < t_lastRow;
+         ++iTileRow) {
+        for (std::size_t iTileCol = 0; iTileCol < m_nbTilesX; ++iTileCol)
+            ensureTile(iTileRow * tileSize, iTileCol * tileSize);
+    }
+}
+
+template <typename RealType>
+void BasicCartesianGridOfSpeed<RealType>::completeVelocityField() {
+    completeVelocityFieldRows(0, m_height);
+    m_isLazy = false;
+    fieldChanged();
+}
+
+template <typename RealType>
+void BasicCartesianGridOfSpeed<RealType>::updateVelocityFieldRows(
+    const Simulation::Vortices & t_vortices, std::size_t t_firstRow, std::size_t t_lastRow) {
+    using point = Simulation::Vortices::point;
+    assert(t_lastRow <= m_height);
+    double halfStep = 0.5 * m_step;
+
+    for (std::size_t iRow = t_firstRow; iRow < t_lastRow; ++iRow) {
+        double yP = m_bottom + iRow * m_step + halfStep;
+        for (std::size_t jCol = 0; jCol < m_width; ++jCol) {
+            point p { m_left + m_step * jCol + halfStep, yP };
+            m_pendingVelocityField[iRow * m_width + jCol] = vector(t_vortices.computeSpeed(p));
+        }
+    }
+}
+
+template <typename RealType>
+template <typename CellVelocity>
+void BasicCartesianGridOfSpeed<RealType>::wrappedStencil(std::int64_t jLoc,
+                                                         std::int64_t iLoc,
+                                                         const CellVelocity & t_velocity,
+                                                         vector (&t_stencil)[3][3]) const {
     std::int64_t iRight = (iLoc + 1) % m_width; // Gestion du tore
     std::int64_t iLeft = (iLoc + m_width - 1) % m_width;
 
     std::int64_t jTop = (jLoc + 1) % m_height; // Gestion du tore
     std::int64_t jBot = (jLoc + m_height - 1) % m_height;
 
-    // Interpolation quadratique :
-    double invStep = 1. / m_step;
-    double sqrStep = m_step * m_step;
-    double invSqrStep = invStep * invStep;
-    double invCubStep = invStep * invSqrStep;
-
-    vector vcc = getVelocity(jLoc, iLoc);
-    vector vcm = getVelocity(jLoc, iLeft);
-    vector vcp = getVelocity(jLoc, iRight);
-    vector vmc = getVelocity(jBot, iLoc);
-    vector vpc = getVelocity(jTop, iLoc);
+    std::int64_t rows[3] = { jBot, jLoc, jTop };
+    std::int64_t cols[3] = { iLeft, iLoc, iRight };
+    for (int dj = 0; dj < 3; ++dj)
+        for (int di = 0; di < 3; ++di)
+            t_stencil[dj][di] = t_velocity(rows[dj], cols[di]);
+}
+
+template <typename RealType>
+void BasicCartesianGridOfSpeed<RealType>::packBlock(std::size_t t_block) const {
+    std::size_t firstRow = (t_block / m_nbTilesX) * tileSize;
+    std::size_t firstCol = (t_block % m_nbTilesX) * tileSize;
+    std::size_t nbRows = std::min(tileSize, m_height - firstRow);
+    std::size_t nbCols = std::min(tileSize, m_width - firstCol);
+    vector * block = m_tiledField.data() + t_block * blockLength;
+    // La ligne (colonne) locale 0 est la bordure fantôme qui précède la
+    // tuile, nbRows + 1 celle qui la suit, avec gestion du tore
+    for (std::size_t iLocal = 0; iLocal < nbRows + 2; ++iLocal) {
+        std::size_t iRow = (firstRow + iLocal + m_height - 1) % m_height;
+        for (std::size_t jLocal = 0; jLocal < nbCols + 2; ++jLocal) {
+            std::size_t jCol = (firstCol + jLocal + m_width - 1) % m_width;
+            block[iLocal * blockWidth + jLocal] = m_velocityField[iRow * m_width + jCol];
+        }
+    }
+}
+
+template <typename RealType>
+void BasicCartesianGridOfSpeed<RealType>::tiledStencil(std::int64_t jLoc,
+                                                       std::int64_t iLoc,
+                                                       vector (&t_stencil)[3][3]) const {
+    std::size_t block = (jLoc / tileSize) * m_nbTilesX + iLoc / tileSize;
+    m_blocks.ensure(block, [this, block]() { packBlock(block); });
+    const vector * velocities = m_tiledField.data() + block * blockLength;
+    // La cellule (jLoc, iLoc) est en (jLoc % tileSize + 1, iLoc % tileSize + 1)
+    // dans le bloc : le voisinage 3x3 y est entier, sans modulo
+    std::size_t first = (jLoc % tileSize) * blockWidth + iLoc % tileSize;
+    for (std::size_t dj = 0; dj < 3; ++dj) {
+        for (std::size_t di = 0; di < 3; ++di) {
+            t_stencil[dj][di] = velocities[first + dj * blockWidth + di];
+        }
+    }
+}
+
+template <typename RealType>
+template <typename Stencil>
+auto BasicCartesianGridOfSpeed<RealType>::interpolateVelocity(const real_point & p,
+                                                              const Stencil & t_stencil) const
+    -> vector {
+    double halfStep = 0.5 * m_step;
+    // Localise le point dans la grille cartésienne ; un point ramené sur le
+    // bord droit ou haut (arrondi en simple précision) est dans la dernière
+    // cellule, le tore fournissant ses voisines
+    std::int64_t iLoc = std::min<std::int64_t>((p.x - m_left) / m_step, m_width - 1);
+    std::int64_t jLoc = std::min<std::int64_t>((p.y - m_bottom) / m_step, m_height - 1);
+    point centerCell { getLeftBottomVertex().x + iLoc * m_step + halfStep,
+                       getLeftBottomVertex().y + jLoc * m_step + halfStep };
+    // Valeurs des 9 cellules autour de (jLoc, iLoc), [ligne][colonne]
+    vector stencil[3][3];
+    t_stencil(jLoc, iLoc, stencil);
+
+    // Interpolation quadratique, dans la précision du champ :
+    RealType step = RealType(m_step);
+    RealType invStep = RealType(1.) / step;
+    RealType sqrStep = step * step;
+    RealType invSqrStep = invStep * invStep;
+    RealType invCubStep = invStep * invSqrStep;
+
+    vector vcc = stencil[1][1];
+    vector vcm = stencil[1][0];
+    vector vcp = stencil[1][2];
+    vector vmc = stencil[0][1];
+    vector vpc = stencil[2][1];
     // Polynôme :
     // v00 + v01.x + v10.y + v11.x.y + v02.x² + v20.y² + v12.y.x² + v21.y².x +
     // v22.x².y² = V Pour x=h, y=0 : v00 + v01.h + v02.h² = V0,+1 Pour x=-h,y=0
@@ -67,11 +227,11 @@ auto CartesianGridOfSpeed::computeVelocityFor(const point & p) const -> vector {
     // => v01 = 1/(2h)(V0,+1 - V0,-1)
     // => v02 = (V0,+1 + V0,-1 - 2.v00)/(2.h²)
     vector v00 = vcc;
-    vector v01 = (0.5 * invStep) * (vcp - vcm);
-    vector v02 = (0.5 * invSqrStep) * (vcp + vcm - 2. * v00);
+    vector v01 = (RealType(0.5) * invStep) * (vcp - vcm);
+    vector v02 = (RealType(0.5) * invSqrStep) * (vcp + vcm - RealType(2.) * v00);
     // Même type de formule pour la direction Oy :
-    vector v10 = (0.5 * invStep) * (vpc - vmc);
-    vector v20 = (0.5 * invSqrStep) * (vpc + vmc - 2. * v00);
+    vector v10 = (RealType(0.5) * invStep) * (vpc - vmc);
+    vector v20 = (RealType(0.5) * invSqrStep) * (vpc + vmc - RealType(2.) * v00);
     // Pour x=h,y=h :
     //     v00 + v01.h + v10.h + v11.h² + v02.h² + v20.h² + v12.h^3 + v21.h^3 +
     //     v22.h^4 = V+1,+1
@@ -101,36 +261,79 @@ auto CartesianGridOfSpeed::computeVelocityFor(const point & p) const -> vector {
     //
     // => 2v01.h + 2v11.h^2 + 2v21.h^3 = V+1,+1 - V-1,+1
     // => v21 = 0.5/h^3 * ( V+1,+1 - V-1,+1 - 2v01.h - 2v11.h²)
-    vector vmm = getVelocity(jBot, iLeft);
-    vector vpm = getVelocity(jTop, iLeft);
-    vector vmp = getVelocity(jBot, iRight);
-    vector vpp = getVelocity(jTop, iRight);
+    vector vmm = stencil[0][0];
+    vector vpm = stencil[2][0];
+    vector vmp = stencil[0][2];
+    vector vpp = stencil[2][2];
 
-    vector v11 = 0.25 * invSqrStep * (vmm + vpp - vmp - vpm);
-    vector v22 = 0.25 * invSqrStep
-                 * (vmm + vmp + vpm + vpp - 4. * v00 - 4. * sqrStep * v02 - 4. * sqrStep * v20);
-    vector v12 = 0.5 * invCubStep * (vpp - vpm - 2 * m_step * v10 - 2 * sqrStep * v11);
-    vector v21 = 0.5 * invCubStep * (vpp - vmp - 2 * m_step * v01 - 2 * sqrStep * v11);
+    vector v11 = RealType(0.25) * invSqrStep * (vmm + vpp - vmp - vpm);
+    vector v22 = RealType(0.25) * invSqrStep
+                 * (vmm + vmp + vpm + vpp - RealType(4.) * v00 - RealType(4.) * sqrStep * v02
+                    - RealType(4.) * sqrStep * v20);
+    vector v12 = RealType(0.5) * invCubStep
+                 * (vpp - vpm - RealType(2) * step * v10 - RealType(2) * sqrStep * v11);
+    vector v21 = RealType(0.5) * invCubStep
+                 * (vpp - vmp - RealType(2) * step * v01 - RealType(2) * sqrStep * v11);
 
     point locPoint { p.x - centerCell.x, p.y - centerCell.y };
-    double xc = locPoint.x, yc = locPoint.y;
-    double xc2 = xc * xc, yc2 = yc * yc;
+    RealType xc = RealType(locPoint.x), yc = RealType(locPoint.y);
+    RealType xc2 = xc * xc, yc2 = yc * yc;
 
     vector interpolatedVelocity { v00 + xc * v10 + yc * v01 + xc * yc * v11 + xc2 * v20 + yc2 * v02
                                   + xc2 * yc * v21 + xc * yc2 * v12 + xc2 * yc2 * v22 };
     return interpolatedVelocity;
 }
 
-auto CartesianGridOfSpeed::updatePosition(const point & p) const -> point {
-    point newp(p);
-    vector dimension(getLeftBottomVertex(), getRightTopVertex());
-    if (newp.x < m_left)
-        newp.x += dimension.x;
-    if (newp.x > getRightTopVertex().x)
-        newp.x -= dimension.x;
-    if (newp.y < m_bottom)
-        newp.y += dimension.y;
-    if (newp.y > getRightTopVertex().y)
-        newp.y -= dimension.y;
-    return newp;
+template <typename RealType>
+auto BasicCartesianGridOfSpeed<RealType>::computeVelocityFor(const real_point & p) const
+    -> vector {
+    if (m_isLazy) {
+        auto cell = [this](std::size_t iRow, std::size_t jCol) {
+            ensureTile(iRow, jCol);
+            return getVelocity(iRow, jCol);
+        };
+        return interpolateVelocity(p, [&](std::int64_t jLoc, std::int64_t iLoc, auto & stencil) {
+            wrappedStencil(jLoc, iLoc, cell, stencil);
+        });
+    }
+    if (m_isTiled) {
+        return interpolateVelocity(p, [this](std::int64_t jLoc, std::int64_t iLoc, auto & stencil) {
+            tiledStencil(jLoc, iLoc, stencil);
+        });
+    }
+    auto cell = [this](std::size_t iRow, std::size_t jCol) { return getVelocity(iRow, jCol); };
+    return interpolateVelocity(p, [&](std::int64_t jLoc, std::int64_t iLoc, auto & stencil) {
+        wrappedStencil(jLoc, iLoc, cell, stencil);
+    });
+}
+
+template <typename RealType>
+auto BasicCartesianGridOfSpeed<RealType>::computeVelocityFor(const real_point & p,
+                                                             RealType t_theta) const -> vector {
+    assert(m_pendingVelocityField.size() == m_velocityField.size());
+    assert(!m_isLazy);
+    RealType weight = RealType(1.) - t_theta;
+    auto cell = [&](std::size_t iRow, std::size_t jCol) {
+        std::size_t index = iRow * m_width + jCol;
+        return weight * m_velocityField[index] + t_theta * m_pendingVelocityField[index];
+    };
+    return interpolateVelocity(p, [&](std::int64_t jLoc, std::int64_t iLoc, auto & stencil) {
+        wrappedStencil(jLoc, iLoc, cell, stencil);
+    });
 }
+
+template <typename RealType>
+void BasicCartesianGridOfSpeed<RealType>::setTiledLayout(bool t_isTiled) {
+    m_isTiled = t_isTiled;
+    if (!m_isTiled) {
+        m_tiledField = container();
+        m_blocks = DirtyTiles();
+        return;
+    }
+    m_tiledField.resize(m_tiles.size() * blockLength);
+    m_blocks = DirtyTiles(m_tiles.size());
+    m_blocks.markAllDirty();
+}
+
+template class Numeric::BasicCartesianGridOfSpeed<float>;
+template class Numeric::BasicCartesianGridOfSpeed<double>;
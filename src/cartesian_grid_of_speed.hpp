@@ -1,9 +1,16 @@
 #ifndef _NUMERICAL_CARTESIAN_GRID_OF_SPEED_HPP_
 #define _NUMERICAL_CARTESIAN_GRID_OF_SPEED_HPP_
+#include "dirty_tiles.hpp"
 #include "point.hpp"
+#include "precision.hpp"
+#include "storage_allocator.hpp"
 #include "vector.hpp"
 #include "vortex.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <mpi.h>
 #include <utility>
 #include <vector>
@@ -12,12 +19,22 @@ namespace Numeric {
     /**
      * @brief Cartesian grid containing velocity field computing from vortices
      *
+     * The geometry of the grid is always in double, the velocity field and
+     * its interpolation in RealType.
+     *
+     * @tparam RealType The kind of real of the velocity field and of the
+     * particles advected in it
      */
-    class CartesianGridOfSpeed {
+    template <typename RealType>
+    class BasicCartesianGridOfSpeed {
     public:
-        using vector = Geometry::Vector<double>;
-        using container = std::vector<vector>;
+        using real = RealType;
+        using vector = Geometry::Vector<RealType>;
+        using allocator_type = Memory::StorageAllocator<vector>;
+        using container = std::vector<vector, allocator_type>;
         using point = Geometry::Point<double>;
+        /// Position of a particle
+        using real_point = Geometry::Point<RealType>;
 
         //@name Constructors and destructor
         //@{
@@ -27,7 +44,7 @@ namespace Numeric {
          * Build a undimensionned and uninitialized velocity field grid.
          *
          */
-        CartesianGridOfSpeed() = default;
+        BasicCartesianGridOfSpeed() = default;
         /**
          * @brief Construct a new cartesian grid with uninitialized velocity
          * field
@@ -38,24 +55,35 @@ namespace Numeric {
          * cartesian grid
          * @param t_hStep      The step in all direction for the regular grid
          */
-        CartesianGridOfSpeed(std::pair<std::size_t, std::size_t> t_dimensions,
-                             Geometry::Point<double> m_origin,
-                             double t_hStep);
+        BasicCartesianGridOfSpeed(std::pair<std::size_t, std::size_t> t_dimensions,
+                                  Geometry::Point<double> m_origin,
+                                  double t_hStep);
+        /**
+         * @brief Same as above, but the current velocity field is stored with
+         * the given allocator (for instance in a shared memory buffer)
+         *
+         * The pending field stays on the heap : it is copied in the buffer
+         * when committed.
+         */
+        BasicCartesianGridOfSpeed(std::pair<std::size_t, std::size_t> t_dimensions,
+                                  Geometry::Point<double> m_origin,
+                                  double t_hStep,
+                                  const allocator_type & t_allocator);
         /**
          * @brief Copy constructor
          *
          */
-        CartesianGridOfSpeed(const CartesianGridOfSpeed &) = default;
+        BasicCartesianGridOfSpeed(const BasicCartesianGridOfSpeed &) = default;
         /**
          * @brief Move constructor
          *
          */
-        CartesianGridOfSpeed(CartesianGridOfSpeed &&) = default;
+        BasicCartesianGridOfSpeed(BasicCartesianGridOfSpeed &&) = default;
         /**
          * @brief Destructor
          *
          */
-        ~CartesianGridOfSpeed() = default;
+        ~BasicCartesianGridOfSpeed() = default;
         //@}
 
         //@name Accessors and modifiers
@@ -86,44 +114,272 @@ namespace Numeric {
          * @brief Return the address of the first velocity vector of the
          * velocityfield
          *
-         * @return double* Return as a double value.
+         * @return RealType* Return as a RealType value.
          */
-        double * data() { return (double *)m_velocityField.data(); }
-        const double * data() const { return (const double *)m_velocityField.data(); }
+        RealType * data() { return (RealType *)m_velocityField.data(); }
+        const RealType * data() const { return (const RealType *)m_velocityField.data(); }
 
         double getStep() const { return m_step; }
 
         void updateVelocityField(const Simulation::Vortices & t_vortices);
 
+        /**
+         * @name Lazy evaluation
+         *
+         * The field is split into tiles of tileSize x tileSize cells.
+         * invalidateVelocityField() only records the vortices and marks every
+         * tile dirty : a tile is then computed on its first read by
+         * computeVelocityFor (thread safe, from any number of threads), so
+         * the cells far from every particle are never computed. The whole
+         * field must be completed before being read by other means
+         * (getVelocity, data, copies, sends).
+         */
+        //@{
+        static constexpr std::size_t tileSize = 8;
+
+        /**
+         * @brief Make the field generated by t_vortices the current one,
+         * without computing it
+         */
+        void invalidateVelocityField(const Simulation::Vortices & t_vortices);
+        /**
+         * @brief Compute the dirty tiles holding the rows [t_firstRow,
+         * t_lastRow)
+         *
+         * Several row ranges may be completed concurrently, together with
+         * computeVelocityFor.
+         */
+        void completeVelocityFieldRows(std::size_t t_firstRow, std::size_t t_lastRow);
+        /**
+         * @brief Compute the remaining dirty tiles, the field being then
+         * complete
+         */
+        void completeVelocityField();
+        bool isVelocityFieldComplete() const { return !m_isLazy; }
+        //@}
+
+        /**
+         * @brief Whether computeVelocityFor reads a tiled copy of the field
+         *
+         * The tiled copy stores each tile of tileSize x tileSize cells in a
+         * block of its own, with a periodic ghost border of one cell. The 3 x 3
+         * stencil of an interpolation then lies in one block of a few cache
+         * lines, found without any modulo. The row-major field stays the
+         * reference (data, getVelocity, MPI transfers) : a block is packed from
+         * it by the first interpolation reading it after the field changed
+         * (thread safe). Not used while the field is lazy.
+         */
+        void setTiledLayout(bool t_isTiled);
+        bool isTiled() const { return m_isTiled; }
+
+        /**
+         * @brief Compute the rows [t_firstRow, t_lastRow) of the next velocity
+         * field
+         *
+         * The rows are written in a pending buffer, so that the current field
+         * can still be read (by the particle advection) while the next one is
+         * built. Several disjoint row ranges may be computed concurrently.
+         *
+         * @param t_vortices The vortices generating the field
+         * @param t_firstRow First row to compute
+         * @param t_lastRow  Past the end row to compute
+         */
+        void updateVelocityFieldRows(const Simulation::Vortices & t_vortices,
+                                     std::size_t t_firstRow,
+                                     std::size_t t_lastRow);
+        /**
+         * @brief Make the pending velocity field (see updateVelocityFieldRows)
+         * the current one
+         *
+         * Every row of the pending field must have been computed : a lazy
+         * field is then complete.
+         */
+        void commitVelocityField() {
+            // Un champ lié à un tampon extérieur y reste
+            if (m_velocityField.get_allocator() == m_pendingVelocityField.get_allocator())
+                std::swap(m_velocityField, m_pendingVelocityField);
+            else
+                std::copy(m_pendingVelocityField.begin(), m_pendingVelocityField.end(),
+                          m_velocityField.begin());
+            m_tiles.markAllClean();
+            m_isLazy = false;
+            fieldChanged();
+        }
+        /**
+         * @brief Copy the current velocity field of a grid of same dimensions
+         */
+        void copyVelocityFieldFrom(const BasicCartesianGridOfSpeed & t_grid) {
+            assert(t_grid.m_velocityField.size() == m_velocityField.size());
+            assert(!t_grid.m_isLazy);
+            std::copy(t_grid.m_velocityField.begin(), t_grid.m_velocityField.end(),
+                      m_velocityField.begin());
+            fieldChanged();
+            m_generation = t_grid.m_generation;
+        }
+
+        /**
+         * @brief Number of changes of the current velocity field
+         *
+         * Incremented by every modification of the field. A copy keeps the
+         * generation of its source : a display comparing the generation with
+         * the one of its last drawing knows whether the field changed.
+         */
+        std::uint64_t generation() const { return m_generation; }
+        /**
+         * @brief Record that the field was overwritten from outside (message,
+         * shared memory) with a field of generation t_generation
+         */
+        void setGeneration(std::uint64_t t_generation) {
+            fieldChanged();
+            m_generation = t_generation;
+        }
+
         vector getVelocity(std::size_t iCell, std::size_t jCell) const {
             return m_velocityField[iCell * m_width + jCell];
         }
 
-        point updatePosition(const point & pt) const;
+        /**
+         * @brief Bring back a point in the domain (periodic boundaries)
+         *
+         * @tparam PointType Point of any kind of real (particle or vortex)
+         */
+        template <typename PointType>
+        PointType updatePosition(const PointType & pt) const {
+            PointType newp(pt);
+            double dimensionX = getRightTopVertex().x - m_left;
+            double dimensionY = getRightTopVertex().y - m_bottom;
+            if (newp.x < m_left)
+                newp.x += dimensionX;
+            if (newp.x > getRightTopVertex().x)
+                newp.x -= dimensionX;
+            if (newp.y < m_bottom)
+                newp.y += dimensionY;
+            if (newp.y > getRightTopVertex().y)
+                newp.y -= dimensionY;
+            return newp;
+        }
 
-        vector computeVelocityFor(const point & p) const;
+        /**
+         * @brief Shortest displacement from t_from to t_to on the torus of
+         * the domain (periodic boundaries), in double
+         *
+         * A step never covers half of the domain : a longer jump between two
+         * successive positions is a crossing of a border.
+         *
+         * @tparam PointType Point of any kind of real (particle or vortex)
+         */
+        template <typename PointType>
+        Geometry::Vector<double> wrappedDisplacement(const PointType & t_from,
+                                                     const PointType & t_to) const {
+            double dimensionX = getRightTopVertex().x - m_left;
+            double dimensionY = getRightTopVertex().y - m_bottom;
+            double dx = double(t_to.x) - double(t_from.x);
+            double dy = double(t_to.y) - double(t_from.y);
+            return { dx - dimensionX * std::round(dx / dimensionX),
+                     dy - dimensionY * std::round(dy / dimensionY) };
+        }
 
-        CartesianGridOfSpeed & operator=(const CartesianGridOfSpeed &) = default;
-        CartesianGridOfSpeed & operator=(CartesianGridOfSpeed &&) = default;
+        vector computeVelocityFor(const real_point & p) const;
+        /**
+         * @brief Velocity at p interpolated in time between the current field
+         * (t_theta = 0) and the pending one (t_theta = 1)
+         *
+         * The pending field must be complete (all its rows computed by
+         * updateVelocityFieldRows) and not yet committed. The space
+         * interpolation being linear in the values of the cells, both fields
+         * are blended cell by cell before one single interpolation.
+         *
+         * @param t_theta Fraction of the time step, in [0, 1]
+         */
+        vector computeVelocityFor(const real_point & p, RealType t_theta) const;
+
+        BasicCartesianGridOfSpeed & operator=(const BasicCartesianGridOfSpeed &) = default;
+        BasicCartesianGridOfSpeed & operator=(BasicCartesianGridOfSpeed &&) = default;
 
         constexpr static int TAG = 'G';
 
         inline int send(int dest, MPI_Comm comm) const {
-            return MPI_Send(data(), (sizeof(vector) / sizeof(double)) * m_velocityField.size(),
-                            MPI_DOUBLE, dest, CartesianGridOfSpeed::TAG, comm);
+            return MPI_Send(data(), (sizeof(vector) / sizeof(RealType)) * m_velocityField.size(),
+                            Numeric::mpiType<RealType>(), dest, TAG, comm);
+        }
+
+        inline int isend(int dest, MPI_Comm comm, MPI_Request * request) const {
+            return MPI_Isend(data(), (sizeof(vector) / sizeof(RealType)) * m_velocityField.size(),
+                             Numeric::mpiType<RealType>(), dest, TAG, comm, request);
         }
 
         inline int recv(int source, MPI_Comm comm, MPI_Status * status) {
-            return MPI_Recv(data(), (sizeof(vector) / sizeof(double)) * m_velocityField.size(),
-                            MPI_DOUBLE, source, CartesianGridOfSpeed::TAG, comm, status);
+            fieldChanged();
+            return MPI_Recv(data(), (sizeof(vector) / sizeof(RealType)) * m_velocityField.size(),
+                            Numeric::mpiType<RealType>(), source, TAG, comm, status);
         }
 
     private:
+        /**
+         * @brief Quadratic interpolation at p of the cell values given by
+         * t_velocity(iRow, jCol)
+         */
+        template <typename Stencil>
+        vector interpolateVelocity(const real_point & p, const Stencil & t_stencil) const;
+        /**
+         * @brief Values t_velocity(iRow, jCol) of the 3 x 3 cells around
+         * (jLoc, iLoc), on the torus
+         */
+        template <typename CellVelocity>
+        void wrappedStencil(std::int64_t jLoc,
+                            std::int64_t iLoc,
+                            const CellVelocity & t_velocity,
+                            vector (&t_stencil)[3][3]) const;
+        /**
+         * @brief Same as wrappedStencil for the current field, read in the
+         * tiled copy
+         */
+        void tiledStencil(std::int64_t jLoc, std::int64_t iLoc, vector (&t_stencil)[3][3]) const;
+        void packBlock(std::size_t t_block) const;
+        /**
+         * @brief To be called when the current field changed : the blocks of
+         * the tiled copy have to be packed again
+         */
+        void fieldChanged() {
+            ++m_generation;
+            if (m_isTiled)
+                m_blocks.markAllDirty();
+        }
+
+        /**
+         * @brief Compute the tile holding the cell (iRow, jCol) if it is dirty
+         */
+        void ensureTile(std::size_t iRow, std::size_t jCol) const;
+        void computeTile(std::size_t t_tile) const;
+
         std::size_t m_width, m_height;
         double m_left, m_bottom;
         double m_step;
-        container m_velocityField;
+        // Champ courant : ses tuiles sont calculées à la demande en mode
+        // paresseux, y compris depuis les méthodes const
+        mutable container m_velocityField;
+        container m_pendingVelocityField;
+
+        std::size_t m_nbTilesX = 0;
+        mutable DirtyTiles m_tiles;
+        // Vortex générant le champ courant en mode paresseux
+        Simulation::Vortices m_fieldVortices;
+        bool m_isLazy = false;
+        std::uint64_t m_generation = 0;
+
+        static constexpr std::size_t blockWidth = tileSize + 2;
+        /// Number of cells of a block of the tiled copy, ghost border included
+        static constexpr std::size_t blockLength = blockWidth * blockWidth;
+        bool m_isTiled = false;
+        mutable container m_tiledField;
+        mutable DirtyTiles m_blocks;
     };
+
+    /**
+     * @brief Velocity field of the simulation, in the precision of the build
+     * (see Numeric::real)
+     */
+    using CartesianGridOfSpeed = BasicCartesianGridOfSpeed<real>;
 } // namespace Numeric
 
 #endif
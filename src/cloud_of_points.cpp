@@ -2,25 +2,44 @@
 
 #include <cmath>
 
-Geometry::CloudOfPoints Geometry::generatePointsIn(std::size_t t_nbPoints,
-                                                   const Rectangle & t_area) {
+std::pair<std::size_t, std::size_t> Geometry::pointLattice(std::size_t t_nbPoints) {
     std::size_t sqrtNbPoints = std::size_t(std::sqrt(t_nbPoints));
+    if (sqrtNbPoints == 0)
+        return { 0, 0 };
     std::size_t nbPointsY = t_nbPoints / sqrtNbPoints;
     std::size_t nbPointsX = sqrtNbPoints + (t_nbPoints % sqrtNbPoints > 0 ? 1 : 0);
+    return { nbPointsX, nbPointsY };
+}
+
+Geometry::CloudOfPoints Geometry::generatePointsIn(std::size_t t_nbPoints,
+                                                   const Rectangle & t_area) {
+    return generatePointsIn(pointLattice(t_nbPoints), t_area);
+}
 
+Geometry::CloudOfPoints Geometry::generatePointsIn(std::pair<std::size_t, std::size_t> t_lattice,
+                                                   const Rectangle & t_area) {
+    CloudOfPoints cloud { t_lattice.first * t_lattice.second };
+    generatePointsIn(t_lattice, t_area, cloud, 0);
+    return cloud;
+}
+
+void Geometry::generatePointsIn(std::pair<std::size_t, std::size_t> t_lattice,
+                                const Rectangle & t_area,
+                                CloudOfPoints & t_cloud,
+                                std::size_t t_first) {
+    auto [nbPointsX, nbPointsY] = t_lattice;
+    assert(t_first + nbPointsX * nbPointsY <= t_cloud.numberOfPoints());
     double dx = t_area.topRight.x - t_area.bottomLeft.x;
     double hx = dx / nbPointsX;
 
     double dy = t_area.topRight.y - t_area.bottomLeft.y;
     double hy = dy / nbPointsY;
 
-    CloudOfPoints cloud { nbPointsX * nbPointsY };
-
-    for (std::size_t ix = 0; ix < nbPointsX; ++ix) {
-        for (std::size_t jy = 0; jy < nbPointsY; ++jy) {
-            cloud[ix + jy * nbPointsX] = Point<double> { t_area.bottomLeft.x + (ix + 0.5) * hx,
-                                                         t_area.bottomLeft.y + (jy + 0.5) * hy };
+#pragma omp parallel for
+    for (std::size_t jy = 0; jy < nbPointsY; ++jy) {
+        for (std::size_t ix = 0; ix < nbPointsX; ++ix) {
+            t_cloud[t_first + ix + jy * nbPointsX] = CloudOfPoints::point { Point<double> {
+                t_area.bottomLeft.x + (ix + 0.5) * hx, t_area.bottomLeft.y + (jy + 0.5) * hy } };
         }
     }
-    return cloud;
 }
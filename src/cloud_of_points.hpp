@@ -1,34 +1,55 @@
 #ifndef _GEOMETRY_CLOUD_OF_POINTS_HPP_
 #define _GEOMETRY_CLOUD_OF_POINTS_HPP_
 #include "point.hpp"
+#include "precision.hpp"
 #include "rectangle.hpp"
+#include "storage_allocator.hpp"
 
 #include <algorithm>
 #include <cassert>
 #include <mpi.h>
+#include <utility>
 #include <vector>
 
 namespace Geometry {
     /**
      * @brief A set of points in the plane $\mathbb{R}^{2}$
      *
+     * @tparam RealType The kind of real of the coordinates of the points
      */
-    class CloudOfPoints {
+    template <typename RealType>
+    class BasicCloudOfPoints {
     public:
-        using point = Point<double>;
-        using container = std::vector<point>;
-        using iterator = container::iterator;
-        using const_iterator = container::const_iterator;
+        using real = RealType;
+        using point = Point<RealType>;
+        using allocator_type = Memory::StorageAllocator<point>;
+        using container = std::vector<point, allocator_type>;
+        using iterator = typename container::iterator;
+        using const_iterator = typename container::const_iterator;
 
         //@name Constructors and destructor
         //@{
 
-        CloudOfPoints() = default;
-        CloudOfPoints(std::size_t nbPoints) : m_setOfPoints(nbPoints) {}
-        CloudOfPoints(const std::vector<double> & m_coordinates);
-        CloudOfPoints(const CloudOfPoints &) = default;
-        CloudOfPoints(CloudOfPoints &&) = default;
-        ~CloudOfPoints() = default;
+        BasicCloudOfPoints() = default;
+        BasicCloudOfPoints(std::size_t nbPoints) : m_setOfPoints(nbPoints) {}
+        /**
+         * @brief Build a cloud of nbPoints uninitialized points stored with
+         * the given allocator (for instance in a shared memory buffer)
+         *
+         * Room is reserved for t_capacity points, so the cloud may grow up to
+         * this size without leaving the storage of the allocator.
+         */
+        BasicCloudOfPoints(std::size_t nbPoints,
+                           const allocator_type & t_allocator,
+                           std::size_t t_capacity = 0)
+            : m_setOfPoints(t_allocator) {
+            m_setOfPoints.reserve(std::max(nbPoints, t_capacity));
+            m_setOfPoints.resize(nbPoints);
+        }
+        BasicCloudOfPoints(const std::vector<RealType> & m_coordinates);
+        BasicCloudOfPoints(const BasicCloudOfPoints &) = default;
+        BasicCloudOfPoints(BasicCloudOfPoints &&) = default;
+        ~BasicCloudOfPoints() = default;
         //@}
         const point & operator[](std::size_t t_index) const {
             assert(t_index < m_setOfPoints.size());
@@ -50,9 +71,17 @@ namespace Geometry {
 
         std::size_t numberOfPoints() const { return m_setOfPoints.size(); }
 
-        const double * data() const { return (double *)m_setOfPoints.data(); }
+        /**
+         * @brief Change the number of points, new points are uninitialized
+         */
+        void resize(std::size_t nbPoints) { m_setOfPoints.resize(nbPoints); }
+
+        std::size_t capacity() const { return m_setOfPoints.capacity(); }
+        void reserve(std::size_t t_capacity) { m_setOfPoints.reserve(t_capacity); }
+
+        const RealType * data() const { return (const RealType *)m_setOfPoints.data(); }
 
-        double * data() { return (double *)m_setOfPoints.data(); }
+        RealType * data() { return (RealType *)m_setOfPoints.data(); }
 
         void removeAPoint(std::size_t t_index) {
             assert(t_index < numberOfPoints());
@@ -62,26 +91,81 @@ namespace Geometry {
 
         void addAPoint(const point & a_point) { m_setOfPoints.push_back(a_point); }
 
-        CloudOfPoints & operator=(const CloudOfPoints &) = default;
-        CloudOfPoints & operator=(CloudOfPoints &&) = default;
+        BasicCloudOfPoints & operator=(const BasicCloudOfPoints &) = default;
+        BasicCloudOfPoints & operator=(BasicCloudOfPoints &&) = default;
 
         constexpr static int TAG = 'C';
 
         inline int send(int dest, MPI_Comm comm) const {
-            return MPI_Send(data(), (sizeof(point) / sizeof(double)) * m_setOfPoints.size(),
-                            MPI_DOUBLE, dest, CloudOfPoints::TAG, comm);
+            return MPI_Send(data(), (sizeof(point) / sizeof(RealType)) * m_setOfPoints.size(),
+                            Numeric::mpiType<RealType>(), dest, TAG, comm);
+        }
+
+        inline int isend(int dest, MPI_Comm comm, MPI_Request * request) const {
+            return MPI_Isend(data(), (sizeof(point) / sizeof(RealType)) * m_setOfPoints.size(),
+                             Numeric::mpiType<RealType>(), dest, TAG, comm, request);
         }
 
         inline int recv(int source, MPI_Comm comm, MPI_Status * status) {
-            return MPI_Recv(data(), (sizeof(point) / sizeof(double)) * m_setOfPoints.size(),
-                            MPI_DOUBLE, source, CloudOfPoints::TAG, comm, status);
+            return MPI_Recv(data(), (sizeof(point) / sizeof(RealType)) * m_setOfPoints.size(),
+                            Numeric::mpiType<RealType>(), source, TAG, comm, status);
+        }
+
+        /**
+         * @brief Send the t_nbSent points starting at t_first to dest while
+         * receiving t_nbReceived points from source in t_received, starting
+         * at t_receivedFirst
+         *
+         * dest or source may be MPI_PROC_NULL.
+         */
+        inline int sendrecv(std::size_t t_first,
+                            std::size_t t_nbSent,
+                            int dest,
+                            BasicCloudOfPoints & t_received,
+                            std::size_t t_receivedFirst,
+                            std::size_t t_nbReceived,
+                            int source,
+                            MPI_Comm comm,
+                            MPI_Status * status) const {
+            constexpr std::size_t nbCoordinates = sizeof(point) / sizeof(RealType);
+            return MPI_Sendrecv(data() + nbCoordinates * t_first, nbCoordinates * t_nbSent,
+                                Numeric::mpiType<RealType>(), dest, TAG,
+                                t_received.data() + nbCoordinates * t_receivedFirst,
+                                nbCoordinates * t_nbReceived, Numeric::mpiType<RealType>(), source,
+                                TAG, comm, status);
         }
 
     private:
         container m_setOfPoints;
     };
 
+    /**
+     * @brief Cloud of the particles of the simulation, in the precision of
+     * the build (see Numeric::real)
+     */
+    using CloudOfPoints = BasicCloudOfPoints<Numeric::real>;
+
+    /**
+     * @brief Lattice of about t_nbPoints points, as square as possible, used
+     * by generatePointsIn(t_nbPoints, ...)
+     */
+    std::pair<std::size_t, std::size_t> pointLattice(std::size_t t_nbPoints);
+
     CloudOfPoints generatePointsIn(std::size_t t_nbPoints, const Rectangle & t_area);
+    /**
+     * @brief Regular lattice of t_lattice.first x t_lattice.second points at
+     * the centers of the cells of t_area, row by row from the bottom
+     */
+    CloudOfPoints generatePointsIn(std::pair<std::size_t, std::size_t> t_lattice,
+                                   const Rectangle & t_area);
+    /**
+     * @brief Same as above, the points being written in t_cloud from the
+     * index t_first (in parallel), so that several areas share one cloud
+     */
+    void generatePointsIn(std::pair<std::size_t, std::size_t> t_lattice,
+                          const Rectangle & t_area,
+                          CloudOfPoints & t_cloud,
+                          std::size_t t_first);
 } // namespace Geometry
 
 #endif
@@ -0,0 +1,79 @@
+#ifndef _NUMERIC_DIRTY_TILES_HPP_
+#define _NUMERIC_DIRTY_TILES_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace Numeric {
+    /**
+     * @brief State (dirty, being computed or clean) of the tiles of a lazily
+     * evaluated array
+     *
+     * ensure() may be called concurrently on the same tile : the first
+     * thread computes it, the other ones wait for the result. markAllDirty()
+     * must not run concurrently with ensure().
+     */
+    class DirtyTiles {
+    public:
+        DirtyTiles() = default;
+        explicit DirtyTiles(std::size_t t_nbTiles) : m_states(t_nbTiles) {}
+        DirtyTiles(const DirtyTiles & t_tiles) : m_states(t_tiles.m_states.size()) {
+            copyStates(t_tiles);
+        }
+        DirtyTiles(DirtyTiles &&) = default;
+        DirtyTiles & operator=(DirtyTiles &&) = default;
+        DirtyTiles & operator=(const DirtyTiles & t_tiles) {
+            if (m_states.size() != t_tiles.m_states.size())
+                m_states = std::vector<std::atomic<std::uint8_t>>(t_tiles.m_states.size());
+            copyStates(t_tiles);
+            return *this;
+        }
+
+        std::size_t size() const { return m_states.size(); }
+
+        void markAllDirty() {
+            for (auto & state : m_states)
+                state.store(Dirty, std::memory_order_relaxed);
+        }
+        void markAllClean() {
+            for (auto & state : m_states)
+                state.store(Clean, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Make sure the tile t_tile is clean, calling t_compute() to
+         * compute it if it is dirty
+         */
+        template <typename Compute>
+        void ensure(std::size_t t_tile, const Compute & t_compute) {
+            auto & state = m_states[t_tile];
+            if (state.load(std::memory_order_acquire) == Clean)
+                return;
+            std::uint8_t expected = Dirty;
+            if (state.compare_exchange_strong(expected, Busy, std::memory_order_acquire)) {
+                t_compute();
+                state.store(Clean, std::memory_order_release);
+                return;
+            }
+            // Un autre thread calcule la tuile : on attend son résultat
+            while (state.load(std::memory_order_acquire) != Clean)
+                std::this_thread::yield();
+        }
+
+    private:
+        enum : std::uint8_t { Clean = 0, Dirty = 1, Busy = 2 };
+
+        void copyStates(const DirtyTiles & t_tiles) {
+            for (std::size_t iTile = 0; iTile < m_states.size(); ++iTile)
+                m_states[iTile].store(t_tiles.m_states[iTile].load(std::memory_order_relaxed),
+                                      std::memory_order_relaxed);
+        }
+
+        std::vector<std::atomic<std::uint8_t>> m_states;
+    };
+} // namespace Numeric
+
+#endif
@@ -0,0 +1,329 @@
+#include "ensemble.hpp"
+
+#include "cloud_of_points.hpp"
+#include "mixing_statistics.hpp"
+#include "particle_balancer.hpp"
+#include "step_pipeline.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+using namespace Simulation;
+
+namespace {
+    constexpr char ensembleMagic[] = "vortex-ensemble";
+
+    /// Throw std::invalid_argument on an unknown parameter or a bad value
+    void setParameter(EnsembleRun & t_run,
+                      const std::string & t_name,
+                      const std::string & t_value) {
+        // Toute la valeur doit être lue
+        auto number = [&](auto t_parse) {
+            std::size_t end = 0;
+            decltype(t_parse(t_value, &end)) value {};
+            try {
+                value = t_parse(t_value, &end);
+            } catch (std::logic_error &) {
+                end = 0;
+            }
+            if (end != t_value.size())
+                throw std::invalid_argument("malformed value " + t_value + " of " + t_name);
+            return value;
+        };
+        auto toDouble = [](const std::string & t_text, std::size_t * t_end) {
+            return std::stod(t_text, t_end);
+        };
+        auto toSize = [](const std::string & t_text, std::size_t * t_end) {
+            // stoull accepte un signe moins
+            if (t_text.starts_with('-'))
+                throw std::invalid_argument(t_text);
+            return std::stoull(t_text, t_end);
+        };
+        if (t_name == "steps") {
+            t_run.steps = number(toSize);
+            if (t_run.steps == 0)
+                throw std::invalid_argument("steps must be positive");
+        } else if (t_name == "dt") {
+            t_run.dt = number(toDouble);
+            if (!(t_run.dt > 0.))
+                throw std::invalid_argument("dt must be positive");
+        } else if (t_name == "scheme") {
+            t_run.scheme = Numeric::parseScheme(t_value);
+        } else if (t_name == "velocity") {
+            t_run.velocity = Numeric::parseVelocitySource(t_value);
+        } else if (t_name == "intensity") {
+            t_run.intensity = number(toDouble);
+        } else if (t_name == "seed") {
+            t_run.seed = number(toSize);
+        } else if (t_name == "particles") {
+            t_run.particles = number(toDouble);
+            if (!(t_run.particles > 0.))
+                throw std::invalid_argument("particles must be positive");
+        } else if (t_name == "grid") {
+            t_run.grid = number(toDouble);
+            if (!(t_run.grid > 0.))
+                throw std::invalid_argument("grid must be positive");
+        } else {
+            throw std::invalid_argument("unknown parameter " + t_name);
+        }
+    }
+
+    /// Values of a parameter of a run line : name=value[,value...]
+    std::pair<std::string, std::vector<std::string>> splitParameter(const std::string & t_word) {
+        auto eq = t_word.find('=');
+        if (eq == std::string::npos || eq == 0 || eq + 1 == t_word.size())
+            throw std::invalid_argument("expected <parameter>=<value>, not " + t_word);
+        std::vector<std::string> values;
+        std::istringstream list(t_word.substr(eq + 1));
+        for (std::string value; std::getline(list, value, ',');) {
+            if (value.empty())
+                throw std::invalid_argument("empty value in " + t_word);
+            values.push_back(value);
+        }
+        return { t_word.substr(0, eq), values };
+    }
+
+    double notAvailable() { return std::numeric_limits<double>::quiet_NaN(); }
+} // namespace
+
+ScenarioSpec Ensemble::spec(const EnsembleRun & t_run) const {
+    ScenarioSpec spec = scenarios[t_run.scenario];
+    for (auto & vortex : spec.vortices)
+        vortex.intensity *= t_run.intensity;
+    for (auto & random : spec.randomVortices) {
+        random.intensity *= t_run.intensity;
+        random.seed += t_run.seed;
+    }
+    spec.scaleParticles(t_run.particles);
+    spec.refineGrid(t_run.grid);
+    return spec;
+}
+
+double Ensemble::cost(const EnsembleRun & t_run) const {
+    const auto & spec = scenarios[t_run.scenario];
+    double nbVortices = double(spec.numberOfVortices());
+    double nbCells =
+        spec.isMobile ? double(spec.grid.nx) * spec.grid.ny * t_run.grid * t_run.grid : 0.;
+    double nbParticles = t_run.particles * spec.numberOfPoints();
+    return double(t_run.steps) * (nbParticles + nbVortices * (nbCells + nbVortices));
+}
+
+std::vector<std::size_t> Ensemble::schedule() const {
+    std::vector<std::size_t> order(runs.size());
+    std::iota(order.begin(), order.end(), 0);
+    // Tri stable : à coût égal, l'ordre du fichier
+    std::stable_sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+        return cost(runs[a]) > cost(runs[b]);
+    });
+    return order;
+}
+
+Ensemble Simulation::readEnsemble(const std::string & t_fileName) {
+    std::ifstream input(t_fileName);
+    if (!input)
+        throw std::runtime_error("Cannot open " + t_fileName);
+    auto directory = std::filesystem::path(t_fileName).parent_path();
+    std::size_t lineNumber = 0;
+    auto fail = [&](const std::string & t_message) {
+        throw std::runtime_error(t_fileName + ":" + std::to_string(lineNumber) + ": " + t_message);
+    };
+
+    Ensemble ensemble;
+    std::map<std::string, std::size_t> scenarioIndices;
+    EnsembleRun defaults;
+    bool hasHeader = false;
+    std::string text;
+    while (std::getline(input, text)) {
+        ++lineNumber;
+        std::istringstream line(text.substr(0, text.find('#')));
+        std::string key;
+        if (!(line >> key))
+            continue;
+        if (!hasHeader) {
+            int version = 0;
+            if (key != ensembleMagic || !(line >> version) || version != 1)
+                fail(std::string("expected ") + ensembleMagic + " 1");
+            hasHeader = true;
+            continue;
+        }
+        try {
+            if (key == "defaults") {
+                for (std::string word; line >> word;) {
+                    auto [name, values] = splitParameter(word);
+                    if (values.size() != 1)
+                        throw std::invalid_argument("defaults take a single value per parameter");
+                    setParameter(defaults, name, values.front());
+                }
+            } else if (key == "run") {
+                EnsembleRun run = defaults;
+                std::string file;
+                if (!(line >> run.name >> file))
+                    throw std::invalid_argument("expected run <name> <scenario>");
+                auto path = std::filesystem::path(file);
+                if (path.is_relative())
+                    path = directory / path;
+                auto [found, isNew] =
+                    scenarioIndices.emplace(path.lexically_normal().string(), 0);
+                if (isNew) {
+                    found->second = ensemble.scenarios.size();
+                    ensemble.scenarioFiles.push_back(found->first);
+                    ensemble.scenarios.push_back(readScenarioSpec(found->first));
+                }
+                run.scenario = found->second;
+
+                std::vector<std::pair<std::string, std::vector<std::string>>> parameters;
+                for (std::string word; line >> word;)
+                    parameters.push_back(splitParameter(word));
+                // Toutes les combinaisons, comptées comme un nombre dont le
+                // dernier paramètre est le chiffre des unités
+                std::vector<std::size_t> indices(parameters.size(), 0);
+                bool isDone = false;
+                while (!isDone) {
+                    EnsembleRun member = run;
+                    for (std::size_t iParameter = 0; iParameter < parameters.size(); ++iParameter)
+                        setParameter(member, parameters[iParameter].first,
+                                     parameters[iParameter].second[indices[iParameter]]);
+                    ensemble.runs.push_back(member);
+                    isDone = true;
+                    for (std::size_t iParameter = parameters.size(); iParameter-- > 0;) {
+                        if (++indices[iParameter] < parameters[iParameter].second.size()) {
+                            isDone = false;
+                            break;
+                        }
+                        indices[iParameter] = 0;
+                    }
+                }
+            } else {
+                throw std::invalid_argument("unknown key " + key);
+            }
+        } catch (std::exception & err) {
+            // Valeur invalide ou erreur de lecture d'un scénario
+            fail(err.what());
+        }
+    }
+    if (ensemble.runs.empty())
+        throw std::runtime_error(t_fileName + ": no run");
+    return ensemble;
+}
+
+RunSummary Simulation::runEnsembleMember(const Ensemble & t_ensemble,
+                                         std::size_t t_run,
+                                         MPI_Comm t_comm) {
+    const auto & run = t_ensemble.runs[t_run];
+    int rank, size;
+    MPI_Comm_rank(t_comm, &rank);
+    MPI_Comm_size(t_comm, &size);
+    RunSummary summary;
+    summary.run = t_run;
+    summary.nbProcesses = size;
+    summary.fieldUpdatesPerSecond = summary.meanSquareDisplacement = summary.occupancyEntropy =
+        summary.mixingEntropy = notAvailable();
+
+    double start = MPI_Wtime();
+    Scenario scenario = buildScenario(t_ensemble.spec(run));
+    auto & vortices = scenario.vortices;
+    auto & grid = scenario.grid;
+    grid.updateVelocityField(vortices);
+    summary.nbParticles = scenario.cloud.numberOfPoints();
+    summary.nbVortices = vortices.numberOfVortices();
+
+    Numeric::StepPipeline pipeline;
+    pipeline.setScheme(run.scheme);
+    pipeline.setVelocitySource(run.velocity);
+    if (scenario.sources.isActive())
+        pipeline.setSources(&scenario.sources);
+    // Plusieurs processus : particules réparties comme dans la simulation
+    // interactive, sans statistiques de mélange
+    std::optional<ParticleBalancer> balancer;
+    std::optional<MixingStatistics> statistics;
+    Geometry::CloudOfPoints points;
+    if (size > 1) {
+        balancer.emplace(t_comm, scenario.cloud.numberOfPoints());
+        points = balancer->localPoints(scenario.cloud);
+    } else {
+        points = std::move(scenario.cloud);
+        if (!scenario.sources.isActive()) {
+            // Un seul échantillon, au dernier pas
+            statistics.emplace(points, grid, run.steps);
+            pipeline.setMixingStatistics(&*statistics);
+        }
+    }
+
+    double stepsStart = MPI_Wtime();
+    unsigned long long nbUpdates = 0;
+    // Temps cumulé des tâches du champ, recalculé à chaque pas si les
+    // tourbillons sont mobiles
+    double fieldSeconds = 0.;
+    auto dimensions = grid.cellGeometry();
+    for (std::size_t iStep = 1; iStep <= run.steps; ++iStep) {
+        nbUpdates += points.numberOfPoints();
+        pipeline.step(run.dt, grid, vortices, points, scenario.isMobile, false);
+        fieldSeconds += pipeline.timings().field.busy;
+        if (balancer) {
+            const auto & particles = pipeline.timings().particles;
+            balancer->record(particles.end - particles.begin);
+            balancer->balance(points);
+        }
+    }
+    if (size > 1) {
+        unsigned long long nbLocalUpdates = nbUpdates;
+        MPI_Reduce(&nbLocalUpdates, &nbUpdates, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, t_comm);
+    }
+    double end = MPI_Wtime();
+
+    summary.setupSeconds = stepsStart - start;
+    summary.seconds = end - stepsStart;
+    summary.updatesPerSecond = summary.seconds > 0. ? nbUpdates / summary.seconds : 0.;
+    // Le champ est calculé entièrement par chaque processus
+    if (scenario.isMobile && fieldSeconds > 0.)
+        summary.fieldUpdatesPerSecond =
+            double(dimensions.first) * dimensions.second * run.steps / fieldSeconds;
+    if (statistics && statistics->isSampled()) {
+        const auto & sample = statistics->sample();
+        summary.meanSquareDisplacement = sample.meanSquareDisplacement;
+        summary.occupancyEntropy = sample.occupancyEntropy;
+        summary.mixingEntropy = sample.mixingEntropy;
+    }
+    return summary;
+}
+
+void Simulation::writeEnsembleResults(std::ostream & t_output,
+                                      const Ensemble & t_ensemble,
+                                      std::vector<RunSummary> t_summaries) {
+    std::sort(t_summaries.begin(), t_summaries.end(),
+              [](const RunSummary & a, const RunSummary & b) { return a.run < b.run; });
+    auto optional = [](double t_value) {
+        std::ostringstream text;
+        if (!std::isnan(t_value))
+            text << t_value;
+        return text.str();
+    };
+    t_output << "run,name,scenario,steps,dt,scheme,velocity,intensity,seed,particle_factor,"
+                "grid_factor,processes,particles,vortices,setup_s,run_s,updates_per_s,"
+                "field_updates_per_s,"
+                "mean_square_displacement,occupancy_entropy,mixing_entropy\n";
+    for (const auto & summary : t_summaries) {
+        const auto & run = t_ensemble.runs[summary.run];
+        t_output << summary.run << ',' << run.name << ','
+                 << t_ensemble.scenarioFiles[run.scenario] << ',' << run.steps << ',' << run.dt
+                 << ',' << Numeric::schemeName(run.scheme) << ','
+                 << Numeric::velocitySourceName(run.velocity) << ',' << run.intensity << ','
+                 << run.seed << ',' << run.particles << ',' << run.grid << ','
+                 << summary.nbProcesses << ',' << summary.nbParticles << ','
+                 << summary.nbVortices << ',' << summary.setupSeconds << ',' << summary.seconds
+                 << ',' << summary.updatesPerSecond << ','
+                 << optional(summary.fieldUpdatesPerSecond) << ','
+                 << optional(summary.meanSquareDisplacement)
+                 << ',' << optional(summary.occupancyEntropy) << ','
+                 << optional(summary.mixingEntropy) << '\n';
+    }
+}
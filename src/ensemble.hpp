@@ -0,0 +1,122 @@
+#ifndef _SIMULATION_ENSEMBLE_HPP_
+#define _SIMULATION_ENSEMBLE_HPP_
+#include "scenario.hpp"
+#include "scheme.hpp"
+#include "velocity_source.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <mpi.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Simulation {
+    /**
+     * @brief One member of an ensemble : a scenario and the parameters it is
+     * run with, without window
+     */
+    struct EnsembleRun {
+        std::string name;
+        /// Index of the scenario in Ensemble::scenarios
+        std::size_t scenario = 0;
+        std::size_t steps = 100;
+        double dt = 0.1;
+        Numeric::Scheme scheme = Numeric::Scheme::RK4;
+        Numeric::VelocitySource velocity = Numeric::VelocitySource::Grid;
+        /// Factor applied to the intensities of every vortex
+        double intensity = 1.;
+        /// Added to the seeds of the random vortices
+        std::uint64_t seed = 0;
+        /// Factor applied to the numbers of particles (see ScenarioSpec::scaleParticles)
+        double particles = 1.;
+        /// Factor applied to the number of cells per direction (see ScenarioSpec::refineGrid)
+        double grid = 1.;
+    };
+
+    /**
+     * @brief Simulations of a parameter study, read from an ensemble file
+     *
+     * The first line of the file is "vortex-ensemble 1". Each other line
+     * holds a key and its values ('#' starts a comment) :
+     *
+     *     defaults <parameter>=<value> ...
+     *     run <name> <scenario> [<parameter>=<value>[,<value>...] ...]
+     *
+     * The parameters are steps, dt, scheme, velocity, intensity, seed,
+     * particles and grid (see EnsembleRun). defaults changes the values of the next
+     * runs. A run with lists of values stands for the runs of every
+     * combination of them (the last parameter varying fastest). The path of
+     * a scenario is relative to the ensemble file, and each scenario file is
+     * read once.
+     */
+    struct Ensemble {
+        std::vector<std::string> scenarioFiles;
+        std::vector<ScenarioSpec> scenarios;
+        std::vector<EnsembleRun> runs;
+
+        /// Scenario of t_run, with its parameters applied
+        ScenarioSpec spec(const EnsembleRun & t_run) const;
+        /**
+         * @brief Rough cost of t_run : number of steps times the particles,
+         * the cells of the field of mobile vortices and the pairs of vortices
+         */
+        double cost(const EnsembleRun & t_run) const;
+        /**
+         * @brief Indices of the runs, the most expensive first
+         *
+         * Started first, the longest runs do not end alone after all the
+         * others.
+         */
+        std::vector<std::size_t> schedule() const;
+    };
+
+    /**
+     * @brief Read an ensemble file and the scenarios of its runs
+     *
+     * Throw std::runtime_error, with the file and the line, if a file cannot
+     * be read or is malformed.
+     */
+    Ensemble readEnsemble(const std::string & t_fileName);
+
+    /**
+     * @brief Result of one run of an ensemble
+     *
+     * The mixing statistics (see MixingStatistics) are the ones of the last
+     * step. They are NaN when they are not available (particle sources or
+     * several processes), as the field updates with fixed vortices.
+     */
+    struct RunSummary {
+        std::uint64_t run = 0; ///< Index in Ensemble::runs
+        std::uint64_t nbProcesses = 1;
+        std::uint64_t nbParticles = 0, nbVortices = 0;
+        /// Generation of the vortices, the particles and the initial field
+        double setupSeconds = 0.;
+        /// Time steps
+        double seconds = 0.;
+        /// Particle updates per second of the steps
+        double updatesPerSecond = 0.;
+        /// Cells of the velocity field updated per second of the field tasks
+        double fieldUpdatesPerSecond = 0.;
+        double meanSquareDisplacement = 0., occupancyEntropy = 0., mixingEntropy = 0.;
+    };
+
+    /**
+     * @brief Compute the run t_run of t_ensemble, the particles being split
+     * between the processes of t_comm
+     *
+     * Collective over t_comm. The summary is only complete on the first
+     * process of t_comm.
+     */
+    RunSummary runEnsembleMember(const Ensemble & t_ensemble, std::size_t t_run, MPI_Comm t_comm);
+
+    /**
+     * @brief Write the summaries, in the order of the runs, as a CSV file
+     * with a header line
+     */
+    void writeEnsembleResults(std::ostream & t_output,
+                              const Ensemble & t_ensemble,
+                              std::vector<RunSummary> t_summaries);
+} // namespace Simulation
+
+#endif
@@ -0,0 +1,226 @@
+#include "ensemble.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mpi.h>
+#include <omp.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+    struct RunnerOptions {
+        std::string input;
+        /// File where the summaries of the runs are written
+        std::string output = "ensemble.csv";
+        /// Number of processes sharing the particles of a run
+        int group = 1;
+        /// Number of OpenMP threads per process (0 : the cores of the node
+        /// divided between its processes)
+        int threads = 0;
+    };
+
+    void printUsage(const char * program) {
+        std::cout << "Usage : " << program << " <ensemble file> [options]" << std::endl
+                  << "Run the simulations of an ensemble file without window, as many at a time "
+                     "as there are groups of processes"
+                  << std::endl
+                  << "    --group=G  number of processes sharing the particles of a run "
+                     "(default 1)"
+                  << std::endl
+                  << "    --threads=T  OpenMP threads per process (default : OMP_NUM_THREADS, "
+                     "or the cores of the node divided between its processes)"
+                  << std::endl
+                  << "    --output=F  CSV file of the summaries of the runs (default "
+                     "ensemble.csv)"
+                  << std::endl;
+    }
+
+    RunnerOptions parseRunnerOptions(int argc, char * argv[]) {
+        RunnerOptions options;
+        std::vector<std::string> positional;
+        for (int iArg = 1; iArg < argc; ++iArg) {
+            std::string_view arg { argv[iArg] };
+            if (!arg.starts_with("--")) {
+                positional.emplace_back(arg);
+                continue;
+            }
+            std::string_view name = arg.substr(2);
+            std::string value;
+            if (auto eq = name.find('='); eq != std::string_view::npos) {
+                value = std::string(name.substr(eq + 1));
+                name = name.substr(0, eq);
+            }
+            if (value.empty())
+                throw std::invalid_argument("--" + std::string(name) + " expects a value");
+            if (name == "group")
+                options.group = std::stoi(value);
+            else if (name == "threads")
+                options.threads = std::stoi(value);
+            else if (name == "output")
+                options.output = value;
+            else
+                throw std::invalid_argument("Unknown option --" + std::string(name));
+        }
+        if (positional.size() != 1)
+            throw std::invalid_argument("Expected an ensemble file");
+        if (options.group < 1)
+            throw std::invalid_argument("--group expects a positive number of processes");
+        if (options.threads < 0)
+            throw std::invalid_argument("--threads expects a number of threads");
+        options.input = positional[0];
+        return options;
+    }
+} // namespace
+
+int main(int argc, char * argv[]) {
+    // Les appels à MPI ne sont faits que par le thread principal
+    int provided;
+    if (MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided) != MPI_SUCCESS)
+        return -1;
+    MPI_Comm comm = MPI_COMM_WORLD;
+    MPI_Comm_set_errhandler(comm, MPI_ERRORS_ARE_FATAL);
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    // Chaque processus lit les mêmes fichiers : les erreurs sont les mêmes
+    // partout, seul le premier les affiche
+    RunnerOptions options;
+    Simulation::Ensemble ensemble;
+    try {
+        options = parseRunnerOptions(argc, argv);
+    } catch (std::exception & err) {
+        if (rank == 0) {
+            std::cout << err.what() << std::endl;
+            printUsage(argv[0]);
+        }
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+    try {
+        ensemble = Simulation::readEnsemble(options.input);
+    } catch (std::runtime_error & err) {
+        if (rank == 0)
+            std::cerr << err.what() << std::endl;
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+    bool hasSources = std::any_of(ensemble.scenarios.begin(), ensemble.scenarios.end(),
+                                  [](const Simulation::ScenarioSpec & t_spec) {
+                                      return !t_spec.emitters.empty() || !t_spec.sinks.empty()
+                                             || t_spec.maxAge > 0.;
+                                  });
+    if (options.group > size || (options.group > 1 && hasSources)) {
+        if (rank == 0)
+            std::cerr << (hasSources ? "Particle sources need groups of one process!"
+                                     : "Fewer processes than in a group!")
+                      << std::endl;
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+    // Ouvert avant les simulations, pour ne pas en perdre les résultats
+    std::ofstream output;
+    int isOpen = 1;
+    if (rank == 0) {
+        output.open(options.output);
+        isOpen = bool(output);
+        if (!isOpen)
+            std::cerr << "Cannot open " << options.output << std::endl;
+    }
+    MPI_Bcast(&isOpen, 1, MPI_INT, 0, comm);
+    if (!isOpen) {
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    // Les cœurs d'un nœud sont partagés entre ses processus, au lieu que
+    // chacun lance autant de threads que de cœurs
+    MPI_Comm nodeComm;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &nodeComm);
+    int nbNodeProcesses;
+    MPI_Comm_size(nodeComm, &nbNodeProcesses);
+    MPI_Comm_free(&nodeComm);
+    int nbThreads = options.threads;
+    if (nbThreads == 0 && std::getenv("OMP_NUM_THREADS") == nullptr)
+        nbThreads = std::max(1, omp_get_num_procs() / nbNodeProcesses);
+    if (nbThreads > 0)
+        omp_set_num_threads(nbThreads);
+
+    // Groupes de processus consécutifs, chacun calculant une simulation à la
+    // fois ; le premier processus d'un groupe prend la suivante dans la file
+    MPI_Comm groupComm;
+    MPI_Comm_split(comm, rank / options.group, rank, &groupComm);
+    int groupRank;
+    MPI_Comm_rank(groupComm, &groupRank);
+    bool isLeader = groupRank == 0;
+
+    // File des simulations : un compteur sur le processus 0, incrémenté
+    // atomiquement par les chefs de groupe sans que le processus 0 n'ait à
+    // y répondre
+    std::uint64_t * counter = nullptr;
+    MPI_Win queue;
+    MPI_Win_allocate(rank == 0 ? sizeof(std::uint64_t) : 0, sizeof(std::uint64_t), MPI_INFO_NULL,
+                     comm, &counter, &queue);
+    if (rank == 0) {
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, queue);
+        *counter = 0;
+        MPI_Win_unlock(0, queue);
+    }
+    MPI_Barrier(comm);
+
+    auto order = ensemble.schedule();
+    std::vector<Simulation::RunSummary> summaries;
+    double start = MPI_Wtime();
+    while (true) {
+        std::uint64_t next = 0;
+        if (isLeader) {
+            const std::uint64_t one = 1;
+            MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, queue);
+            MPI_Fetch_and_op(&one, &next, MPI_UINT64_T, 0, 0, MPI_SUM, queue);
+            MPI_Win_unlock(0, queue);
+        }
+        MPI_Bcast(&next, 1, MPI_UINT64_T, 0, groupComm);
+        if (next >= order.size())
+            break;
+        auto summary = Simulation::runEnsembleMember(ensemble, order[next], groupComm);
+        if (isLeader) {
+            const auto & run = ensemble.runs[summary.run];
+            std::cout << "[ensemble] run " << summary.run << " (" << run.name << ") on ranks "
+                      << rank << "-" << rank + summary.nbProcesses - 1 << " : " << summary.seconds
+                      << " s, " << summary.updatesPerSecond * 1.E-6 << " M updates/s" << std::endl;
+            summaries.push_back(summary);
+        }
+    }
+
+    // Résumés rassemblés sur le processus 0
+    int nbBytes = int(summaries.size() * sizeof(Simulation::RunSummary));
+    std::vector<int> counts(rank == 0 ? size : 0), displacements;
+    MPI_Gather(&nbBytes, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, comm);
+    std::vector<Simulation::RunSummary> all;
+    if (rank == 0) {
+        displacements.resize(size, 0);
+        for (int iRank = 1; iRank < size; ++iRank)
+            displacements[iRank] = displacements[iRank - 1] + counts[iRank - 1];
+        all.resize((displacements.back() + counts.back()) / sizeof(Simulation::RunSummary));
+    }
+    MPI_Gatherv(summaries.data(), nbBytes, MPI_BYTE, all.data(), counts.data(),
+                displacements.data(), MPI_BYTE, 0, comm);
+    if (rank == 0) {
+        double elapsed = MPI_Wtime() - start;
+        Simulation::writeEnsembleResults(output, ensemble, all);
+        std::cout << all.size() << " runs in " << elapsed << " s on " << size
+                  << " processes (groups of " << options.group << ", " << omp_get_max_threads()
+                  << " threads each) : " << 3600. * all.size() / elapsed << " runs/hour, "
+                  << "summaries in " << options.output << std::endl;
+    }
+
+    MPI_Win_free(&queue);
+    MPI_Comm_free(&groupComm);
+    MPI_Finalize();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,343 @@
+#ifndef _NUMERIC_EXPLICIT_RUNGE_KUTTA_HPP_
+#define _NUMERIC_EXPLICIT_RUNGE_KUTTA_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "point.hpp"
+#include "vector.hpp"
+#include "vortex.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace Numeric {
+    /**
+     * @brief Butcher tableau of an explicit Runge-Kutta scheme
+     *
+     * The nodes c of the tableau are deduced from a (see node()), they are
+     * only used by the velocity sources depending on time. The weights are
+     * stored as b / weightScale so that the usual integer weights (1, 2, 2, 1
+     * for RK4) are applied before the single scaling by weightScale * dt.
+     *
+     * @tparam NbStages Number of stages of the scheme
+     */
+    template <std::size_t NbStages>
+    struct ButcherTableau {
+        static constexpr std::size_t stages = NbStages;
+        /// Strictly lower triangular matrix of the scheme
+        double a[NbStages][NbStages];
+        double b[NbStages];
+        double weightScale;
+        unsigned order;
+    };
+
+    /**
+     * @brief Whether the scheme is explicit (a strictly lower triangular) and
+     * its weights sum to one
+     */
+    template <std::size_t NbStages>
+    constexpr bool isConsistent(const ButcherTableau<NbStages> & t_tableau) {
+        double sumB = 0.;
+        for (std::size_t i = 0; i < NbStages; ++i) {
+            sumB += t_tableau.b[i];
+            for (std::size_t j = i; j < NbStages; ++j) {
+                if (t_tableau.a[i][j] != 0.)
+                    return false;
+            }
+        }
+        double error = sumB * t_tableau.weightScale - 1.;
+        return error < 1.E-12 && error > -1.E-12;
+    }
+
+    /**
+     * @brief Node c of a stage : fraction of the time step at which its
+     * velocity is evaluated (sum of the row of a)
+     */
+    template <std::size_t NbStages>
+    constexpr double node(const ButcherTableau<NbStages> & t_tableau, std::size_t t_stage) {
+        double sum = 0.;
+        for (std::size_t j = 0; j < t_stage; ++j)
+            sum += t_tableau.a[t_stage][j];
+        return sum;
+    }
+
+    namespace Tableaux {
+        /// Heun (explicit trapezoidal rule), order 2
+        inline constexpr ButcherTableau<2> Heun { { { 0., 0. }, { 1., 0. } }, { 1., 1. }, 0.5, 2 };
+
+        /// Kutta's third order scheme
+        inline constexpr ButcherTableau<3> RK3 {
+            { { 0., 0., 0. }, { 0.5, 0., 0. }, { -1., 2., 0. } }, { 1., 4., 1. }, 1. / 6., 3
+        };
+
+        /// Classical fourth order scheme
+        inline constexpr ButcherTableau<4> RK4 {
+            { { 0., 0., 0., 0. }, { 0.5, 0., 0., 0. }, { 0., 0.5, 0., 0. }, { 0., 0., 1., 0. } },
+            { 1., 2., 2., 1. },
+            1. / 6.,
+            4
+        };
+
+        /// Fifth order solution of the Cash-Karp scheme
+        inline constexpr ButcherTableau<6> RK5 {
+            { { 0., 0., 0., 0., 0., 0. },
+              { 1. / 5., 0., 0., 0., 0., 0. },
+              { 3. / 40., 9. / 40., 0., 0., 0., 0. },
+              { 3. / 10., -9. / 10., 6. / 5., 0., 0., 0. },
+              { -11. / 54., 5. / 2., -70. / 27., 35. / 27., 0., 0. },
+              { 1631. / 55296., 175. / 512., 575. / 13824., 44275. / 110592., 253. / 4096., 0. } },
+            { 37. / 378., 0., 250. / 621., 125. / 594., 0., 512. / 1771. },
+            1.,
+            5
+        };
+
+        static_assert(isConsistent(Heun));
+        static_assert(isConsistent(RK3));
+        static_assert(isConsistent(RK4));
+        static_assert(isConsistent(RK5));
+    } // namespace Tableaux
+
+    /**
+     * @name Velocity sources
+     *
+     * Policies giving the velocity at a point and bringing a point back in the
+     * periodic domain.
+     */
+    //@{
+    /**
+     * @brief Velocity interpolated in the velocity field of a grid (particles)
+     */
+    template <typename RealType>
+    struct GridVelocity {
+        using real = RealType;
+        using point = Geometry::Point<RealType>;
+        using vector = Geometry::Vector<RealType>;
+
+        const BasicCartesianGridOfSpeed<RealType> & grid;
+
+        vector velocity(const point & p) const { return grid.computeVelocityFor(p); }
+        point wrap(const point & p) const { return grid.updatePosition(p); }
+    };
+
+    /**
+     * @brief Velocity interpolated in time between the current field of a grid
+     * and its pending one, computed for the end of the time step (particles
+     * advected while the vortices move)
+     */
+    template <typename RealType>
+    struct InterpolatedGridVelocity {
+        using real = RealType;
+        using point = Geometry::Point<RealType>;
+        using vector = Geometry::Vector<RealType>;
+
+        const BasicCartesianGridOfSpeed<RealType> & grid;
+
+        vector velocity(const point & p) const { return grid.computeVelocityFor(p); }
+        /// Velocity at the fraction t_theta of the time step
+        vector velocity(const point & p, RealType t_theta) const {
+            return grid.computeVelocityFor(p, t_theta);
+        }
+        point wrap(const point & p) const { return grid.updatePosition(p); }
+    };
+
+    /**
+     * @brief Velocity summed directly over the vortices, for batches of
+     * particles (see advanceBatch)
+     *
+     * Exact, and cheaper than GridVelocity as long as there are few vortices.
+     */
+    template <typename RealType, typename Grid>
+    struct DirectVelocity {
+        using real = RealType;
+        using point = Geometry::Point<RealType>;
+        using vector = Geometry::Vector<RealType>;
+
+        const Simulation::Vortices & vortices;
+        const Grid & grid; ///< Only used for the periodicity of the domain
+
+        void velocities(std::size_t t_nbPoints,
+                        const point * t_points,
+                        vector * t_velocities) const {
+            vortices.computeSpeeds(t_nbPoints, t_points, t_velocities);
+        }
+        point wrap(const point & p) const { return grid.updatePosition(p); }
+    };
+
+    /**
+     * @brief Velocity summed directly over the vortices (vortex centers)
+     */
+    template <typename Grid>
+    struct VortexVelocity {
+        using real = double;
+        using point = Simulation::Vortices::point;
+        using vector = Simulation::Vortices::vector;
+
+        const Simulation::Vortices & vortices;
+        const Grid & grid; ///< Only used for the periodicity of the domain
+
+        vector velocity(const point & p) const { return vortices.computeSpeed(p); }
+        point wrap(const point & p) const { return grid.updatePosition(p); }
+    };
+    //@}
+
+    namespace detail {
+        /**
+         * @brief Coefficient j of the row Row of the tableau : a[Row][j] for
+         * a stage, b[j] for Row == stages
+         */
+        template <const auto & Tableau, std::size_t Row, std::size_t J>
+        constexpr double coefficient() {
+            if constexpr (Row < Tableau.stages)
+                return Tableau.a[Row][J];
+            else
+                return Tableau.b[J];
+        }
+
+        /**
+         * @brief Sum of the coefficient(j) k(j) for j in Js
+         *
+         * The null coefficients are skipped and the unit ones are not
+         * multiplied, at compile time.
+         *
+         * @param k Gives the slope of the stage j (k(j))
+         */
+        template <const auto & Tableau, std::size_t Row, typename Slopes, std::size_t... Js>
+        auto combine(const Slopes & k, std::index_sequence<Js...>) {
+            using VectorType = std::decay_t<decltype(k(0))>;
+            using real = decltype(VectorType::x);
+            VectorType sum;
+            bool isFirst = true;
+            auto add = [&]<std::size_t J>(std::integral_constant<std::size_t, J>) {
+                constexpr double c = coefficient<Tableau, Row, J>();
+                if constexpr (c != 0.) {
+                    VectorType term = k(J);
+                    if constexpr (c != 1.)
+                        term = real(c) * k(J);
+                    sum = isFirst ? term : sum + term;
+                    isFirst = false;
+                }
+            };
+            (add(std::integral_constant<std::size_t, Js> {}), ...);
+            return sum;
+        }
+
+        template <const auto & Tableau, std::size_t Stage, typename Source>
+        void computeStage(const Source & t_source,
+                          const typename Source::point & p,
+                          double dt,
+                          typename Source::vector * k) {
+            using real = typename Source::real;
+            constexpr double c = node(Tableau, Stage);
+            // Les sources dépendant du temps sont évaluées au noeud de l'étage,
+            // sauf au début du pas
+            auto velocity = [&](const typename Source::point & q) {
+                if constexpr (c != 0. && requires { t_source.velocity(q, real(c)); })
+                    return t_source.velocity(q, real(c));
+                else
+                    return t_source.velocity(q);
+            };
+            if constexpr (Stage == 0) {
+                k[0] = velocity(p);
+            } else {
+                auto increment = combine<Tableau, Stage>(
+                    [k](std::size_t j) -> const auto & { return k[j]; },
+                    std::make_index_sequence<Stage> {});
+                k[Stage] = velocity(t_source.wrap(p + real(dt) * increment));
+            }
+        }
+
+        template <const auto & Tableau, typename Source, std::size_t... Stages>
+        typename Source::point advance(const Source & t_source,
+                                       const typename Source::point & p,
+                                       double dt,
+                                       std::index_sequence<Stages...>) {
+            using real = typename Source::real;
+            typename Source::vector k[sizeof...(Stages)];
+            (computeStage<Tableau, Stages>(t_source, p, dt, k), ...);
+            auto weighted = combine<Tableau, Tableau.stages>(
+                [&k](std::size_t j) -> const auto & { return k[j]; },
+                std::index_sequence<Stages...> {});
+            return t_source.wrap(p + real(Tableau.weightScale * dt) * weighted);
+        }
+
+        /// Number of particles advanced together by advanceBatch
+        inline constexpr std::size_t batchSize = 64;
+
+        template <const auto & Tableau, typename Source, std::size_t... Stages>
+        void advanceBatch(const Source & t_source,
+                          const typename Source::point * p,
+                          typename Source::point * t_newPoints,
+                          std::size_t t_nbPoints,
+                          double dt,
+                          std::index_sequence<Stages...>) {
+            using real = typename Source::real;
+            using vector = typename Source::vector;
+            // Pentes de chaque étage pour chaque particule du lot : chaque
+            // étage calcule les vitesses du lot en un seul appel
+            vector k[sizeof...(Stages)][batchSize];
+            typename Source::point q[batchSize];
+            auto stage = [&]<std::size_t Stage>(std::integral_constant<std::size_t, Stage>) {
+                if constexpr (Stage == 0) {
+                    t_source.velocities(t_nbPoints, p, k[0]);
+                } else {
+                    for (std::size_t i = 0; i < t_nbPoints; ++i) {
+                        auto increment = combine<Tableau, Stage>(
+                            [&k, i](std::size_t j) -> const vector & { return k[j][i]; },
+                            std::make_index_sequence<Stage> {});
+                        q[i] = t_source.wrap(p[i] + real(dt) * increment);
+                    }
+                    t_source.velocities(t_nbPoints, q, k[Stage]);
+                }
+            };
+            (stage(std::integral_constant<std::size_t, Stages> {}), ...);
+            for (std::size_t i = 0; i < t_nbPoints; ++i) {
+                auto weighted = combine<Tableau, Tableau.stages>(
+                    [&k, i](std::size_t j) -> const vector & { return k[j][i]; },
+                    std::index_sequence<Stages...> {});
+                t_newPoints[i] = t_source.wrap(p[i] + real(Tableau.weightScale * dt) * weighted);
+            }
+        }
+    } // namespace detail
+
+    /**
+     * @brief Advance a point by one time step of the explicit Runge-Kutta
+     * scheme described by Tableau
+     *
+     * The stages are unrolled at compile time and the null coefficients of the
+     * tableau generate no code.
+     *
+     * @tparam Tableau A constexpr ButcherTableau (see Tableaux)
+     * @tparam Source  Velocity source (GridVelocity, InterpolatedGridVelocity or
+     *                 VortexVelocity)
+     */
+    template <const auto & Tableau, typename Source>
+    typename Source::point advance(const Source & t_source,
+                                   const typename Source::point & p,
+                                   double dt) {
+        return detail::advance<Tableau>(t_source, p, dt,
+                                        std::make_index_sequence<Tableau.stages> {});
+    }
+
+    /**
+     * @brief Advance t_nbPoints points by one time step of the scheme
+     * described by Tableau, with a source computing the velocities of many
+     * points at once (DirectVelocity)
+     *
+     * The points are advanced by batches, stage after stage, so that the
+     * velocity kernel of the source runs over whole batches.
+     */
+    template <const auto & Tableau, typename Source>
+    void advanceBatch(const Source & t_source,
+                      const typename Source::point * t_points,
+                      typename Source::point * t_newPoints,
+                      std::size_t t_nbPoints,
+                      double dt) {
+        for (std::size_t first = 0; first < t_nbPoints; first += detail::batchSize) {
+            detail::advanceBatch<Tableau>(t_source, t_points + first, t_newPoints + first,
+                                          std::min(detail::batchSize, t_nbPoints - first), dt,
+                                          std::make_index_sequence<Tableau.stages> {});
+        }
+    }
+} // namespace Numeric
+
+#endif
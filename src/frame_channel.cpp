@@ -0,0 +1,147 @@
+#include "frame_channel.hpp"
+
+#include "tracer.hpp"
+
+#include <cassert>
+
+using namespace Simulation;
+
+namespace {
+    // Au plus quelques jeux de tampons alternent (double tampon des particules
+    // et du champ), au-delà on libère les plus anciennes requêtes
+    constexpr std::size_t maxBodies = 4;
+} // namespace
+
+FrameChannel::~FrameChannel() {
+    waitSend();
+    if (m_headerRequest != MPI_REQUEST_NULL)
+        MPI_Request_free(&m_headerRequest);
+    for (auto & body : m_bodies) {
+        MPI_Request_free(&body.request);
+        MPI_Type_free(&body.type);
+    }
+}
+
+MPI_Request & FrameChannel::bodyRequest(bool isSend, const Body & t_key) {
+    // Un jeu de tampons donné garde sa requête : si seul le nombre
+    // d'éléments a changé (particules injectées ou supprimées), elle est
+    // reconstruite sur place
+    auto found = m_bodies.begin();
+    for (; found != m_bodies.end(); ++found) {
+        if (found->vortices == t_key.vortices && found->field == t_key.field
+            && found->points == t_key.points && found->hasField == t_key.hasField)
+            break;
+    }
+    if (found != m_bodies.end()) {
+        if (found->nbVortices == t_key.nbVortices && found->nbCells == t_key.nbCells
+            && found->nbPoints == t_key.nbPoints)
+            return found->request;
+        MPI_Request_free(&found->request);
+        MPI_Type_free(&found->type);
+        m_bodies.erase(found);
+    } else if (m_bodies.size() == maxBodies) {
+        MPI_Request_free(&m_bodies.front().request);
+        MPI_Type_free(&m_bodies.front().type);
+        m_bodies.erase(m_bodies.begin());
+    }
+
+    Body body = t_key;
+    int nbBlocks = 0;
+    int counts[3];
+    MPI_Aint displacements[3];
+    MPI_Datatype types[3];
+    MPI_Datatype real = Numeric::mpiType<Numeric::real>();
+    if (body.hasField) {
+        // Les vortex restent en double précision
+        types[nbBlocks] = MPI_DOUBLE;
+        counts[nbBlocks] = 3 * body.nbVortices;
+        MPI_Get_address(body.vortices, &displacements[nbBlocks++]);
+        types[nbBlocks] = real;
+        counts[nbBlocks] = 2 * body.nbCells;
+        MPI_Get_address(body.field, &displacements[nbBlocks++]);
+    }
+    types[nbBlocks] = real;
+    counts[nbBlocks] = 2 * body.nbPoints;
+    MPI_Get_address(body.points, &displacements[nbBlocks++]);
+    MPI_Type_create_struct(nbBlocks, counts, displacements, types, &body.type);
+    MPI_Type_commit(&body.type);
+
+    if (isSend)
+        MPI_Send_init(MPI_BOTTOM, 1, body.type, m_peer, BODY_TAG, m_comm, &body.request);
+    else
+        MPI_Recv_init(MPI_BOTTOM, 1, body.type, m_peer, BODY_TAG, m_comm, &body.request);
+    m_bodies.push_back(body);
+    return m_bodies.back().request;
+}
+
+void FrameChannel::startSend(const FrameHeader & t_header,
+                             const Vortices & t_vortices,
+                             const Numeric::CartesianGridOfSpeed & t_grid,
+                             const Geometry::CloudOfPoints & t_cloud) {
+    Trace::Scope scope("send frame", "mpi");
+    waitSend();
+    auto dimensions = t_grid.cellGeometry();
+    m_header = t_header;
+    m_header.nbVortices = t_vortices.numberOfVortices();
+    m_header.nbCells = dimensions.first * dimensions.second;
+    m_header.nbPoints = t_cloud.numberOfPoints();
+    m_header.fieldGeneration = t_grid.generation();
+
+    if (m_headerRequest == MPI_REQUEST_NULL)
+        MPI_Send_init(&m_header, sizeof(FrameHeader), MPI_BYTE, m_peer, HEADER_TAG, m_comm,
+                      &m_headerRequest);
+    MPI_Request & body = bodyRequest(
+        true, Body { t_vortices.data(), t_grid.data(), t_cloud.data(), m_header.nbVortices,
+                     m_header.nbCells, m_header.nbPoints, m_header.hasField != 0,
+                     MPI_DATATYPE_NULL, MPI_REQUEST_NULL });
+    MPI_Start(&m_headerRequest);
+    MPI_Start(&body);
+    m_sending = true;
+}
+
+void FrameChannel::waitSend() {
+    if (!m_sending)
+        return;
+    Trace::Scope scope("wait send", "mpi");
+    MPI_Wait(&m_headerRequest, MPI_STATUS_IGNORE);
+    // Le corps en cours d'envoi est le dernier utilisé
+    for (auto & body : m_bodies)
+        MPI_Wait(&body.request, MPI_STATUS_IGNORE);
+    m_sending = false;
+}
+
+const FrameHeader & FrameChannel::recv(Vortices & t_vortices,
+                                       Numeric::CartesianGridOfSpeed & t_grid,
+                                       Geometry::CloudOfPoints & t_cloud) {
+    if (m_headerRequest == MPI_REQUEST_NULL)
+        MPI_Recv_init(&m_header, sizeof(FrameHeader), MPI_BYTE, m_peer, HEADER_TAG, m_comm,
+                      &m_headerRequest);
+    {
+        // Attente de la fin du pas suivant
+        Trace::Scope scope("recv header", "mpi");
+        MPI_Start(&m_headerRequest);
+        MPI_Wait(&m_headerRequest, MPI_STATUS_IGNORE);
+    }
+    Trace::Scope scope("recv body", "mpi");
+
+    assert(m_header.hasField == 0 || m_header.nbVortices == t_vortices.numberOfVortices());
+    if (t_cloud.numberOfPoints() != m_header.nbPoints)
+        t_cloud.resize(m_header.nbPoints);
+
+    auto dimensions = t_grid.cellGeometry();
+    MPI_Request & body = bodyRequest(
+        false, Body { t_vortices.data(), t_grid.data(), t_cloud.data(), m_header.nbVortices,
+                      dimensions.first * dimensions.second, m_header.nbPoints,
+                      m_header.hasField != 0, MPI_DATATYPE_NULL, MPI_REQUEST_NULL });
+    MPI_Start(&body);
+    MPI_Wait(&body, MPI_STATUS_IGNORE);
+    if (m_header.hasField != 0)
+        t_grid.setGeneration(m_header.fieldGeneration);
+    return m_header;
+}
+
+bool FrameChannel::hasFrame() const {
+    int flag;
+    MPI_Iprobe(m_peer, HEADER_TAG, m_comm, &flag, MPI_STATUS_IGNORE);
+    return flag != 0;
+}
@@ -0,0 +1,120 @@
+#ifndef _SIMULATION_FRAME_CHANNEL_HPP_
+#define _SIMULATION_FRAME_CHANNEL_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "cloud_of_points.hpp"
+#include "vortex.hpp"
+
+#include <cstdint>
+#include <mpi.h>
+#include <vector>
+
+namespace Simulation {
+    /**
+     * @brief Description of a frame, sent before its content
+     */
+    struct FrameHeader {
+        std::uint64_t step = 0;
+        double dt = 0.;
+        double time = 0.;
+        std::uint64_t nbVortices = 0;
+        std::uint64_t nbCells = 0;
+        std::uint64_t nbPoints = 0;
+        /// Whether the frame contains the vortices and the velocity field
+        std::uint64_t hasField = 0;
+        /// Generation of the velocity field (see CartesianGridOfSpeed::generation)
+        std::uint64_t fieldGeneration = 0;
+    };
+
+    /**
+     * @brief Per-frame transfer of the state of the simulation between two
+     * processes
+     *
+     * A frame is made of two messages : a fixed size header (FrameHeader) and a
+     * body holding the vortices, the velocity field and the particles. The body
+     * is described by a derived datatype built on the addresses of the buffers
+     * of the containers, so it is sent and received in place without packing.
+     * Both messages use persistent requests (MPI_Send_init / MPI_Recv_init),
+     * which are built once per set of buffers and reused as long as the
+     * buffers do not move.
+     *
+     * Since the receiver reads the header first, it can resize the cloud of
+     * points before receiving the body : the number of particles may change
+     * from one frame to the next.
+     */
+    class FrameChannel {
+    public:
+        constexpr static int HEADER_TAG = 'H';
+        constexpr static int BODY_TAG = 'B';
+
+        /**
+         * @param t_comm The communicator
+         * @param t_peer Rank of the other process in t_comm
+         */
+        FrameChannel(MPI_Comm t_comm, int t_peer) : m_comm(t_comm), m_peer(t_peer) {}
+        FrameChannel(const FrameChannel &) = delete;
+        FrameChannel & operator=(const FrameChannel &) = delete;
+        ~FrameChannel();
+
+        /**
+         * @brief Start sending a frame
+         *
+         * The buffers must not be modified before waitSend() returns.
+         *
+         * @param t_header Step, time step and simulation time of the frame (the
+         *                 counts are filled from the containers)
+         */
+        void startSend(const FrameHeader & t_header,
+                       const Vortices & t_vortices,
+                       const Numeric::CartesianGridOfSpeed & t_grid,
+                       const Geometry::CloudOfPoints & t_cloud);
+        /**
+         * @brief Wait for the end of the frame being sent, if any
+         */
+        void waitSend();
+
+        /**
+         * @brief Receive a frame
+         *
+         * The vortices and the field are only updated if the frame holds them,
+         * the cloud is resized to the number of particles of the frame.
+         *
+         * @return The header of the received frame
+         */
+        const FrameHeader & recv(Vortices & t_vortices,
+                                 Numeric::CartesianGridOfSpeed & t_grid,
+                                 Geometry::CloudOfPoints & t_cloud);
+
+        /**
+         * @brief Whether the header of a frame has arrived, so that recv()
+         * does not wait for the next time step
+         */
+        bool hasFrame() const;
+
+        const FrameHeader & header() const { return m_header; }
+
+    private:
+        struct Body {
+            const void * vortices;
+            const void * field;
+            const void * points;
+            std::size_t nbVortices, nbCells, nbPoints;
+            bool hasField;
+            MPI_Datatype type;
+            MPI_Request request;
+        };
+
+        /**
+         * @brief Persistent request of the body matching t_key, built if needed
+         */
+        MPI_Request & bodyRequest(bool isSend, const Body & t_key);
+
+        MPI_Comm m_comm;
+        int m_peer;
+        FrameHeader m_header;
+        MPI_Request m_headerRequest = MPI_REQUEST_NULL;
+        std::vector<Body> m_bodies;
+        bool m_sending = false;
+    };
+} // namespace Simulation
+
+#endif
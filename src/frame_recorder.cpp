@@ -0,0 +1,108 @@
+#include "frame_recorder.hpp"
+
+#include "tracer.hpp"
+
+#include <SFML/Graphics/Image.hpp>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+using namespace Graphisme;
+
+FrameRecorder::FrameRecorder(const std::string & t_prefix,
+                             Format t_format,
+                             std::size_t t_width,
+                             std::size_t t_height)
+    : m_prefix(t_prefix), m_format(t_format), m_width(t_width), m_height(t_height) {
+    auto directory = std::filesystem::path(m_prefix).parent_path();
+    if (!directory.empty())
+        std::filesystem::create_directories(directory);
+    // Tous les tampons sont alloués une fois pour toutes
+    for (std::size_t iSlot = 0; iSlot < ringSize; ++iSlot) {
+        m_slots[iSlot].pixels.resize(4 * m_width * m_height);
+        m_free.push(iSlot);
+    }
+    m_index.open(m_prefix + "frames.csv");
+    if (!m_index)
+        throw std::ios_base::failure("Cannot create " + m_prefix + "frames.csv");
+    m_index << "frame,file,step,time,dropped_before" << std::endl;
+    m_writer = std::thread(&FrameRecorder::writeLoop, this);
+}
+
+FrameRecorder::~FrameRecorder() { finish(); }
+
+std::uint8_t * FrameRecorder::acquire(std::size_t t_step, double t_time) {
+    auto iSlot = m_free.pop();
+    if (!iSlot) {
+        // L'écriture a pris du retard : l'image est perdue, le calcul
+        // n'attend pas
+        ++m_nbDropped;
+        ++m_nbDroppedSinceCommit;
+        return nullptr;
+    }
+    m_acquired = *iSlot;
+    Slot & slot = m_slots[m_acquired];
+    slot.step = t_step;
+    slot.time = t_time;
+    slot.nbDroppedBefore = m_nbDroppedSinceCommit;
+    return slot.pixels.data();
+}
+
+void FrameRecorder::commit() {
+    if (m_acquired == ringSize)
+        return;
+    // Toujours de la place : la file contient au plus ringSize tampons
+    m_pending.push(m_acquired);
+    m_acquired = ringSize;
+    m_nbDroppedSinceCommit = 0;
+}
+
+void FrameRecorder::finish() {
+    if (!m_writer.joinable())
+        return;
+    m_stop.store(true, std::memory_order_release);
+    m_writer.join();
+    m_index.close();
+}
+
+void FrameRecorder::writeLoop() {
+    Trace::setThreadName("frame writer");
+    while (true) {
+        // Lu avant la file : une image confiée avant l'arrêt est toujours vue
+        bool stop = m_stop.load(std::memory_order_acquire);
+        if (auto iSlot = m_pending.pop()) {
+            write(m_slots[*iSlot]);
+            m_free.push(*iSlot);
+            continue;
+        }
+        if (stop)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void FrameRecorder::write(const Slot & t_slot) {
+    Trace::Scope scope("write frame", "io");
+    std::size_t frame = m_nbWritten.load(std::memory_order_relaxed);
+    char number[16];
+    std::snprintf(number, sizeof(number), "%06zu", frame);
+    std::string fileName = m_prefix + number + (m_format == Format::Png ? ".png" : ".rgba");
+
+    bool isWritten;
+    if (m_format == Format::Png) {
+        sf::Image image;
+        image.create(m_width, m_height, t_slot.pixels.data());
+        isWritten = image.saveToFile(fileName);
+    } else {
+        std::ofstream output(fileName, std::ios::binary);
+        output.write(reinterpret_cast<const char *>(t_slot.pixels.data()), t_slot.pixels.size());
+        isWritten = bool(output);
+    }
+    if (!isWritten)
+        std::cerr << "Failed to write " << fileName << std::endl;
+
+    m_index << frame << ',' << fileName << ',' << t_slot.step << ',' << t_slot.time << ','
+            << t_slot.nbDroppedBefore << '\n';
+    m_nbWritten.store(frame + 1, std::memory_order_release);
+}
@@ -0,0 +1,111 @@
+#ifndef _GRAPHISM_FRAME_RECORDER_HPP_
+#define _GRAPHISM_FRAME_RECORDER_HPP_
+#include "spsc_queue.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Graphisme {
+    /**
+     * @brief Writes a sequence of frames to disk from a background thread
+     *
+     * The frames live in a ring of ringSize preallocated RGBA buffers. The
+     * producer asks for a free buffer (acquire()), draws the frame in it and
+     * hands it over (commit()) : nothing is copied nor allocated, and the
+     * producer never waits for the disk. When the writer thread falls behind
+     * and every buffer is in use, acquire() returns nullptr and the frame is
+     * dropped and counted.
+     *
+     * The files are numbered without gaps (prefix000000.png, ...) so they can
+     * be assembled directly into a video. An index, prefix + "frames.csv",
+     * gives for each file the step and the time of its frame and the number
+     * of frames dropped just before it.
+     */
+    class FrameRecorder {
+    public:
+        enum class Format { Png, Raw };
+
+        /// Number of frame buffers between the producer and the writer
+        static constexpr std::size_t ringSize = 8;
+
+        /**
+         * @param t_prefix Path and start of the name of the files, its
+         *                 directory is created if needed
+         * @param t_format PNG images, or raw RGBA bytes (4 bytes per pixel,
+         *                 row by row from the top, no header)
+         */
+        FrameRecorder(const std::string & t_prefix,
+                      Format t_format,
+                      std::size_t t_width,
+                      std::size_t t_height);
+        FrameRecorder(const FrameRecorder &) = delete;
+        FrameRecorder & operator=(const FrameRecorder &) = delete;
+        /// Write the pending frames, then stop the writer thread
+        ~FrameRecorder();
+
+        /**
+         * @brief Free buffer for the frame of the step t_step (4 * width *
+         * height bytes), nullptr if the frame has to be dropped
+         *
+         * Must be followed by commit() before the next call.
+         */
+        std::uint8_t * acquire(std::size_t t_step, double t_time);
+        /// Hand the frame drawn in the last acquired buffer over to the writer
+        void commit();
+
+        /// Write the pending frames and stop the writer thread
+        void finish();
+
+        std::size_t nbWritten() const { return m_nbWritten.load(std::memory_order_acquire); }
+        std::size_t nbDropped() const { return m_nbDropped; }
+
+    private:
+        struct Slot {
+            std::vector<std::uint8_t> pixels;
+            std::size_t step = 0;
+            double time = 0.;
+            /// Frames dropped between the previous committed frame and this one
+            std::size_t nbDroppedBefore = 0;
+        };
+
+        void writeLoop();
+        void write(const Slot & t_slot);
+
+        std::string m_prefix;
+        Format m_format;
+        std::size_t m_width, m_height;
+        std::array<Slot, ringSize> m_slots;
+        /// Buffers free for the producer, and frames waiting for the writer
+        SpscQueue<std::size_t, ringSize> m_free, m_pending;
+        std::size_t m_acquired = ringSize;
+
+        std::size_t m_nbDropped = 0, m_nbDroppedSinceCommit = 0;
+        std::atomic<std::size_t> m_nbWritten { 0 };
+        std::atomic<bool> m_stop { false };
+        std::ofstream m_index;
+        std::thread m_writer;
+    };
+
+    /**
+     * @brief Format named t_name (png or raw)
+     *
+     * Throw std::invalid_argument on an unknown name.
+     */
+    inline FrameRecorder::Format parseFrameFormat(std::string_view t_name) {
+        if (t_name == "png")
+            return FrameRecorder::Format::Png;
+        if (t_name == "raw")
+            return FrameRecorder::Format::Raw;
+        throw std::invalid_argument("Unknown frame format " + std::string(t_name));
+    }
+} // namespace Graphisme
+
+#endif
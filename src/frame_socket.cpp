@@ -0,0 +1,483 @@
+#include "frame_socket.hpp"
+
+#include "tracer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace Simulation;
+
+namespace {
+    static_assert(std::endian::native == std::endian::little,
+                  "The frame protocol is little endian");
+    static_assert(sizeof(UiEvent) == 1, "An order is sent as one byte");
+    static_assert(sizeof(Wire::MessageHeader) == 16);
+
+    constexpr std::size_t headerSize = sizeof(Wire::MessageHeader);
+    // Coordonnées des particules codées sur 16 bits
+    constexpr double quantumsPerLength = 65536.;
+    constexpr std::size_t encodedPointSize = 2 * sizeof(std::uint16_t);
+
+    [[noreturn]] void fail(const std::string & t_what) {
+        throw std::runtime_error(t_what + " : " + std::strerror(errno));
+    }
+
+    /**
+     * @brief Socket listening on t_address (t_listen) or connected to it
+     */
+    int openSocket(const SocketAddress & t_address, bool t_listen) {
+        if (t_address.isUnix) {
+            sockaddr_un address {};
+            address.sun_family = AF_UNIX;
+            if (t_address.host.size() >= sizeof(address.sun_path))
+                throw std::runtime_error("Socket path too long : " + t_address.host);
+            std::strcpy(address.sun_path, t_address.host.c_str());
+            // Seul un socket laissé par un serveur précédent est remplacé
+            struct stat status;
+            bool exists = t_listen && ::lstat(address.sun_path, &status) == 0;
+            if (exists && !S_ISSOCK(status.st_mode))
+                throw std::runtime_error(t_address.host + " exists and is not a socket");
+            int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd < 0)
+                fail("Cannot create a socket");
+            if (t_listen) {
+                if (exists)
+                    ::unlink(address.sun_path);
+                if (::bind(fd, (sockaddr *)&address, sizeof(address)) == 0 && ::listen(fd, 16) == 0)
+                    return fd;
+            } else if (::connect(fd, (sockaddr *)&address, sizeof(address)) == 0) {
+                return fd;
+            }
+            int error = errno;
+            ::close(fd);
+            errno = error;
+            fail("Cannot " + std::string(t_listen ? "listen on " : "connect to ") + t_address.host);
+        }
+
+        addrinfo hints {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = t_listen ? AI_PASSIVE : 0;
+        addrinfo * addresses = nullptr;
+        const char * host = t_address.host.empty() ? nullptr : t_address.host.c_str();
+        if (int error = ::getaddrinfo(host, t_address.port.c_str(), &hints, &addresses); error != 0)
+            throw std::runtime_error("Cannot resolve " + t_address.host + " : "
+                                     + ::gai_strerror(error));
+        int fd = -1;
+        for (addrinfo * address = addresses; address && fd < 0; address = address->ai_next) {
+            fd = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (fd < 0)
+                continue;
+            int one = 1;
+            bool isOpen;
+            if (t_listen) {
+                ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+                isOpen = ::bind(fd, address->ai_addr, address->ai_addrlen) == 0
+                         && ::listen(fd, 16) == 0;
+            } else {
+                isOpen = ::connect(fd, address->ai_addr, address->ai_addrlen) == 0;
+                // Les ordres d'un octet partent sans attendre
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+            if (!isOpen) {
+                int error = errno;
+                ::close(fd);
+                errno = error;
+                fd = -1;
+            }
+        }
+        ::freeaddrinfo(addresses);
+        if (fd < 0)
+            fail("Cannot " + std::string(t_listen ? "listen on port " : "connect to port ")
+                 + t_address.port + " of " + (host ? t_address.host : "this host"));
+        return fd;
+    }
+
+    std::vector<char> makeMessage(Wire::MessageType t_type, std::size_t t_length) {
+        std::vector<char> message(headerSize + t_length);
+        Wire::MessageHeader header;
+        header.type = t_type;
+        header.length = t_length;
+        std::memcpy(message.data(), &header, headerSize);
+        return message;
+    }
+
+    bool isValid(const Wire::MessageHeader & t_header) {
+        return t_header.magic == Wire::magic && t_header.version == Wire::version;
+    }
+
+    /// Order coded by t_byte, Noop if it is not one
+    UiEvent decodeOrder(char t_byte) {
+        UiEvent order;
+        std::memcpy(&order, &t_byte, 1);
+        for (UiEvent known : UiEvent::knownEvents) {
+            if (std::memcmp(&order, &known, 1) == 0)
+                return order;
+        }
+        return UiEvent::Noop;
+    }
+} // namespace
+
+SocketAddress SocketAddress::parse(const std::string & t_text) {
+    SocketAddress address;
+    if (t_text.starts_with("unix:") && t_text.size() > 5) {
+        address.isUnix = true;
+        address.host = t_text.substr(5);
+        return address;
+    }
+    auto colon = t_text.rfind(':');
+    if (!t_text.starts_with("tcp:") || colon < 4 || colon + 1 == t_text.size())
+        throw std::invalid_argument("Expected tcp:<host>:<port> or unix:<path>, not " + t_text);
+    address.host = t_text.substr(4, colon - 4);
+    address.port = t_text.substr(colon + 1);
+    return address;
+}
+
+std::ostream & Simulation::operator<<(std::ostream & os, const SocketAddress & t_address) {
+    if (t_address.isUnix)
+        return os << "unix:" << t_address.host;
+    return os << "tcp:" << t_address.host << ':' << t_address.port;
+}
+
+FrameServer::FrameServer(const SocketAddress & t_address,
+                         const Numeric::CartesianGridOfSpeed & t_grid,
+                         std::size_t t_nbVortices,
+                         std::size_t t_maxPoints)
+    : m_address(t_address) {
+    m_listener = openSocket(t_address, true);
+    ::fcntl(m_listener, F_SETFL, ::fcntl(m_listener, F_GETFL) | O_NONBLOCK);
+    auto origin = t_grid.getLeftBottomVertex();
+    auto dimensions = t_grid.cellGeometry();
+    m_geometry = { origin.x,     origin.y,    t_grid.getStep(), dimensions.first, dimensions.second,
+                   t_nbVortices, t_maxPoints };
+}
+
+FrameServer::~FrameServer() {
+    for (auto & viewer : m_viewers)
+        ::close(viewer.socket);
+    ::close(m_listener);
+    if (m_address.isUnix)
+        ::unlink(m_address.host.c_str());
+}
+
+bool FrameServer::wantsFrame() const {
+    return std::any_of(m_viewers.begin(), m_viewers.end(), [](const Viewer & t_viewer) {
+        return !t_viewer.hasFrame && !t_viewer.waiting;
+    });
+}
+
+bool FrameServer::flush(Viewer & t_viewer) {
+    while (t_viewer.sending) {
+        const auto & bytes = *t_viewer.sending;
+        ssize_t nbBytes = ::send(t_viewer.socket, bytes.data() + t_viewer.offset,
+                                 bytes.size() - t_viewer.offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (nbBytes < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        t_viewer.offset += std::size_t(nbBytes);
+        if (t_viewer.offset < bytes.size())
+            continue;
+        if (t_viewer.hasFrame)
+            ++m_nbSent;
+        // L'image en attente part à son tour
+        t_viewer.sending = std::move(t_viewer.waiting);
+        t_viewer.waiting.reset();
+        t_viewer.offset = 0;
+        if (t_viewer.sending) {
+            t_viewer.hasFrame = true;
+            t_viewer.hasField = t_viewer.hasField || t_viewer.waitingHasField;
+        }
+    }
+    return true;
+}
+
+bool FrameServer::read(Viewer & t_viewer, std::vector<UiEvent> & t_orders) {
+    char buffer[4096];
+    while (true) {
+        ssize_t nbBytes = ::recv(t_viewer.socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (nbBytes == 0)
+            return false;
+        if (nbBytes < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+                break;
+            return false;
+        }
+        t_viewer.received.insert(t_viewer.received.end(), buffer, buffer + nbBytes);
+    }
+    std::size_t first = 0;
+    auto & received = t_viewer.received;
+    while (received.size() - first >= headerSize) {
+        Wire::MessageHeader header;
+        std::memcpy(&header, received.data() + first, headerSize);
+        if (!isValid(header) || header.type != Wire::MessageType::Order || header.length != 1)
+            return false;
+        if (received.size() - first < headerSize + 1)
+            break;
+        UiEvent order = decodeOrder(received[first + headerSize]);
+        first += headerSize + 1;
+        // Une fenêtre fermée ne concerne que son spectateur
+        if (order == UiEvent::CloseWindow)
+            return false;
+        if (!(order == UiEvent::Noop))
+            t_orders.push_back(order);
+    }
+    received.erase(received.begin(), received.begin() + first);
+    return true;
+}
+
+std::vector<UiEvent> FrameServer::poll(int t_timeout) {
+    std::vector<pollfd> sockets { pollfd { m_listener, POLLIN, 0 } };
+    for (const auto & viewer : m_viewers)
+        sockets.push_back(
+            pollfd { viewer.socket, short(POLLIN | (viewer.sending ? POLLOUT : 0)), 0 });
+    std::vector<UiEvent> orders;
+    if (::poll(sockets.data(), sockets.size(), t_timeout) <= 0)
+        return orders;
+    Trace::Scope scope("serve viewers", "socket");
+
+    std::vector<bool> isGone(m_viewers.size(), false);
+    for (std::size_t iViewer = 0; iViewer < m_viewers.size(); ++iViewer) {
+        short events = sockets[iViewer + 1].revents;
+        if (events & (POLLIN | POLLHUP | POLLERR))
+            isGone[iViewer] = !read(m_viewers[iViewer], orders);
+        if (!isGone[iViewer] && (events & POLLOUT))
+            isGone[iViewer] = !flush(m_viewers[iViewer]);
+    }
+    for (std::size_t iViewer = m_viewers.size(); iViewer-- > 0;) {
+        if (isGone[iViewer]) {
+            ::close(m_viewers[iViewer].socket);
+            m_viewers.erase(m_viewers.begin() + iViewer);
+        }
+    }
+
+    if (sockets[0].revents & POLLIN) {
+        int socket;
+        while ((socket = ::accept(m_listener, nullptr, nullptr)) >= 0) {
+            ::fcntl(socket, F_SETFL, ::fcntl(socket, F_GETFL) | O_NONBLOCK);
+            if (!m_address.isUnix) {
+                int one = 1;
+                ::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+            auto hello = makeMessage(Wire::MessageType::Hello, sizeof(Wire::GridGeometry));
+            std::memcpy(hello.data() + headerSize, &m_geometry, sizeof(Wire::GridGeometry));
+            Viewer viewer { socket };
+            viewer.sending = std::make_shared<const std::vector<char>>(std::move(hello));
+            if (flush(viewer)) {
+                m_viewers.push_back(std::move(viewer));
+                ++m_nbConnections;
+            } else {
+                ::close(socket);
+            }
+        }
+    }
+    return orders;
+}
+
+void FrameServer::publish(const FrameHeader & t_header,
+                          const Vortices & t_vortices,
+                          const Numeric::CartesianGridOfSpeed & t_grid,
+                          const Geometry::CloudOfPoints & t_cloud) {
+    if (m_viewers.empty())
+        return;
+    Trace::Scope scope("publish frame", "socket");
+    // Un nouveau spectateur reçoit le champ avec sa première image
+    bool withField = t_header.hasField != 0
+                     || std::any_of(m_viewers.begin(), m_viewers.end(),
+                                    [](const Viewer & t_viewer) { return !t_viewer.hasField; });
+    FrameHeader header = t_header;
+    auto dimensions = t_grid.cellGeometry();
+    header.nbVortices = t_vortices.numberOfVortices();
+    header.nbCells = dimensions.first * dimensions.second;
+    header.nbPoints = t_cloud.numberOfPoints();
+    header.hasField = withField;
+    header.fieldGeneration = t_grid.generation();
+
+    std::size_t vorticesSize = 3 * header.nbVortices * sizeof(double);
+    std::size_t fieldSize = withField ? 2 * header.nbCells * sizeof(float) : 0;
+    auto message = makeMessage(Wire::MessageType::Frame, sizeof(FrameHeader) + vorticesSize
+                                                             + fieldSize
+                                                             + header.nbPoints * encodedPointSize);
+    char * out = message.data() + headerSize;
+    std::memcpy(out, &header, sizeof(FrameHeader));
+    out += sizeof(FrameHeader);
+    std::memcpy(out, t_vortices.data(), vorticesSize);
+    out += vorticesSize;
+    if (withField) {
+        // Le champ voyage en simple précision quelle que soit celle du calcul
+        float * field = reinterpret_cast<float *>(out);
+        const Numeric::CartesianGridOfSpeed::real * values = t_grid.data();
+        for (std::size_t iValue = 0; iValue < 2 * header.nbCells; ++iValue)
+            field[iValue] = float(values[iValue]);
+        out += fieldSize;
+    }
+    std::uint16_t * points = reinterpret_cast<std::uint16_t *>(out);
+    // Chaque coordonnée est codée sur la dimension du domaine dans sa direction
+    double scaleX = quantumsPerLength / (m_geometry.step * m_geometry.width);
+    double scaleY = quantumsPerLength / (m_geometry.step * m_geometry.height);
+    std::int64_t nbPoints = header.nbPoints;
+#pragma omp parallel for schedule(static)
+    for (std::int64_t iPoint = 0; iPoint < nbPoints; ++iPoint) {
+        auto encode = [](double t_offset, double t_scale) {
+            return std::uint16_t(std::clamp(t_offset * t_scale, 0., quantumsPerLength - 1.));
+        };
+        points[2 * iPoint + 0] = encode(t_cloud[iPoint].x - m_geometry.left, scaleX);
+        points[2 * iPoint + 1] = encode(t_cloud[iPoint].y - m_geometry.bottom, scaleY);
+    }
+    Message shared = std::make_shared<const std::vector<char>>(std::move(message));
+
+    for (auto & viewer : m_viewers) {
+        // Un spectateur lent perd l'image qui attendait encore
+        if (viewer.waiting)
+            ++m_nbDropped;
+        viewer.waiting = shared;
+        viewer.waitingHasField = withField;
+        if (!viewer.sending) {
+            viewer.sending = std::move(viewer.waiting);
+            viewer.waiting.reset();
+            viewer.offset = 0;
+            viewer.hasFrame = true;
+            viewer.hasField = viewer.hasField || withField;
+        }
+    }
+    // Les spectateurs partis sont oubliés au prochain poll()
+    for (auto & viewer : m_viewers)
+        flush(viewer);
+}
+
+FrameClient::FrameClient(const SocketAddress & t_address) {
+    m_socket = openSocket(t_address, false);
+    Wire::MessageHeader header;
+    if (!readAll(&header, headerSize) || !isValid(header)
+        || header.type != Wire::MessageType::Hello
+        || header.length != sizeof(Wire::GridGeometry) || !readAll(&m_geometry, header.length)) {
+        disconnect();
+        throw std::runtime_error("No vortex simulation is serving frames on the socket");
+    }
+}
+
+FrameClient::~FrameClient() { disconnect(); }
+
+void FrameClient::disconnect() {
+    if (m_socket >= 0)
+        ::close(m_socket);
+    m_socket = -1;
+}
+
+bool FrameClient::readAll(void * t_data, std::size_t t_size) {
+    char * data = static_cast<char *>(t_data);
+    while (t_size > 0) {
+        ssize_t nbBytes = ::recv(m_socket, data, t_size, 0);
+        if (nbBytes < 0 && errno == EINTR)
+            continue;
+        if (nbBytes <= 0) {
+            disconnect();
+            return false;
+        }
+        data += nbBytes;
+        t_size -= std::size_t(nbBytes);
+    }
+    return true;
+}
+
+bool FrameClient::receive(int t_timeout,
+                          Vortices & t_vortices,
+                          Numeric::CartesianGridOfSpeed & t_grid,
+                          Geometry::CloudOfPoints & t_cloud) {
+    bool hasFrame = false;
+    // Toutes les images déjà arrivées sont lues, la dernière reste
+    while (isConnected()) {
+        pollfd socket { m_socket, POLLIN, 0 };
+        if (::poll(&socket, 1, hasFrame ? 0 : t_timeout) <= 0)
+            break;
+        Wire::MessageHeader header;
+        if (!readAll(&header, headerSize))
+            break;
+        if (!isValid(header) || header.type != Wire::MessageType::Frame) {
+            disconnect();
+            throw std::runtime_error("Unexpected message from the simulation");
+        }
+        // La longueur vient du pair : rien n'est alloué au-delà de la plus grande image
+        std::size_t nbCells = m_geometry.width * m_geometry.height;
+        std::size_t maxLength = sizeof(FrameHeader) + 3 * m_geometry.nbVortices * sizeof(double)
+                                + 2 * nbCells * sizeof(float)
+                                + m_geometry.maxPoints * encodedPointSize;
+        if (header.length < sizeof(FrameHeader) || header.length > maxLength) {
+            disconnect();
+            throw std::runtime_error("Malformed frame from the simulation");
+        }
+        m_payload.resize(header.length);
+        if (!readAll(m_payload.data(), m_payload.size()))
+            break;
+        Trace::Scope scope("decode frame", "socket");
+
+        const char * in = m_payload.data();
+        std::memcpy(&m_header, in, sizeof(FrameHeader));
+        in += sizeof(FrameHeader);
+        std::size_t vorticesSize = 3 * m_header.nbVortices * sizeof(double);
+        std::size_t fieldSize = m_header.hasField ? 2 * nbCells * sizeof(float) : 0;
+        if (m_header.nbCells != nbCells || m_header.nbVortices > m_geometry.nbVortices
+            || m_header.nbPoints > m_geometry.maxPoints
+            || m_payload.size() != sizeof(FrameHeader) + vorticesSize + fieldSize
+                                       + m_header.nbPoints * encodedPointSize) {
+            disconnect();
+            throw std::runtime_error("Malformed frame from the simulation");
+        }
+        if (t_vortices.numberOfVortices() != m_header.nbVortices) {
+            Vortices::point leftBottom { m_geometry.left, m_geometry.bottom };
+            Vortices::point rightTop { m_geometry.left + m_geometry.width * m_geometry.step,
+                                       m_geometry.bottom + m_geometry.height * m_geometry.step };
+            t_vortices = Vortices(m_header.nbVortices, { leftBottom, rightTop });
+        }
+        std::memcpy(t_vortices.data(), in, vorticesSize);
+        in += vorticesSize;
+        if (m_header.hasField) {
+            const float * field = reinterpret_cast<const float *>(in);
+            Numeric::CartesianGridOfSpeed::real * values = t_grid.data();
+            for (std::size_t iValue = 0; iValue < 2 * nbCells; ++iValue)
+                values[iValue] = field[iValue];
+            t_grid.setGeneration(m_header.fieldGeneration);
+            in += fieldSize;
+        }
+        if (t_cloud.numberOfPoints() != m_header.nbPoints)
+            t_cloud.resize(m_header.nbPoints);
+        const std::uint16_t * points = reinterpret_cast<const std::uint16_t *>(in);
+        double quantumX = m_geometry.step * m_geometry.width / quantumsPerLength;
+        double quantumY = m_geometry.step * m_geometry.height / quantumsPerLength;
+        for (std::size_t iPoint = 0; iPoint < m_header.nbPoints; ++iPoint) {
+            t_cloud[iPoint].x = m_geometry.left + (points[2 * iPoint + 0] + 0.5) * quantumX;
+            t_cloud[iPoint].y = m_geometry.bottom + (points[2 * iPoint + 1] + 0.5) * quantumY;
+        }
+        hasFrame = true;
+    }
+    return hasFrame;
+}
+
+void FrameClient::send(UiEvent t_order) {
+    if (!isConnected())
+        return;
+    auto message = makeMessage(Wire::MessageType::Order, 1);
+    std::memcpy(message.data() + headerSize, &t_order, 1);
+    std::size_t offset = 0;
+    while (offset < message.size()) {
+        ssize_t nbBytes =
+            ::send(m_socket, message.data() + offset, message.size() - offset, MSG_NOSIGNAL);
+        if (nbBytes < 0 && errno == EINTR)
+            continue;
+        if (nbBytes < 0) {
+            disconnect();
+            return;
+        }
+        offset += std::size_t(nbBytes);
+    }
+}
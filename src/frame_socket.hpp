@@ -0,0 +1,216 @@
+#ifndef _SIMULATION_FRAME_SOCKET_HPP_
+#define _SIMULATION_FRAME_SOCKET_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "cloud_of_points.hpp"
+#include "frame_channel.hpp"
+#include "ui_events.hpp"
+#include "vortex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Simulation {
+    /**
+     * @brief Address of a frame server : "tcp:<host>:<port>" or
+     * "unix:<path>"
+     */
+    struct SocketAddress {
+        bool isUnix = false;
+        /// Host (tcp) or path of the socket file (unix)
+        std::string host;
+        std::string port;
+
+        /**
+         * @brief Throw std::invalid_argument if t_text is not an address
+         */
+        static SocketAddress parse(const std::string & t_text);
+    };
+
+    /**
+     * @brief Binary protocol between a simulation and its remote viewers
+     *
+     * Every message starts with a MessageHeader, followed by length bytes of
+     * payload. Values are sent in the byte order of the machine, both ends
+     * being little endian.
+     *
+     * - Hello (server to viewer, once on connection) : GridGeometry, from
+     *   which the viewer builds its grid and its window.
+     * - Frame (server to viewer) : FrameHeader, then the vortices (3 doubles
+     *   each, always), the velocity field (2 floats per cell, only if
+     *   hasField) and the particles, each coordinate encoded on 16 bits over
+     *   the domain (a 65536th of its width or height, far below a pixel).
+     * - Order (viewer to server) : one byte, the UiEvent.
+     */
+    namespace Wire {
+        constexpr std::uint32_t magic = 0x46585456; // "VTXF"
+        constexpr std::uint16_t version = 2;
+
+        enum class MessageType : std::uint16_t { Hello = 1, Frame = 2, Order = 3 };
+
+        struct MessageHeader {
+            std::uint32_t magic = Wire::magic;
+            std::uint16_t version = Wire::version;
+            MessageType type = MessageType::Hello;
+            std::uint64_t length = 0;
+        };
+
+        struct GridGeometry {
+            double left = 0., bottom = 0., step = 0.;
+            std::uint64_t width = 0, height = 0;
+            // Bornent la longueur d'une image avant de la lire
+            std::uint64_t nbVortices = 0, maxPoints = 0;
+        };
+    } // namespace Wire
+
+    /**
+     * @brief Publishes the frames of a simulation to the viewers connected to
+     * a socket
+     *
+     * Viewers can connect and disconnect at any time ; everything is done
+     * without blocking from poll() and publish(), called by the simulation
+     * loop. A frame is encoded once and shared by the viewers. Each viewer
+     * has at most one frame being sent and one waiting : a newer frame
+     * replaces the waiting one, so a slow viewer gets frames dropped instead
+     * of stalling the simulation. A new viewer always gets the velocity field
+     * with its first frame.
+     */
+    class FrameServer {
+    public:
+        /**
+         * @brief Listen on t_address for viewers of the domain of t_grid
+         *
+         * t_nbVortices and t_maxPoints are sent to the viewers, which reject
+         * the frames with more vortices or particles. Throw std::runtime_error
+         * if the socket cannot be opened.
+         */
+        FrameServer(const SocketAddress & t_address,
+                    const Numeric::CartesianGridOfSpeed & t_grid,
+                    std::size_t t_nbVortices,
+                    std::size_t t_maxPoints);
+        FrameServer(const FrameServer &) = delete;
+        FrameServer & operator=(const FrameServer &) = delete;
+        ~FrameServer();
+
+        /**
+         * @brief Accept the new viewers, read their orders and go on sending
+         * the frames, waiting at most t_timeout ms for one of these
+         *
+         * A viewer which closes its window or its connection is forgotten ;
+         * its CloseWindow order is not returned.
+         *
+         * @return The orders of the viewers, in their order of arrival
+         */
+        std::vector<UiEvent> poll(int t_timeout);
+
+        /**
+         * @brief Whether a viewer has not received any frame yet, so that the
+         * current state has to be published even if the simulation is paused
+         */
+        bool wantsFrame() const;
+        bool hasViewers() const { return !m_viewers.empty(); }
+        std::size_t nbViewers() const { return m_viewers.size(); }
+
+        /**
+         * @brief Encode a frame and queue it for every viewer
+         *
+         * @param t_header Step, time step and simulation time of the frame (the
+         *                 counts are filled from the containers) ; the field is
+         *                 sent if hasField is set or a viewer needs it
+         */
+        void publish(const FrameHeader & t_header,
+                     const Vortices & t_vortices,
+                     const Numeric::CartesianGridOfSpeed & t_grid,
+                     const Geometry::CloudOfPoints & t_cloud);
+
+        std::size_t nbConnections() const { return m_nbConnections; }
+        std::size_t nbSent() const { return m_nbSent; }
+        std::size_t nbDropped() const { return m_nbDropped; }
+
+    private:
+        using Message = std::shared_ptr<const std::vector<char>>;
+
+        struct Viewer {
+            int socket;
+            /// Message being sent and number of its bytes already sent
+            Message sending;
+            std::size_t offset = 0;
+            /// Latest frame waiting for the end of the one being sent
+            Message waiting;
+            bool waitingHasField = false;
+            bool hasField = false;
+            bool hasFrame = false;
+            /// Bytes received and not yet decoded
+            std::vector<char> received;
+        };
+
+        /// Send what the socket accepts, false if the viewer is gone
+        bool flush(Viewer & t_viewer);
+        /// Decode the orders received, false if the viewer is gone
+        bool read(Viewer & t_viewer, std::vector<UiEvent> & t_orders);
+
+        SocketAddress m_address;
+        int m_listener = -1;
+        Wire::GridGeometry m_geometry;
+        std::vector<Viewer> m_viewers;
+        std::size_t m_nbConnections = 0, m_nbSent = 0, m_nbDropped = 0;
+    };
+
+    /**
+     * @brief Connection of a viewer to a FrameServer
+     */
+    class FrameClient {
+    public:
+        /**
+         * @brief Connect to the server and read its Hello message
+         *
+         * Throw std::runtime_error if the server cannot be reached or does not
+         * speak the protocol.
+         */
+        explicit FrameClient(const SocketAddress & t_address);
+        FrameClient(const FrameClient &) = delete;
+        FrameClient & operator=(const FrameClient &) = delete;
+        ~FrameClient();
+
+        const Wire::GridGeometry & geometry() const { return m_geometry; }
+
+        /**
+         * @brief Wait at most t_timeout ms for frames and decode them, the
+         * last one remaining in the containers
+         *
+         * The vortices and the cloud are resized to the frame, the field is
+         * only updated if the frame holds it.
+         *
+         * @return Whether a frame was received
+         */
+        bool receive(int t_timeout,
+                     Vortices & t_vortices,
+                     Numeric::CartesianGridOfSpeed & t_grid,
+                     Geometry::CloudOfPoints & t_cloud);
+
+        /// Header of the last frame received
+        const FrameHeader & header() const { return m_header; }
+
+        void send(UiEvent t_order);
+
+        /// False once the server has closed the connection
+        bool isConnected() const { return m_socket >= 0; }
+
+    private:
+        /// Read exactly t_size bytes, false if the connection is closed
+        bool readAll(void * t_data, std::size_t t_size);
+        void disconnect();
+
+        int m_socket = -1;
+        Wire::GridGeometry m_geometry;
+        FrameHeader m_header;
+        std::vector<char> m_payload;
+    };
+
+    std::ostream & operator<<(std::ostream & os, const SocketAddress & t_address);
+} // namespace Simulation
+
+#endif
@@ -0,0 +1,150 @@
+#include "ftle.hpp"
+
+#include "cloud_of_points.hpp"
+#include "runge_kutta.hpp"
+#include "vector.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <utility>
+
+using namespace Numeric;
+
+namespace {
+    constexpr std::size_t seedsPerTask = 4096;
+} // namespace
+
+FtleField Numeric::computeFtle(double t_duration,
+                               double dt,
+                               Scheme t_scheme,
+                               Simulation::Vortices t_vortices,
+                               bool isMobile,
+                               const CartesianGridOfSpeed & t_grid,
+                               std::size_t t_resolution,
+                               MPI_Comm t_comm) {
+    using displacement = Geometry::Vector<double>;
+    int rank = 0, size = 1;
+    if (t_comm != MPI_COMM_NULL) {
+        MPI_Comm_rank(t_comm, &rank);
+        MPI_Comm_size(t_comm, &size);
+    }
+
+    auto bottomLeft = t_grid.getLeftBottomVertex();
+    auto topRight = t_grid.getRightTopVertex();
+    double width = topRight.x - bottomLeft.x;
+    double height = topRight.y - bottomLeft.y;
+    auto [nbCellsX, nbCellsY] = t_grid.cellGeometry();
+    std::size_t nbSeedsX = t_resolution * nbCellsX, nbSeedsY = t_resolution * nbCellsY;
+    double hx = width / nbSeedsX, hy = height / nbSeedsY;
+
+    // Bande de lignes de ce processus, bordée d'une ligne de chaque côté
+    // pour les différences centrées (avec gestion du tore)
+    std::size_t firstRow = rank * nbSeedsY / size, lastRow = (rank + 1) * nbSeedsY / size;
+    std::size_t nbRows = lastRow - firstRow + 2;
+    std::size_t nbSeeds = nbRows * nbSeedsX;
+    Geometry::CloudOfPoints points(nbSeeds), newPoints(nbSeeds);
+    for (std::size_t iRow = 0; iRow < nbRows; ++iRow) {
+        std::size_t row = (firstRow + iRow + nbSeedsY - 1) % nbSeedsY;
+        Geometry::Rectangle band { { bottomLeft.x, bottomLeft.y + row * hy },
+                                   { topRight.x, bottomLeft.y + (row + 1) * hy } };
+        auto seeds = Geometry::generatePointsIn({ nbSeedsX, 1 }, band);
+        std::copy(seeds.begin(), seeds.end(), points.begin() + iRow * nbSeedsX);
+    }
+
+    // Déplacements cumulés, sans ramener les particules dans le domaine :
+    // c'est l'application de flot déroulée sur le plan
+    std::vector<displacement> displacements(nbSeeds, displacement { 0., 0. });
+    std::size_t nbSteps =
+        std::max<std::size_t>(1, std::size_t(std::llround(std::abs(t_duration / dt))));
+    double step = t_duration / nbSteps;
+    CartesianGridOfSpeed grid = t_grid;
+    for (std::size_t iStep = 0; iStep < nbSteps; ++iStep) {
+#pragma omp parallel for schedule(static)
+        for (std::size_t first = 0; first < nbSeeds; first += seedsPerTask) {
+            std::size_t last = std::min(first + seedsPerTask, nbSeeds);
+            solve_particles(t_scheme, step, grid, points, newPoints, first, last);
+            for (std::size_t iSeed = first; iSeed < last; ++iSeed) {
+                auto shift = grid.wrappedDisplacement(points[iSeed], newPoints[iSeed]);
+                displacements[iSeed].x += shift.x;
+                displacements[iSeed].y += shift.y;
+            }
+        }
+        std::swap(points, newPoints);
+        if (isMobile) {
+            solve_vortices(t_scheme, step, grid, t_vortices);
+            grid.updateVelocityField(t_vortices);
+        }
+    }
+
+    // Gradient de l'application de flot x0 + D(x0) : F = I + grad D
+    std::size_t nbLocalRows = nbRows - 2;
+    std::vector<double> localValues(nbLocalRows * nbSeedsX);
+    double invDuration = 1. / std::abs(t_duration);
+#pragma omp parallel for schedule(static)
+    for (std::size_t iRow = 0; iRow < nbLocalRows; ++iRow) {
+        const displacement * below = displacements.data() + iRow * nbSeedsX;
+        const displacement * row = below + nbSeedsX;
+        const displacement * above = row + nbSeedsX;
+        for (std::size_t jCol = 0; jCol < nbSeedsX; ++jCol) {
+            const displacement & right = row[(jCol + 1) % nbSeedsX];
+            const displacement & left = row[(jCol + nbSeedsX - 1) % nbSeedsX];
+            double f11 = 1. + (right.x - left.x) / (2. * hx);
+            double f21 = (right.y - left.y) / (2. * hx);
+            double f12 = (above[jCol].x - below[jCol].x) / (2. * hy);
+            double f22 = 1. + (above[jCol].y - below[jCol].y) / (2. * hy);
+            // Plus grande valeur propre du tenseur de Cauchy-Green F^T F
+            double a = f11 * f11 + f21 * f21;
+            double b = f11 * f12 + f21 * f22;
+            double c = f12 * f12 + f22 * f22;
+            double halfDiff = 0.5 * (a - c);
+            double lambdaMax = 0.5 * (a + c) + std::sqrt(halfDiff * halfDiff + b * b);
+            localValues[iRow * nbSeedsX + jCol] = 0.5 * std::log(lambdaMax) * invDuration;
+        }
+    }
+
+    FtleField field;
+    field.width = nbSeedsX;
+    field.height = nbSeedsY;
+    field.origin = { bottomLeft.x + 0.5 * hx, bottomLeft.y + 0.5 * hy };
+    field.hx = hx;
+    field.hy = hy;
+    field.duration = t_duration;
+    if (size == 1) {
+        field.values = std::move(localValues);
+        return field;
+    }
+
+    std::vector<int> counts(size), displacementsInField(size);
+    for (int iRank = 0; iRank < size; ++iRank) {
+        std::size_t nbBandRows = (iRank + 1) * nbSeedsY / size - iRank * nbSeedsY / size;
+        counts[iRank] = int(nbBandRows * nbSeedsX);
+        displacementsInField[iRank] = int(iRank * nbSeedsY / size * nbSeedsX);
+    }
+    if (rank == 0)
+        field.values.resize(nbSeedsX * nbSeedsY);
+    MPI_Gatherv(localValues.data(), counts[rank], MPI_DOUBLE, field.values.data(), counts.data(),
+                displacementsInField.data(), MPI_DOUBLE, 0, t_comm);
+    if (rank != 0)
+        field = FtleField();
+    return field;
+}
+
+std::ostream & Numeric::operator<<(std::ostream & os, const FtleField & t_field) {
+    auto flags = os.flags();
+    auto precision = os.precision();
+    os << "# FTLE : first seed x y, number of seeds nx ny, steps hx hy, integration time"
+       << std::endl;
+    os << std::setprecision(17) << t_field.origin.x << " " << t_field.origin.y << " "
+       << t_field.width << " " << t_field.height << " " << t_field.hx << " " << t_field.hy << " "
+       << t_field.duration << std::endl;
+    os << std::setprecision(9);
+    for (std::size_t iRow = 0; iRow < t_field.height; ++iRow) {
+        for (std::size_t jCol = 0; jCol < t_field.width; ++jCol)
+            os << (jCol > 0 ? " " : "") << t_field(iRow, jCol);
+        os << '\n';
+    }
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
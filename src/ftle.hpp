@@ -0,0 +1,78 @@
+#ifndef _NUMERIC_FTLE_HPP_
+#define _NUMERIC_FTLE_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "point.hpp"
+#include "scheme.hpp"
+#include "vortex.hpp"
+
+#include <cstddef>
+#include <mpi.h>
+#include <ostream>
+#include <vector>
+
+namespace Numeric {
+    /**
+     * @brief Finite-time Lyapunov exponents on a regular lattice of seeds
+     *
+     * The seeds are the centers of the cells of a lattice refining the grid
+     * of the velocity field. The value of a seed is the FTLE of the flow map
+     * over the integration time, ln(sqrt(lambda_max(C))) / |T|, where C is
+     * the Cauchy-Green tensor of the flow map. Ridges of the forward
+     * (backward) field are the repelling (attracting) Lagrangian coherent
+     * structures.
+     */
+    struct FtleField {
+        /// Number of seeds per direction
+        std::size_t width = 0, height = 0;
+        /// Center of the first (bottom left) seed
+        Geometry::Point<double> origin;
+        /// Distance between two seeds in each direction
+        double hx = 0., hy = 0.;
+        /// Integration time (negative for the backward FTLE)
+        double duration = 0.;
+        /// Values row by row, from the bottom
+        std::vector<double> values;
+
+        double operator()(std::size_t iRow, std::size_t jCol) const {
+            return values[iRow * width + jCol];
+        }
+    };
+
+    /**
+     * @brief Compute the FTLE field of the flow starting from the current
+     * state over t_duration
+     *
+     * The seeds (t_resolution x t_resolution per cell of t_grid) are
+     * advected with the given scheme by steps of about dt, the vortices
+     * moving with them if isMobile. The displacement of each seed is
+     * accumulated across the periodic boundaries, so the flow map is
+     * unwrapped from the torus ; its gradient is computed by centered
+     * differences between neighbouring seeds (across the boundaries too).
+     *
+     * The rows of seeds are split between the processes of t_comm (each one
+     * also advecting one row on each side of its band), the seeds of a
+     * process between its threads. The whole field is gathered on the
+     * process 0 of t_comm, the other ones getting an empty field.
+     *
+     * @param t_comm Communicator of the processes sharing the work, or
+     * MPI_COMM_NULL to compute everything in this process (without MPI)
+     */
+    FtleField computeFtle(double t_duration,
+                          double dt,
+                          Scheme t_scheme,
+                          Simulation::Vortices t_vortices,
+                          bool isMobile,
+                          const CartesianGridOfSpeed & t_grid,
+                          std::size_t t_resolution,
+                          MPI_Comm t_comm = MPI_COMM_NULL);
+
+    /**
+     * @brief Write the field as text : a comment line, then the center of
+     * the first seed, the numbers of seeds, the distances between seeds and
+     * the integration time on one line, then one line of values per row of
+     * seeds, from the bottom
+     */
+    std::ostream & operator<<(std::ostream & os, const FtleField & t_field);
+} // namespace Numeric
+
+#endif
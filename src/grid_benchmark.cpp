@@ -0,0 +1,131 @@
+#include "grid_benchmark.hpp"
+
+#include "runge_kutta.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <omp.h>
+#include <random>
+#include <vector>
+
+namespace {
+    // Pas de temps initial des modes interactifs
+    constexpr double dt = 0.1;
+    constexpr std::size_t particlesPerTask = 4096;
+    constexpr int nbTrials = 3;
+
+    /**
+     * @brief Best time (in seconds) of one advection step over nbTrials
+     *
+     * t_prepare() is called before each trial, outside of the timing.
+     */
+    template <typename Prepare>
+    double timeAdvection(Numeric::Scheme t_scheme,
+                         const Numeric::CartesianGridOfSpeed & t_grid,
+                         const Geometry::CloudOfPoints & t_points,
+                         Geometry::CloudOfPoints & t_newPoints,
+                         const Prepare & t_prepare) {
+        std::size_t nbPoints = t_points.numberOfPoints();
+        double best = 0.;
+        for (int iTrial = 0; iTrial < nbTrials; ++iTrial) {
+            t_prepare();
+            double t0 = omp_get_wtime();
+#pragma omp parallel for schedule(static)
+            for (std::size_t first = 0; first < nbPoints; first += particlesPerTask) {
+                Numeric::solve_particles(t_scheme, dt, t_grid, t_points, t_newPoints, first,
+                                         std::min(first + particlesPerTask, nbPoints));
+            }
+            double seconds = omp_get_wtime() - t0;
+            best = iTrial == 0 ? seconds : std::min(best, seconds);
+        }
+        return best;
+    }
+
+    bool samePositions(const Geometry::CloudOfPoints & t_first,
+                       const Geometry::CloudOfPoints & t_second) {
+        for (std::size_t iPoint = 0; iPoint < t_first.numberOfPoints(); ++iPoint) {
+            if (t_first[iPoint].x != t_second[iPoint].x || t_first[iPoint].y != t_second[iPoint].y)
+                return false;
+        }
+        return true;
+    }
+} // namespace
+
+int runGridBenchmark(std::size_t t_nbPoints,
+                     Numeric::Scheme t_scheme,
+                     const Simulation::Vortices & t_vortices,
+                     const Numeric::CartesianGridOfSpeed & t_grid) {
+    auto origin = t_grid.getLeftBottomVertex();
+    double width = t_grid.getRightTopVertex().x - origin.x;
+    double height = t_grid.getRightTopVertex().y - origin.y;
+    bool isConsistent = true;
+
+    std::cout << "Grid benchmark : " << t_nbPoints << " particles, one step of dt = " << dt
+              << " (" << Numeric::schemeName(t_scheme) << "), best of " << nbTrials
+              << " trials, " << omp_get_max_threads() << " threads" << std::endl;
+    auto flags = std::cout.flags();
+    std::cout << std::fixed << std::setprecision(2);
+
+    for (std::size_t nbCells : { std::size_t(2048), std::size_t(4096) }) {
+        // Même domaine, discrétisé plus finement selon la plus grande dimension
+        double h = std::max(width, height) / nbCells;
+        std::pair<std::size_t, std::size_t> dimensions { std::size_t(width / h),
+                                                         std::size_t(height / h) };
+        Numeric::CartesianGridOfSpeed grid(dimensions, origin, h);
+        grid.updateVelocityField(t_vortices);
+
+        // Particules tirées au hasard, puis rangées dans l'ordre des cellules
+        std::mt19937_64 generator(2023);
+        std::uniform_real_distribution<double> uniform(0., 1.);
+        std::vector<Geometry::CloudOfPoints::point> positions(t_nbPoints);
+        for (auto & p : positions)
+            p = { Numeric::real(origin.x + uniform(generator) * width),
+                  Numeric::real(origin.y + uniform(generator) * height) };
+        auto cellIndex = [&](const Geometry::CloudOfPoints::point & p) {
+            auto iRow = std::size_t((p.y - origin.y) / h);
+            auto jCol = std::size_t((p.x - origin.x) / h);
+            return iRow * dimensions.first + jCol;
+        };
+        std::ranges::sort(positions, {}, cellIndex);
+
+        std::cout << "grid " << dimensions.first << " x " << dimensions.second << std::endl;
+        for (bool isSorted : { true, false }) {
+            if (!isSorted)
+                std::shuffle(positions.begin(), positions.end(), generator);
+            Geometry::CloudOfPoints points(t_nbPoints);
+            for (std::size_t iPoint = 0; iPoint < t_nbPoints; ++iPoint)
+                points[iPoint] = positions[iPoint];
+            Geometry::CloudOfPoints rowMajorPoints(t_nbPoints), tiledPoints(t_nbPoints);
+
+            grid.setTiledLayout(false);
+            double rowMajor = timeAdvection(t_scheme, grid, points, rowMajorPoints, [] {});
+            grid.setTiledLayout(true);
+            // Premier essai hors chronométrage : les blocs sont déjà rangés
+            timeAdvection(t_scheme, grid, points, tiledPoints, [] {});
+            double packed = timeAdvection(t_scheme, grid, points, tiledPoints, [] {});
+            // Blocs à ranger pendant le pas, comme après chaque mise à jour
+            // du champ pour des tourbillons mobiles
+            double packing = timeAdvection(t_scheme, grid, points, tiledPoints,
+                                           [&] { grid.setTiledLayout(true); });
+            grid.setTiledLayout(false);
+            isConsistent = isConsistent && samePositions(rowMajorPoints, tiledPoints);
+
+            std::cout << "  " << (isSorted ? "cell order  " : "random order") << " : row-major "
+                      << 1.E3 * rowMajor << " ms, tiled " << 1.E3 * packed
+                      << " ms (speedup " << rowMajor / packed << "), tiled with packing "
+                      << 1.E3 * packing << " ms (speedup " << rowMajor / packing << ")"
+                      << std::endl;
+        }
+    }
+    std::cout.flags(flags);
+
+    if (!isConsistent) {
+        std::cout << "The row-major and the tiled layouts give different positions!" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Both layouts give the same positions" << std::endl;
+    return EXIT_SUCCESS;
+}
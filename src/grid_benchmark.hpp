@@ -0,0 +1,28 @@
+#ifndef _GRID_BENCHMARK_HPP_
+#define _GRID_BENCHMARK_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "scheme.hpp"
+#include "vortex.hpp"
+
+#include <cstddef>
+
+/**
+ * @brief Compare the row-major and the tiled layouts of the velocity field on
+ * fine grids
+ *
+ * The domain of t_grid is discretized with 2048 x 2048 and 4096 x 4096 cells,
+ * then t_nbPoints particles are advected once in each layout, first in the
+ * order of the cells of the grid, then in a random order. The tiled layout is
+ * timed with blocks already packed (fixed vortices) and packed during the step
+ * (mobile vortices). Both layouts must give exactly the same positions.
+ *
+ * Runs in a single process, without display nor MPI.
+ *
+ * @return The exit code of the program
+ */
+int runGridBenchmark(std::size_t t_nbPoints,
+                     Numeric::Scheme t_scheme,
+                     const Simulation::Vortices & t_vortices,
+                     const Numeric::CartesianGridOfSpeed & t_grid);
+
+#endif
@@ -0,0 +1,88 @@
+#include "interactive.hpp"
+
+#include "tracer.hpp"
+
+#include <SFML/Window/Keyboard.hpp>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+void SimulationControl::apply(UiEvent t_event) {
+    if (t_event == UiEvent::Advance) {
+        advance = true;
+    } else if (t_event == UiEvent::AnimationStart) {
+        animate = true;
+    } else if (t_event == UiEvent::AnimationStop) {
+        animate = false;
+    } else if (t_event == UiEvent::TimestepIncrement) {
+        dt *= 2;
+    } else if (t_event == UiEvent::TimestepDecrement) {
+        dt /= 2;
+    } else if (t_event == UiEvent::CloseWindow) {
+        closing = true;
+    }
+}
+
+UiEvent translateEvent(Graphisme::Screen & t_screen, const sf::Event & t_event) {
+    if (t_event.type == sf::Event::Closed) {
+        return UiEvent::CloseWindow;
+    } else if (t_event.type == sf::Event::Resized) {
+        // on met à jour la vue, avec la nouvelle taille de la fenêtre
+        t_screen.resize(t_event);
+    } else if (sf::Keyboard::isKeyPressed(sf::Keyboard::P)) {
+        return UiEvent::AnimationStart;
+    } else if (sf::Keyboard::isKeyPressed(sf::Keyboard::S)) {
+        return UiEvent::AnimationStop;
+    } else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up)) {
+        return UiEvent::TimestepIncrement;
+    } else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down)) {
+        return UiEvent::TimestepDecrement;
+    } else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) {
+        return UiEvent::Advance;
+    }
+    return UiEvent::Noop;
+}
+
+void printKeyboardHelp() {
+    std::cout << "######## Vortex simulator ########" << std::endl << std::endl;
+    std::cout << "Press P for play animation " << std::endl;
+    std::cout << "Press S to stop animation" << std::endl;
+    std::cout << "Press right cursor to advance step by step in time" << std::endl;
+    std::cout << "Press down cursor to halve the time step" << std::endl;
+    std::cout << "Press up cursor to double the time step" << std::endl;
+}
+
+void drawFrame(Graphisme::Screen & t_screen,
+               const Numeric::CartesianGridOfSpeed & t_grid,
+               const Simulation::Vortices & t_vortices,
+               const Geometry::CloudOfPoints & t_cloud,
+               double dt,
+               std::chrono::system_clock::time_point t_frameStart,
+               const Numeric::FtleField * t_ftle) {
+    Trace::Scope scope("draw frame", "render");
+    t_screen.clear(sf::Color::Black);
+    std::string strDt = std::string("Time step : ") + std::to_string(dt);
+    t_screen.drawText(strDt,
+                      Geometry::Point<double> { 50, double(t_screen.getGeometry().second - 96) });
+
+    if (t_ftle)
+        t_screen.displayFtle(*t_ftle, t_grid, t_vortices);
+    else
+        t_screen.displayVelocityField(t_grid, t_vortices);
+    t_screen.displayParticles(t_grid, t_vortices, t_cloud);
+
+    auto end = std::chrono::system_clock::now();
+    std::chrono::duration<double> diff = end - t_frameStart;
+    std::string str_fps = std::string("FPS : ") + std::to_string(1. / diff.count());
+    t_screen.drawText(str_fps,
+                      Geometry::Point<double> { 300, double(t_screen.getGeometry().second - 96) });
+    if (const auto * timing = t_screen.trailsTiming()) {
+        std::ostringstream strTrails;
+        strTrails << "Trails : " << *timing;
+        double y = t_screen.getGeometry().second - 96;
+        t_screen.drawText(strTrails.str(), Geometry::Point<double> { 550, y });
+    }
+    // Attente éventuelle de la synchronisation verticale
+    Trace::Scope display("display", "render");
+    t_screen.display();
+}
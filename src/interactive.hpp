@@ -0,0 +1,62 @@
+#ifndef _INTERACTIVE_HPP_
+#define _INTERACTIVE_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "cloud_of_points.hpp"
+#include "ftle.hpp"
+#include "screen.hpp"
+#include "ui_events.hpp"
+#include "vortex.hpp"
+
+#include <chrono>
+
+/**
+ * @brief State of the simulation driven by the user interface
+ */
+struct SimulationControl {
+    bool animate = false;
+    bool advance = false;
+    bool closing = false;
+    double dt = 0.1;
+
+    /**
+     * @brief Update the state according to an event of the user interface
+     */
+    void apply(UiEvent t_event);
+
+    /**
+     * @brief Whether a time step has to be computed
+     */
+    bool mustStep() const { return animate || advance; }
+};
+
+/**
+ * @brief Translate an event of the window into an order for the simulation
+ *
+ * Resize events are handled directly by the screen. Return UiEvent::Noop if
+ * the event is not an order for the simulation.
+ */
+UiEvent translateEvent(Graphisme::Screen & t_screen, const sf::Event & t_event);
+
+/**
+ * @brief Print the help on the keyboard commands
+ */
+void printKeyboardHelp();
+
+/**
+ * @brief Draw a whole frame (velocity field, particles and status text) and
+ * display it
+ *
+ * @param t_frameStart Start of the current iteration of the event loop, used to
+ * compute the FPS
+ * @param t_ftle If not null, FTLE field displayed in place of the velocity
+ * field
+ */
+void drawFrame(Graphisme::Screen & t_screen,
+               const Numeric::CartesianGridOfSpeed & t_grid,
+               const Simulation::Vortices & t_vortices,
+               const Geometry::CloudOfPoints & t_cloud,
+               double dt,
+               std::chrono::system_clock::time_point t_frameStart,
+               const Numeric::FtleField * t_ftle = nullptr);
+
+#endif
@@ -0,0 +1,98 @@
+#include "memory_benchmark.hpp"
+
+#include "cloud_of_points.hpp"
+#include "storage_allocator.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <omp.h>
+
+namespace {
+    constexpr int nbTrials = 10;
+
+    const char * procBindName(omp_proc_bind_t t_bind) {
+        switch (t_bind) {
+        case omp_proc_bind_false:
+            return "false";
+        case omp_proc_bind_true:
+            return "true";
+        case omp_proc_bind_master:
+            return "master";
+        case omp_proc_bind_close:
+            return "close";
+        case omp_proc_bind_spread:
+            return "spread";
+        }
+        return "?";
+    }
+
+    /**
+     * @brief Bandwidth (in GB/s) of the best of nbTrials streaming passes
+     * over clouds allocated with the placement t_placement
+     *
+     * @param isParallelInit If false, the points are written by the master
+     * thread only, as when the whole cloud is read from a file
+     */
+    double bandwidth(std::size_t t_nbPoints, Memory::Placement t_placement, bool isParallelInit) {
+        Memory::Placement saved = Memory::placement();
+        Memory::placement() = t_placement;
+        Geometry::CloudOfPoints points(t_nbPoints), newPoints(t_nbPoints);
+        Memory::placement() = saved;
+
+        if (isParallelInit) {
+#pragma omp parallel for schedule(static)
+            for (std::size_t iPoint = 0; iPoint < t_nbPoints; ++iPoint) {
+                points[iPoint] = { Numeric::real(iPoint), Numeric::real(1) };
+                newPoints[iPoint] = { Numeric::real(0), Numeric::real(0) };
+            }
+        } else {
+            for (std::size_t iPoint = 0; iPoint < t_nbPoints; ++iPoint) {
+                points[iPoint] = { Numeric::real(iPoint), Numeric::real(1) };
+                newPoints[iPoint] = { Numeric::real(0), Numeric::real(0) };
+            }
+        }
+
+        double best = 0.;
+        for (int iTrial = 0; iTrial < nbTrials; ++iTrial) {
+            double t0 = omp_get_wtime();
+#pragma omp parallel for schedule(static)
+            for (std::size_t iPoint = 0; iPoint < t_nbPoints; ++iPoint) {
+                newPoints[iPoint].x = points[iPoint].x + Numeric::real(0.5) * points[iPoint].y;
+                newPoints[iPoint].y = points[iPoint].y;
+            }
+            double seconds = omp_get_wtime() - t0;
+            best = iTrial == 0 ? seconds : std::min(best, seconds);
+        }
+        // Une lecture et une écriture par particule
+        return 2. * t_nbPoints * sizeof(Geometry::CloudOfPoints::point) / best * 1.E-9;
+    }
+} // namespace
+
+int runMemoryBenchmark(std::size_t t_nbPoints) {
+    omp_proc_bind_t bind = omp_get_proc_bind();
+    std::cout << "Memory benchmark : " << t_nbPoints << " particles ("
+              << 2. * t_nbPoints * sizeof(Geometry::CloudOfPoints::point) * 1.E-6
+              << " MB read and written per pass), best of " << nbTrials << " passes, "
+              << omp_get_max_threads() << " threads, OMP_PROC_BIND " << procBindName(bind)
+              << ", " << omp_get_num_places() << " places" << std::endl;
+    if (bind == omp_proc_bind_false) {
+        std::cout << "Threads are not bound : the placement of the pages may not match the "
+                     "threads (set OMP_PROC_BIND=spread and OMP_PLACES=cores)"
+                  << std::endl;
+    }
+
+    auto flags = std::cout.flags();
+    std::cout << std::fixed << std::setprecision(2);
+    double serial = bandwidth(t_nbPoints, { .firstTouch = false, .hugePages = false }, false);
+    double firstTouch = bandwidth(t_nbPoints, { .firstTouch = true, .hugePages = false }, true);
+    double hugePages = bandwidth(t_nbPoints, { .firstTouch = true, .hugePages = true }, true);
+    std::cout << "  initialized by the master thread  : " << serial << " GB/s" << std::endl
+              << "  parallel first touch              : " << firstTouch << " GB/s (x"
+              << firstTouch / serial << ")" << std::endl
+              << "  parallel first touch, huge pages  : " << hugePages << " GB/s (x"
+              << hugePages / serial << ")" << std::endl;
+    std::cout.flags(flags);
+    return EXIT_SUCCESS;
+}
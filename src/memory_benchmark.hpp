@@ -0,0 +1,22 @@
+#ifndef _MEMORY_BENCHMARK_HPP_
+#define _MEMORY_BENCHMARK_HPP_
+#include <cstddef>
+
+/**
+ * @brief Measure the memory bandwidth of the particles depending on the
+ * placement of their pages
+ *
+ * Two clouds of t_nbPoints particles are allocated and initialized either by
+ * the master thread alone (all the pages on its NUMA node) or by a parallel
+ * first touch (see Memory::Placement), with and without huge pages. For each
+ * placement, a streaming loop with the static schedule of the compute loops
+ * moves the particles from one cloud to the other, and its bandwidth is
+ * printed along with the binding of the threads.
+ *
+ * Runs in a single process, without display nor MPI.
+ *
+ * @return The exit code of the program
+ */
+int runMemoryBenchmark(std::size_t t_nbPoints);
+
+#endif
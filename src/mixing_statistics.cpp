@@ -0,0 +1,187 @@
+#include "mixing_statistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <omp.h>
+#include <iostream>
+#include <tuple>
+
+using namespace Simulation;
+
+MixingStatistics::MixingStatistics(const Geometry::CloudOfPoints & t_initial,
+                                   const Numeric::CartesianGridOfSpeed & t_grid,
+                                   std::size_t t_period)
+    : m_period(t_period), m_grid(&t_grid), m_tracks(t_initial.numberOfPoints()) {
+    auto bottomLeft = t_grid.getLeftBottomVertex();
+    auto topRight = t_grid.getRightTopVertex();
+    m_left = bottomLeft.x;
+    m_bottom = bottomLeft.y;
+    m_width = topRight.x - bottomLeft.x;
+    m_height = topRight.y - bottomLeft.y;
+    m_cellStep = t_grid.getStep();
+    std::tie(m_nbCellsX, m_nbCellsY) = t_grid.cellGeometry();
+
+    double xMin = 0., xMax = 0.;
+    for (std::size_t iPoint = 0; iPoint < t_initial.numberOfPoints(); ++iPoint) {
+        m_tracks[iPoint] = Track { t_initial[iPoint], 0, 0 };
+        double x = t_initial[iPoint].x;
+        xMin = iPoint == 0 ? x : std::min(xMin, x);
+        xMax = iPoint == 0 ? x : std::max(xMax, x);
+    }
+    // Les particules sont colorées selon la moitié du nuage initial
+    m_colorBoundary = 0.5 * (xMin + xMax);
+    for (auto & histogram : m_histograms)
+        histogram.assign(m_nbCellsX * m_nbCellsY, 0);
+}
+
+void MixingStatistics::beginStep(double dt, std::size_t t_nbTasks) {
+    ++m_step;
+    m_time += dt;
+    m_isSampling = m_period > 0 && m_step % m_period == 0;
+    if (!m_isSampling)
+        return;
+    m_squareDisplacements.assign(t_nbTasks, 0.);
+    m_threadHistograms.resize(omp_get_max_threads());
+    for (auto & histogram : m_threadHistograms)
+        histogram.assign(2 * m_nbCellsX * m_nbCellsY, 0);
+}
+
+void MixingStatistics::track(const Geometry::CloudOfPoints & t_points,
+                             const Geometry::CloudOfPoints & t_newPoints,
+                             std::size_t t_first,
+                             std::size_t t_last,
+                             std::size_t t_task) {
+    // L'écart entre le saut brut et le déplacement le plus court sur le tore
+    // compte les passages par ses bords
+    auto countCrossings = [&](std::size_t iPoint) -> Track & {
+        Track & track = m_tracks[iPoint];
+        const point & p = t_points[iPoint];
+        const point & q = t_newPoints[iPoint];
+        auto shift = m_grid->wrappedDisplacement(p, q);
+        double dx = double(q.x) - double(p.x), dy = double(q.y) - double(p.y);
+        track.nbCrossingsX += std::int16_t(std::lround((shift.x - dx) / m_width));
+        track.nbCrossingsY += std::int16_t(std::lround((shift.y - dy) / m_height));
+        return track;
+    };
+    if (!m_isSampling) {
+        for (std::size_t iPoint = t_first; iPoint < t_last; ++iPoint)
+            countCrossings(iPoint);
+        return;
+    }
+
+    // Pas échantillonné : les statistiques sont accumulées dans la même
+    // boucle, pendant que les nouvelles positions sont encore en cache
+    std::uint32_t * histogram = m_threadHistograms[omp_get_thread_num()].data();
+    double squareDisplacement = 0.;
+    for (std::size_t iPoint = t_first; iPoint < t_last; ++iPoint) {
+        const Track & track = countCrossings(iPoint);
+        double x = t_newPoints[iPoint].x, y = t_newPoints[iPoint].y;
+        double dx = x + track.nbCrossingsX * m_width - double(track.origin.x);
+        double dy = y + track.nbCrossingsY * m_height - double(track.origin.y);
+        squareDisplacement += dx * dx + dy * dy;
+
+        std::size_t jCell =
+            std::min(m_nbCellsX - 1, std::size_t(std::max(0., (x - m_left) / m_cellStep)));
+        std::size_t iCell =
+            std::min(m_nbCellsY - 1, std::size_t(std::max(0., (y - m_bottom) / m_cellStep)));
+        int color = track.origin.x < m_colorBoundary ? 0 : 1;
+        ++histogram[2 * (iCell * m_nbCellsX + jCell) + color];
+    }
+    m_squareDisplacements[t_task] = squareDisplacement;
+}
+
+void MixingStatistics::endStep() {
+    if (!m_isSampling)
+        return;
+    std::size_t nbParticles = m_tracks.size();
+    std::size_t nbCells = m_nbCellsX * m_nbCellsY;
+
+    // Somme dans l'ordre des tâches : le résultat ne dépend pas des threads
+    double squareDisplacement = 0.;
+    for (double partial : m_squareDisplacements)
+        squareDisplacement += partial;
+
+    double occupancy = 0., mixing = 0.;
+    std::size_t nbOccupied = 0;
+    for (std::size_t iCell = 0; iCell < nbCells; ++iCell) {
+        std::uint32_t counts[2] = { 0, 0 };
+        for (const auto & histogram : m_threadHistograms) {
+            counts[0] += histogram[2 * iCell];
+            counts[1] += histogram[2 * iCell + 1];
+        }
+        m_histograms[0][iCell] = counts[0];
+        m_histograms[1][iCell] = counts[1];
+        std::uint32_t count = counts[0] + counts[1];
+        if (count == 0)
+            continue;
+        ++nbOccupied;
+        double share = double(count) / nbParticles;
+        occupancy -= share * std::log(share);
+        for (std::uint32_t colorCount : counts) {
+            if (colorCount == 0)
+                continue;
+            double fraction = double(colorCount) / count;
+            mixing -= share * fraction * std::log2(fraction);
+        }
+    }
+
+    m_sample.step = m_step;
+    m_sample.time = m_time;
+    m_sample.nbParticles = nbParticles;
+    m_sample.meanSquareDisplacement = nbParticles > 0 ? squareDisplacement / nbParticles : 0.;
+    m_sample.occupancyEntropy = nbCells > 1 ? occupancy / std::log(double(nbCells)) : 0.;
+    m_sample.mixingEntropy = mixing;
+    m_sample.nbOccupiedCells = nbOccupied;
+}
+
+const char * MixingStatistics::csvHeader() {
+    return "step,time,particles,msd,occupancy_entropy,mixing_entropy,occupied_cells";
+}
+
+void MixingStatistics::writeHistogram(std::ostream & t_output) const {
+    std::uint64_t header[] = { m_sample.step, m_nbCellsX, m_nbCellsY };
+    t_output.write(reinterpret_cast<const char *>(&header[0]), sizeof(std::uint64_t));
+    t_output.write(reinterpret_cast<const char *>(&m_sample.time), sizeof(double));
+    t_output.write(reinterpret_cast<const char *>(&header[1]), 2 * sizeof(std::uint64_t));
+    for (const auto & histogram : m_histograms)
+        t_output.write(reinterpret_cast<const char *>(histogram.data()),
+                       histogram.size() * sizeof(std::uint32_t));
+}
+
+std::ostream & Simulation::operator<<(std::ostream & os,
+                                      const MixingStatistics::Sample & t_sample) {
+    auto precision = os.precision();
+    os << std::setprecision(10) << t_sample.step << ',' << t_sample.time << ','
+       << t_sample.nbParticles << ',' << t_sample.meanSquareDisplacement << ','
+       << t_sample.occupancyEntropy << ',' << t_sample.mixingEntropy << ','
+       << t_sample.nbOccupiedCells;
+    os.precision(precision);
+    return os;
+}
+
+MixingLog::MixingLog(const std::string & t_csvFile, const std::string & t_histogramFile)
+    : m_csv(t_csvFile) {
+    if (!m_csv)
+        std::cerr << "Cannot open " << t_csvFile << ", the mixing statistics are lost" << std::endl;
+    m_csv << MixingStatistics::csvHeader() << std::endl;
+    if (!t_histogramFile.empty()) {
+        m_histogram.open(t_histogramFile, std::ios::binary);
+        if (!m_histogram)
+            std::cerr << "Cannot open " << t_histogramFile << ", the histograms are lost"
+                      << std::endl;
+    }
+}
+
+void MixingLog::write(const MixingStatistics & t_statistics) {
+    if (!t_statistics.isSampled())
+        return;
+    // Chaque échantillon est vidé aussitôt : le journal peut être suivi
+    // pendant la simulation
+    m_csv << t_statistics.sample() << std::endl;
+    if (m_histogram.is_open()) {
+        t_statistics.writeHistogram(m_histogram);
+        m_histogram.flush();
+    }
+}
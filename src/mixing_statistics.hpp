@@ -0,0 +1,172 @@
+#ifndef _SIMULATION_MIXING_STATISTICS_HPP_
+#define _SIMULATION_MIXING_STATISTICS_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "cloud_of_points.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Simulation {
+    /**
+     * @brief Unwrapped displacements of the particles and mixing statistics,
+     * computed while the particles are advanced
+     *
+     * Each particle keeps its initial position and two small counters of the
+     * crossings of the borders of the periodic domain, updated at every step
+     * from its old and new positions : its unwrapped position is its position
+     * plus the counters times the dimensions of the domain.
+     *
+     * Every period steps, the same pass also accumulates, per thread, the
+     * mean square displacement and the occupancy of the cells of the grid by
+     * the particles of both colors (a particle is colored by the half of the
+     * initial cloud, left or right, it starts in). The step then gives :
+     * - the mean square displacement ;
+     * - the occupancy entropy : Shannon entropy of the distribution of the
+     *   particles over the cells, divided by its maximum (1 : uniform) ;
+     * - the mixing entropy : mean over the particles of the entropy of the
+     *   colors in their cell, in bits (0 : segregated, 1 : fully mixed).
+     *
+     * The particles are identified by their index, so their number and their
+     * order must not change (no particle sources).
+     */
+    class MixingStatistics {
+    public:
+        using point = Geometry::CloudOfPoints::point;
+
+        /// Statistics of one sampled step
+        struct Sample {
+            std::size_t step = 0;
+            double time = 0.;
+            std::size_t nbParticles = 0;
+            double meanSquareDisplacement = 0.;
+            double occupancyEntropy = 0.;
+            double mixingEntropy = 0.;
+            std::size_t nbOccupiedCells = 0;
+        };
+
+        /**
+         * @param t_initial Initial positions of the particles
+         * @param t_grid    Gives the periodic domain and the cells of the
+         *                  occupancy histogram (kept : it must outlive the
+         *                  statistics)
+         * @param t_period  Number of steps between two samples
+         */
+        MixingStatistics(const Geometry::CloudOfPoints & t_initial,
+                         const Numeric::CartesianGridOfSpeed & t_grid,
+                         std::size_t t_period);
+
+        /**
+         * @brief Start a step of dt advancing the particles by t_nbTasks
+         * calls to track()
+         *
+         * Must be called out of any parallel region.
+         */
+        void beginStep(double dt, std::size_t t_nbTasks);
+
+        /**
+         * @brief Update the counters of the particles [t_first, t_last) moved
+         * from t_points to t_newPoints, and accumulate their statistics on a
+         * sampled step
+         *
+         * May be called concurrently on disjoint ranges, each one by a single
+         * thread of the team of the step (the partial sums are per task, the
+         * histograms per thread).
+         */
+        void track(const Geometry::CloudOfPoints & t_points,
+                   const Geometry::CloudOfPoints & t_newPoints,
+                   std::size_t t_first,
+                   std::size_t t_last,
+                   std::size_t t_task);
+
+        /**
+         * @brief Reduce the statistics of a sampled step once every task is
+         * done
+         */
+        void endStep();
+
+        /// Whether the last step was sampled (sample() is up to date)
+        bool isSampled() const { return m_isSampling; }
+        const Sample & sample() const { return m_sample; }
+
+        /**
+         * @brief Number of particles of color t_color (0 : left, 1 : right)
+         * in each cell of the last sample, row by row from the bottom
+         */
+        const std::vector<std::uint32_t> & histogram(int t_color) const {
+            return m_histograms[t_color];
+        }
+        std::pair<std::size_t, std::size_t> cellGeometry() const {
+            return { m_nbCellsX, m_nbCellsY };
+        }
+
+        /// Header of the CSV log written by operator<<(std::ostream &, const Sample &)
+        static const char * csvHeader();
+
+        /**
+         * @brief Append the histograms of the last sample to a binary stream
+         *
+         * Record : step (uint64), time (double), number of cells in x and in
+         * y (uint64), then the counts of the left particles and the ones of
+         * the right particles (uint32, row by row from the bottom).
+         */
+        void writeHistogram(std::ostream & t_output) const;
+
+    private:
+        /// Position of a particle once its crossings of the borders are undone
+        struct Track {
+            point origin;
+            std::int16_t nbCrossingsX, nbCrossingsY;
+        };
+
+        std::size_t m_period;
+        const Numeric::CartesianGridOfSpeed * m_grid;
+        double m_left, m_bottom, m_width, m_height;
+        double m_cellStep;
+        std::size_t m_nbCellsX, m_nbCellsY;
+        double m_colorBoundary;
+        std::vector<Track> m_tracks;
+
+        std::size_t m_step = 0;
+        double m_time = 0.;
+        bool m_isSampling = false;
+        /// Sum of the square displacements of each task of a sampled step
+        std::vector<double> m_squareDisplacements;
+        /// Histograms of each thread, the two colors of a cell side by side
+        std::vector<std::vector<std::uint32_t>> m_threadHistograms;
+        std::vector<std::uint32_t> m_histograms[2];
+        Sample m_sample;
+    };
+
+    /**
+     * @brief Write a sample as a line of CSV (see MixingStatistics::csvHeader)
+     */
+    std::ostream & operator<<(std::ostream & os, const MixingStatistics::Sample & t_sample);
+
+    /**
+     * @brief Files where the samples of mixing statistics are streamed : a
+     * CSV log and, optionally, the binary histograms
+     */
+    class MixingLog {
+    public:
+        /**
+         * @param t_histogramFile Empty : the histograms are not written
+         */
+        MixingLog(const std::string & t_csvFile, const std::string & t_histogramFile);
+
+        /**
+         * @brief Append the last sample of t_statistics, if the last step was
+         * sampled
+         */
+        void write(const MixingStatistics & t_statistics);
+
+    private:
+        std::ofstream m_csv, m_histogram;
+    };
+} // namespace Simulation
+
+#endif
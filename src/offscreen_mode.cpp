@@ -0,0 +1,87 @@
+#include "offscreen_mode.hpp"
+
+#include "frame_recorder.hpp"
+#include "interactive.hpp"
+#include "mixing_statistics.hpp"
+#include "rasterizer.hpp"
+#include "step_pipeline.hpp"
+#include "tracer.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <omp.h>
+#include <optional>
+
+int runOffscreen(const Options & t_options,
+                 Simulation::Vortices t_vortices,
+                 bool isMobile,
+                 Numeric::CartesianGridOfSpeed t_grid,
+                 Geometry::CloudOfPoints t_cloud,
+                 Simulation::ParticleSources t_sources,
+                 const Numeric::FtleField * t_ftle,
+                 std::optional<Simulation::SessionReplay> t_replay) {
+    Numeric::StepPipeline pipeline;
+    pipeline.setScheme(t_options.scheme);
+    pipeline.setTimeInterpolation(t_options.interpolateField);
+    pipeline.setVelocitySource(t_options.particleVelocity);
+    pipeline.setLazyField(t_options.lazyField);
+    t_grid.setTiledLayout(t_options.tiledField);
+    if (t_sources.isActive())
+        pipeline.setSources(&t_sources);
+    std::optional<Simulation::MixingStatistics> statistics;
+    std::optional<Simulation::MixingLog> mixingLog;
+    if (t_options.mixingPeriod > 0) {
+        statistics.emplace(t_cloud, t_grid, t_options.mixingPeriod);
+        mixingLog.emplace(t_options.mixingLog, t_options.mixingHistogram);
+        pipeline.setMixingStatistics(&*statistics);
+    }
+
+    Graphisme::Rasterizer rasterizer({ t_options.resx, t_options.resy });
+    rasterizer.setFieldArrows(t_options.fieldArrows);
+    rasterizer.setTrails(t_options.trails, t_options.trailLength);
+    Graphisme::FrameRecorder recorder(t_options.recordPrefix, t_options.recordFormat,
+                                      t_options.resx, t_options.resy);
+    auto record = [&](std::size_t t_step, double t_time) {
+        if (std::uint8_t * pixels = recorder.acquire(t_step, t_time)) {
+            rasterizer.render(t_grid, t_vortices, t_cloud, t_ftle, pixels);
+            recorder.commit();
+            if (t_options.timings && rasterizer.trailsTiming())
+                std::cout << "[timings] frame " << t_step << " : trails "
+                          << *rasterizer.trailsTiming() << std::endl;
+        }
+    };
+
+    Trace::setThreadName("main");
+    // Sans session rejouée, l'animation tourne avec le pas de temps initial
+    SimulationControl control;
+    control.animate = !t_replay;
+    double time = 0.;
+    double start = omp_get_wtime();
+    record(0, time);
+    std::size_t iStep = 0;
+    while (iStep < t_options.offscreenSteps) {
+        control.advance = false;
+        if (t_replay && !t_replay->apply(iStep, control))
+            break;
+        ++iStep;
+        time += control.dt;
+        // Un pas demandé explicitement est toujours enregistré
+        bool isFrame = control.advance || iStep % t_options.recordInterval == 0;
+        pipeline.step(control.dt, t_grid, t_vortices, t_cloud, isMobile, isFrame);
+        if (isFrame)
+            record(iStep, time);
+        if (mixingLog)
+            mixingLog->write(*statistics);
+        if (t_options.timings)
+            std::cout << "[timings] step " << iStep << " : " << pipeline.timings() << std::endl;
+    }
+    double computed = omp_get_wtime() - start;
+    recorder.finish();
+    if (t_replay)
+        std::cout << "[replay] " << *t_replay << std::endl;
+    std::cout << iStep << " steps computed in " << computed << " s, "
+              << recorder.nbWritten() << " frames written (" << recorder.nbDropped()
+              << " dropped) in " << t_options.recordPrefix << "*, total "
+              << omp_get_wtime() - start << " s" << std::endl;
+    return EXIT_SUCCESS;
+}
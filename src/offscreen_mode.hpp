@@ -0,0 +1,37 @@
+#ifndef _OFFSCREEN_MODE_HPP_
+#define _OFFSCREEN_MODE_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "cloud_of_points.hpp"
+#include "ftle.hpp"
+#include "options.hpp"
+#include "particle_sources.hpp"
+#include "session_log.hpp"
+#include "vortex.hpp"
+
+#include <optional>
+
+/**
+ * @brief Run the simulation without any window and record its frames
+ *
+ * For nodes without display : options.offscreenSteps time steps are computed
+ * in a single process, without MPI. Every options.recordInterval steps (and
+ * for the initial state), the frame is drawn by the software Rasterizer in a
+ * buffer of a FrameRecorder, whose thread writes it to disk while the next
+ * steps are computed.
+ *
+ * @param t_ftle If not null, FTLE field drawn in place of the velocity field
+ * @param t_replay If set, session whose orders are applied at their recorded
+ * steps : the animation only runs when it was running in the session, and
+ * the computation stops at the end of the session
+ * @return The exit code of the program
+ */
+int runOffscreen(const Options & t_options,
+                 Simulation::Vortices t_vortices,
+                 bool isMobile,
+                 Numeric::CartesianGridOfSpeed t_grid,
+                 Geometry::CloudOfPoints t_cloud,
+                 Simulation::ParticleSources t_sources,
+                 const Numeric::FtleField * t_ftle = nullptr,
+                 std::optional<Simulation::SessionReplay> t_replay = std::nullopt);
+
+#endif
@@ -0,0 +1,299 @@
+#include "options.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+Options parseOptions(int argc, char * argv[]) {
+    Options options;
+    std::vector<std::string> positional;
+
+    for (int iArg = 1; iArg < argc; ++iArg) {
+        std::string_view arg { argv[iArg] };
+        if (!arg.starts_with("--")) {
+            positional.emplace_back(arg);
+            continue;
+        }
+        std::string_view name = arg.substr(2);
+        std::string value;
+        if (auto eq = name.find('='); eq != std::string_view::npos) {
+            value = std::string(name.substr(eq + 1));
+            name = name.substr(0, eq);
+        }
+
+        if (name == "timings") {
+            options.timings = true;
+        } else if (name == "threaded") {
+            options.threaded = true;
+        } else if (name == "no-shared-memory") {
+            options.sharedMemory = false;
+        } else if (name == "interpolate-field") {
+            options.interpolateField = true;
+        } else if (name == "lazy-field") {
+            options.lazyField = true;
+        } else if (name == "tiled-field") {
+            options.tiledField = true;
+        } else if (name == "frame-interval") {
+            if (value.empty() || std::stoull(value) == 0)
+                throw std::invalid_argument("--frame-interval expects a positive number of steps");
+            options.frameInterval = std::stoull(value);
+        } else if (name == "balance-period") {
+            if (value.empty())
+                throw std::invalid_argument("--balance-period expects a number of steps");
+            options.balancePeriod = std::stoull(value);
+        } else if (name == "ftle") {
+            if (value.empty() || std::stod(value) == 0.)
+                throw std::invalid_argument("--ftle expects a non zero integration time");
+            options.ftleDuration = std::stod(value);
+        } else if (name == "ftle-resolution") {
+            if (value.empty() || std::stoull(value) == 0)
+                throw std::invalid_argument("--ftle-resolution expects a positive number of seeds");
+            options.ftleResolution = std::stoull(value);
+        } else if (name == "ftle-output") {
+            if (value.empty())
+                throw std::invalid_argument("--ftle-output expects a file name");
+            options.ftleOutput = value;
+        } else if (name == "ftle-display") {
+            options.ftleDisplay = true;
+        } else if (name == "mixing-stats") {
+            if (value.empty() || std::stoull(value) == 0)
+                throw std::invalid_argument("--mixing-stats expects a positive number of steps");
+            options.mixingPeriod = std::stoull(value);
+        } else if (name == "mixing-log") {
+            if (value.empty())
+                throw std::invalid_argument("--mixing-log expects a file name");
+            options.mixingLog = value;
+        } else if (name == "mixing-histogram") {
+            if (value.empty())
+                throw std::invalid_argument("--mixing-histogram expects a file name");
+            options.mixingHistogram = value;
+        } else if (name == "offscreen") {
+            // Sans valeur, jusqu'à la fin de la session rejouée (vérifié
+            // après la lecture de toutes les options)
+            if (!value.empty() && std::stoull(value) == 0)
+                throw std::invalid_argument("--offscreen expects a positive number of steps");
+            options.offscreenSteps = value.empty() ? SIZE_MAX : std::stoull(value);
+        } else if (name == "record-interval") {
+            if (value.empty() || std::stoull(value) == 0)
+                throw std::invalid_argument(
+                    "--record-interval expects a positive number of steps");
+            options.recordInterval = std::stoull(value);
+        } else if (name == "record-prefix") {
+            if (value.empty())
+                throw std::invalid_argument("--record-prefix expects a path");
+            options.recordPrefix = value;
+        } else if (name == "record-format") {
+            options.recordFormat = Graphisme::parseFrameFormat(value);
+        } else if (name == "field-arrows") {
+            if (value.empty())
+                throw std::invalid_argument("--field-arrows expects a number of arrows");
+            options.fieldArrows = std::stoull(value);
+        } else if (name == "trails") {
+            if (value.empty())
+                throw std::invalid_argument("--trails expects a number of particles");
+            options.trails = std::stoull(value);
+        } else if (name == "trail-length") {
+            if (value.empty() || std::stoull(value) < 2)
+                throw std::invalid_argument("--trail-length expects at least 2 positions");
+            options.trailLength = std::stoull(value);
+        } else if (name == "particle-velocity") {
+            options.particleVelocity = Numeric::parseVelocitySource(value);
+        } else if (name == "scheme") {
+            options.scheme = Numeric::parseScheme(value);
+        } else if (name == "precision-report") {
+            if (value.empty())
+                throw std::invalid_argument("--precision-report expects a number of steps");
+            options.precisionReport = std::stoull(value);
+        } else if (name == "grid-benchmark") {
+            if (value.empty())
+                throw std::invalid_argument("--grid-benchmark expects a number of particles");
+            options.gridBenchmark = std::stoull(value);
+        } else if (name == "memory-benchmark") {
+            if (value.empty())
+                throw std::invalid_argument("--memory-benchmark expects a number of particles");
+            options.memoryBenchmark = std::stoull(value);
+        } else if (name == "accuracy-benchmark") {
+            if (value.empty() || std::stod(value) <= 0.)
+                throw std::invalid_argument("--accuracy-benchmark expects a positive duration");
+            options.accuracyBenchmark = std::stod(value);
+        } else if (name == "accuracy-output") {
+            if (value.empty())
+                throw std::invalid_argument("--accuracy-output expects a file name");
+            options.accuracyOutput = value;
+        } else if (name == "error-budget") {
+            if (value.empty() || std::stod(value) <= 0.)
+                throw std::invalid_argument("--error-budget expects a positive distance");
+            options.errorBudget = std::stod(value);
+        } else if (name == "record-session") {
+            if (value.empty())
+                throw std::invalid_argument("--record-session expects a file name");
+            options.recordSession = value;
+        } else if (name == "replay") {
+            if (value.empty())
+                throw std::invalid_argument("--replay expects a session log");
+            options.replaySession = value;
+        } else if (name == "trace") {
+            if (value.empty())
+                throw std::invalid_argument("--trace expects a file name");
+            options.traceFile = value;
+        } else if (name == "trace-capacity") {
+            if (value.empty() || std::stoull(value) == 0)
+                throw std::invalid_argument("--trace-capacity expects a positive number");
+            options.traceCapacity = std::stoull(value);
+        } else if (name == "serve") {
+            if (value.empty())
+                throw std::invalid_argument("--serve expects tcp:<host>:<port> or unix:<path>");
+            options.serve = value;
+        } else if (name == "connect") {
+            if (value.empty())
+                throw std::invalid_argument("--connect expects tcp:<host>:<port> or unix:<path>");
+            options.connect = value;
+        } else if (name == "no-first-touch") {
+            options.firstTouch = false;
+        } else if (name == "huge-pages") {
+            options.hugePages = true;
+        } else {
+            throw std::invalid_argument("Unknown option --" + std::string(name));
+        }
+    }
+
+    if (options.offscreenSteps == SIZE_MAX && options.replaySession.empty())
+        throw std::invalid_argument("--offscreen expects a positive number of steps");
+    if (!options.recordSession.empty() && !options.replaySession.empty())
+        throw std::invalid_argument("--record-session and --replay cannot be combined");
+    if (!options.serve.empty() && !options.connect.empty())
+        throw std::invalid_argument("--serve and --connect cannot be combined");
+    // Les ordres d'un serveur viennent de ses spectateurs
+    if (!options.serve.empty() && !options.replaySession.empty())
+        throw std::invalid_argument("--serve and --replay cannot be combined");
+    // Le spectateur distant reçoit le domaine de la simulation
+    if (!options.connect.empty()) {
+        if (positional.size() > 1) {
+            options.resx = std::stoull(positional[0]);
+            options.resy = std::stoull(positional[1]);
+        }
+        return options;
+    }
+    // Le banc de mémoire n'utilise pas de scénario
+    if (options.memoryBenchmark > 0)
+        return options;
+    if (positional.empty())
+        throw std::invalid_argument("Missing configuration file");
+    options.configFile = positional[0];
+    if (positional.size() > 2) {
+        options.resx = std::stoull(positional[1]);
+        options.resy = std::stoull(positional[2]);
+    }
+    return options;
+}
+
+void printUsage(const char * program) {
+    std::cout << "Usage : " << program << " <nom fichier configuration> [resx resy] [options]"
+              << std::endl
+              << "        " << program << " --connect=A [resx resy] [options]" << std::endl
+              << "Options :" << std::endl
+              << "    --timings    print the per-phase timings of each time step" << std::endl
+              << "    --threaded   single process mode : compute and display threads, no MPI"
+              << std::endl
+              << "    --no-shared-memory  always exchange the state by messages, even on a "
+                 "single node"
+              << std::endl
+              << "    --scheme=S   time integration scheme : heun, rk3, rk4 (default) or rk5"
+              << std::endl
+              << "    --interpolate-field  with mobile vortices, interpolate the velocity field "
+                 "in time inside the particle stages"
+              << std::endl
+              << "    --particle-velocity=V  velocity of the particles : grid (default), direct "
+                 "(summed over the vortices) or auto (the cheapest, measured)"
+              << std::endl
+              << "    --lazy-field  with mobile vortices, only compute the tiles of the velocity "
+                 "field read by the particles, the whole field being computed for displayed "
+                 "frames"
+              << std::endl
+              << "    --tiled-field  interpolate the velocity of the particles in a copy of the "
+                 "field stored by blocks of 8 x 8 cells (faster on fine grids)"
+              << std::endl
+              << "    --balance-period=N  with several simulation processes, check the balance "
+                 "of their particles every N steps (default 20, 0 : never)"
+              << std::endl
+              << "    --frame-interval=N  display one time step out of N (default 1)" << std::endl
+              << "    --precision-report=N  compare the float and double trajectories of the "
+                 "particles over N steps, then exit"
+              << std::endl
+              << "    --accuracy-benchmark=T  compare the trajectory errors of the particles "
+                 "around fixed vortices over the duration T and the cost of every time step, "
+                 "grid step, scheme and precision, print the Pareto front, then exit"
+              << std::endl
+              << "    --accuracy-output=F  CSV file of every configuration (default accuracy.csv)"
+              << std::endl
+              << "    --error-budget=E  also print the cheapest configuration whose rms error "
+                 "is at most E"
+              << std::endl
+              << "    --ftle=T     compute the FTLE field of the initial state over the "
+                 "integration time T (negative : backward), write it, then exit"
+              << std::endl
+              << "    --ftle-resolution=R  R x R FTLE seeds per cell of the grid (default 4)"
+              << std::endl
+              << "    --ftle-output=F  file where the FTLE field is written (default ftle.dat)"
+              << std::endl
+              << "    --ftle-display  with --ftle, run the simulation displaying the FTLE field "
+                 "in place of the velocity field"
+              << std::endl
+              << "    --mixing-stats=N  every N steps, log the mean square displacement of the "
+                 "particles (unwrapped from the torus) and their occupancy and mixing entropies "
+                 "over the cells"
+              << std::endl
+              << "    --mixing-log=F  CSV file of the mixing statistics (default mixing.csv)"
+              << std::endl
+              << "    --mixing-histogram=F  also write the particle counts of each cell in the "
+                 "binary file F"
+              << std::endl
+              << "    --offscreen=N  compute N steps without window, recording the frames to "
+                 "disk, then exit (without N, with --replay : until the end of the session)"
+              << std::endl
+              << "    --record-interval=N  without window, record one step out of N (default 1)"
+              << std::endl
+              << "    --record-prefix=P  path and start of the name of the recorded frames "
+                 "(default frames/frame_)"
+              << std::endl
+              << "    --record-format=F  format of the recorded frames : png (default) or raw "
+                 "(RGBA bytes)"
+              << std::endl
+              << "    --field-arrows=N  draw at most N arrows per row over the velocity field "
+                 "(default 32, 0 : colors only)"
+              << std::endl
+              << "    --trails=N  draw the path of N particles over their last positions"
+              << std::endl
+              << "    --trail-length=K  number of positions of a trail (default 32)" << std::endl
+              << "    --record-session=F  log the orders of the user and their time steps in "
+                 "the file F"
+              << std::endl
+              << "    --replay=F  replay the orders of the session log F at the same time "
+                 "steps, instead of the keyboard (which can only close the window)"
+              << std::endl
+              << "    --trace=F  write the timeline of the threads of every process in the "
+                 "file F (Chrome trace JSON, for chrome://tracing or ui.perfetto.dev)"
+              << std::endl
+              << "    --trace-capacity=N  number of intervals kept per thread (default 65536, "
+                 "the oldest being overwritten)"
+              << std::endl
+              << "    --serve=A  without window, publish the frames to the remote viewers "
+                 "connected to the address A (tcp:<host>:<port> or unix:<path>), which drive "
+                 "the simulation"
+              << std::endl
+              << "    --connect=A  display the frames of the simulation serving on the address "
+                 "A, without configuration file ([resx resy] may still be given)"
+              << std::endl
+              << "    --grid-benchmark=N  time the row-major and the tiled layouts of the "
+                 "velocity field on fine grids with N particles, then exit"
+              << std::endl
+              << "    --no-first-touch  do not place the pages of large storages by a parallel "
+                 "first touch"
+              << std::endl
+              << "    --huge-pages  ask for transparent huge pages on large storages" << std::endl
+              << "    --memory-benchmark=N  measure the memory bandwidth of N particles for "
+                 "several placements of their pages, then exit (without configuration file)"
+              << std::endl;
+}
@@ -0,0 +1,130 @@
+#ifndef _OPTIONS_HPP_
+#define _OPTIONS_HPP_
+
+#include "frame_recorder.hpp"
+#include "scheme.hpp"
+#include "velocity_source.hpp"
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Command line of the simulator
+ *
+ * Positional arguments are the configuration file followed by the optional
+ * screen resolution. Every other argument is an option of the form
+ * `--name` or `--name=value`.
+ */
+struct Options {
+    std::string configFile;
+    std::size_t resx = 800, resy = 600;
+
+    /// Print the per-phase timings of every time step on the simulation side
+    bool timings = false;
+    /// Run the simulation and the display in two threads of a single process,
+    /// without MPI
+    bool threaded = false;
+    /// Exchange the state through MPI shared memory when the screen and the
+    /// simulation processes are on the same node
+    bool sharedMemory = true;
+    /// If not zero, compare the float and double trajectories over this
+    /// number of steps and exit
+    std::size_t precisionReport = 0;
+    /// If not zero, compare the row-major and the tiled layouts of the
+    /// velocity field with this number of particles on fine grids and exit
+    std::size_t gridBenchmark = 0;
+    /// If not zero, measure the memory bandwidth of this number of particles
+    /// for several placements of their pages and exit
+    std::size_t memoryBenchmark = 0;
+    /// If not zero, duration over which the accuracy and the cost of the
+    /// configurations of the advection are compared, before exiting
+    double accuracyBenchmark = 0.;
+    /// CSV file of the configurations of the accuracy benchmark
+    std::string accuracyOutput = "accuracy.csv";
+    /// If not zero, error budget for which the accuracy benchmark prints the
+    /// cheapest configuration
+    double errorBudget = 0.;
+    /// Place the pages of large storages by a parallel first touch
+    bool firstTouch = true;
+    /// Ask for transparent huge pages on large storages
+    bool hugePages = false;
+    /// Time integration scheme
+    Numeric::Scheme scheme = Numeric::Scheme::RK4;
+    /// With mobile vortices, advect the particles in the velocity field
+    /// interpolated in time over each step
+    bool interpolateField = false;
+    /// Velocity of the particles : interpolated in the grid, summed directly
+    /// over the vortices, or the cheapest of both
+    Numeric::VelocitySource particleVelocity = Numeric::VelocitySource::Grid;
+    /// Evaluate the field of mobile vortices lazily, tile by tile
+    bool lazyField = false;
+    /// Interpolate the velocity field in a tiled copy of the field
+    bool tiledField = false;
+    /// With several simulation processes, number of time steps between two
+    /// checks of the balance of the particles (0 : never)
+    std::size_t balancePeriod = 20;
+    /// If not zero, integration time of the FTLE field of the initial state
+    /// (negative : backward in time)
+    double ftleDuration = 0.;
+    /// Number of FTLE seeds per cell of the grid in each direction
+    std::size_t ftleResolution = 4;
+    /// File where the FTLE field is written
+    std::string ftleOutput = "ftle.dat";
+    /// Display the FTLE field in place of the velocity field and run the
+    /// simulation, instead of exiting once the field is written
+    bool ftleDisplay = false;
+    /// If not zero, number of time steps between two samples of the mixing
+    /// statistics of the particles
+    std::size_t mixingPeriod = 0;
+    /// CSV file where the mixing statistics are written
+    std::string mixingLog = "mixing.csv";
+    /// If not empty, binary file where the occupancy histograms are written
+    std::string mixingHistogram;
+    /// If not zero, number of time steps computed without window, the frames
+    /// being recorded to disk (SIZE_MAX : until the end of the replayed session)
+    std::size_t offscreenSteps = 0;
+    /// Without window, number of time steps between two recorded frames
+    std::size_t recordInterval = 1;
+    /// Path and start of the name of the recorded frames
+    std::string recordPrefix = "frames/frame_";
+    /// Format of the recorded frames
+    Graphisme::FrameRecorder::Format recordFormat = Graphisme::FrameRecorder::Format::Png;
+    /// Number of time steps between two displayed frames
+    std::size_t frameInterval = 1;
+    /// Number of arrows per row drawn over the velocity field (0 : none)
+    std::size_t fieldArrows = 32;
+    /// Number of particles drawn with the trail of their last positions
+    std::size_t trails = 0;
+    /// Number of positions of a trail
+    std::size_t trailLength = 32;
+    /// If not empty, file where the orders of the user are logged with their
+    /// time step (see Simulation::SessionRecorder)
+    std::string recordSession;
+    /// If not empty, session log whose orders replace the keyboard
+    std::string replaySession;
+    /// If not empty, file where the timeline of every thread of every
+    /// process is written (see Trace)
+    std::string traceFile;
+    /// Number of intervals kept per thread in the timeline
+    std::size_t traceCapacity = 1 << 16;
+    /// If not empty, address where the frames are published to remote
+    /// viewers instead of a window (see Simulation::FrameServer)
+    std::string serve;
+    /// If not empty, address of the simulation whose frames are displayed
+    /// (no configuration file is needed)
+    std::string connect;
+};
+
+/**
+ * @brief Parse the command line
+ *
+ * Throw std::invalid_argument on an unknown option or a malformed value.
+ */
+Options parseOptions(int argc, char * argv[]);
+
+/**
+ * @brief Print the list of supported options
+ */
+void printUsage(const char * program);
+
+#endif
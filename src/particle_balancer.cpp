@@ -0,0 +1,162 @@
+#include "particle_balancer.hpp"
+
+#include "tracer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+#include <omp.h>
+#include <utility>
+
+using namespace Simulation;
+
+ParticleBalancer::ParticleBalancer(MPI_Comm t_comm,
+                                   std::size_t t_nbPoints,
+                                   std::size_t t_period,
+                                   double t_threshold)
+    : m_comm(t_comm), m_period(t_period), m_threshold(t_threshold) {
+    MPI_Comm_rank(m_comm, &m_rank);
+    MPI_Comm_size(m_comm, &m_size);
+    m_firsts.resize(m_size + 1);
+    for (int iRank = 0; iRank <= m_size; ++iRank)
+        m_firsts[iRank] = iRank * t_nbPoints / m_size;
+    m_speeds.assign(m_size, 0.);
+    m_nbThreads.resize(m_size);
+    int nbThreads = omp_get_max_threads();
+    MPI_Allgather(&nbThreads, 1, MPI_INT, m_nbThreads.data(), 1, MPI_INT, m_comm);
+}
+
+Geometry::CloudOfPoints ParticleBalancer::localPoints(const Geometry::CloudOfPoints & t_all) const {
+    Geometry::CloudOfPoints points(last(m_rank) - first(m_rank));
+    std::copy(t_all.begin() + first(m_rank), t_all.begin() + last(m_rank), points.begin());
+    return points;
+}
+
+void ParticleBalancer::record(double t_seconds) {
+    m_seconds += t_seconds;
+    m_nbUpdates += last(m_rank) - first(m_rank);
+}
+
+bool ParticleBalancer::balance(Geometry::CloudOfPoints & t_points) {
+    if (m_period == 0 || ++m_nbSteps % m_period != 0)
+        return false;
+
+    Trace::Scope scope("balance", "mpi");
+    double local[2] = { m_seconds, double(m_nbUpdates) };
+    std::vector<double> measures(2 * m_size);
+    MPI_Allgather(local, 2, MPI_DOUBLE, measures.data(), 2, MPI_DOUBLE, m_comm);
+    m_seconds = 0.;
+    m_nbUpdates = 0;
+
+    // Tous les processus font les mêmes calculs sur les mêmes mesures, et
+    // décident donc des mêmes échanges
+    double maxSeconds = 0., sumSeconds = 0.;
+    for (int iRank = 0; iRank < m_size; ++iRank) {
+        double seconds = measures[2 * iRank], nbUpdates = measures[2 * iRank + 1];
+        maxSeconds = std::max(maxSeconds, seconds);
+        sumSeconds += seconds;
+        if (seconds > 0. && nbUpdates > 0.) {
+            double speed = nbUpdates / seconds;
+            m_speeds[iRank] = m_speeds[iRank] > 0. ? 0.5 * (m_speeds[iRank] + speed) : speed;
+        }
+    }
+    m_imbalance = sumSeconds > 0. ? maxSeconds * m_size / sumSeconds : 1.;
+    m_nbOverThreshold = m_imbalance > m_threshold ? m_nbOverThreshold + 1 : 0;
+    m_moved = 0;
+    if (m_nbOverThreshold >= 2) {
+        exchange(t_points, targetFirsts());
+        m_nbOverThreshold = 0;
+    }
+    return true;
+}
+
+std::vector<std::size_t> ParticleBalancer::targetFirsts() const {
+    // Un processus sans mesure (aucune particule) compte pour la vitesse
+    // moyenne des autres
+    double sumSpeeds = 0.;
+    int nbMeasured = 0;
+    for (double speed : m_speeds) {
+        sumSpeeds += speed;
+        nbMeasured += speed > 0. ? 1 : 0;
+    }
+    double meanSpeed = nbMeasured > 0 ? sumSpeeds / nbMeasured : 1.;
+    auto speed = [&](int iRank) { return m_speeds[iRank] > 0. ? m_speeds[iRank] : meanSpeed; };
+    double total = 0.;
+    for (int iRank = 0; iRank < m_size; ++iRank)
+        total += speed(iRank);
+
+    std::size_t nbPoints = m_firsts.back();
+    std::vector<std::size_t> firsts(m_firsts);
+    double cumulated = 0.;
+    for (int iRank = 1; iRank < m_size; ++iRank) {
+        cumulated += speed(iRank - 1);
+        auto target = std::size_t(std::llround(nbPoints * cumulated / total));
+        // La frontière reste dans les plages de ses deux processus : les
+        // particules ne passent que d'un voisin à l'autre
+        firsts[iRank] = std::clamp(target, m_firsts[iRank - 1], m_firsts[iRank + 1]);
+    }
+    return firsts;
+}
+
+void ParticleBalancer::exchange(Geometry::CloudOfPoints & t_points,
+                                const std::vector<std::size_t> & t_firsts) {
+    std::size_t oldFirst = first(m_rank), oldLast = last(m_rank);
+    std::size_t newFirst = t_firsts[m_rank], newLast = t_firsts[m_rank + 1];
+    std::size_t toLeft = newFirst > oldFirst ? newFirst - oldFirst : 0;
+    std::size_t fromLeft = oldFirst > newFirst ? oldFirst - newFirst : 0;
+    std::size_t toRight = oldLast > newLast ? oldLast - newLast : 0;
+    std::size_t fromRight = newLast > oldLast ? newLast - oldLast : 0;
+    int left = m_rank > 0 ? m_rank - 1 : MPI_PROC_NULL;
+    int right = m_rank + 1 < m_size ? m_rank + 1 : MPI_PROC_NULL;
+    assert(t_points.numberOfPoints() == oldLast - oldFirst);
+
+    Geometry::CloudOfPoints newPoints(newLast - newFirst);
+    MPI_Status status;
+    // La fin de chaque plage passe au début de la suivante, puis le début de
+    // chaque plage à la fin de la précédente
+    t_points.sendrecv(t_points.numberOfPoints() - toRight, toRight, right, newPoints, 0, fromLeft,
+                      left, m_comm, &status);
+    t_points.sendrecv(0, toLeft, left, newPoints, newPoints.numberOfPoints() - fromRight,
+                      fromRight, right, m_comm, &status);
+    std::copy(t_points.begin() + toLeft, t_points.end() - toRight, newPoints.begin() + fromLeft);
+    std::swap(t_points, newPoints);
+
+    for (int iRank = 1; iRank < m_size; ++iRank) {
+        m_moved += t_firsts[iRank] > m_firsts[iRank] ? t_firsts[iRank] - m_firsts[iRank]
+                                                     : m_firsts[iRank] - t_firsts[iRank];
+    }
+    m_firsts = t_firsts;
+}
+
+void ParticleBalancer::gather(const Geometry::CloudOfPoints & t_points,
+                              Geometry::CloudOfPoints * t_all) const {
+    Trace::Scope scope("gather particles", "mpi");
+    using point = Geometry::CloudOfPoints::point;
+    constexpr std::size_t nbCoordinates = sizeof(point) / sizeof(Numeric::real);
+    std::vector<int> counts(m_size), displacements(m_size);
+    for (int iRank = 0; iRank < m_size; ++iRank) {
+        counts[iRank] = int(nbCoordinates * (last(iRank) - first(iRank)));
+        displacements[iRank] = int(nbCoordinates * first(iRank));
+    }
+    Numeric::real * all = nullptr;
+    if (m_rank == 0) {
+        assert(t_all != nullptr && t_all->numberOfPoints() == m_firsts.back());
+        all = t_all->data();
+    }
+    MPI_Gatherv(t_points.data(), counts[m_rank], Numeric::mpiType<Numeric::real>(), all,
+                counts.data(), displacements.data(), Numeric::mpiType<Numeric::real>(), 0, m_comm);
+}
+
+std::ostream & Simulation::operator<<(std::ostream & os, const ParticleBalancer & t_balancer) {
+    auto flags = os.flags();
+    os << std::fixed << std::setprecision(3) << "imbalance " << t_balancer.m_imbalance
+       << ", moved " << t_balancer.m_moved << " particles";
+    for (int iRank = 0; iRank < t_balancer.m_size; ++iRank) {
+        os << " | rank " << iRank << " : " << t_balancer.last(iRank) - t_balancer.first(iRank)
+           << " particles, " << t_balancer.m_nbThreads[iRank] << " threads, "
+           << 1.E-6 * t_balancer.m_speeds[iRank] << " M updates/s";
+    }
+    os.flags(flags);
+    return os;
+}
@@ -0,0 +1,114 @@
+#ifndef _SIMULATION_PARTICLE_BALANCER_HPP_
+#define _SIMULATION_PARTICLE_BALANCER_HPP_
+#include "cloud_of_points.hpp"
+
+#include <cstddef>
+#include <mpi.h>
+#include <ostream>
+#include <vector>
+
+namespace Simulation {
+    /**
+     * @brief Split of the particles between the simulation processes,
+     * adapted to the measured speed of each of them
+     *
+     * Each process owns a contiguous range of the particles, the ranges being
+     * ordered as the ranks of the communicator. The processes start with equal
+     * counts. Each of them records the time spent advancing its particles at
+     * every step (with all its OpenMP threads, so the speed of a process
+     * accounts for its number of threads and the generation of its cores).
+     * Every period steps, the speeds (particle updates per second) are
+     * exchanged and the imbalance ratio (slowest time over mean time) is
+     * computed.
+     *
+     * Hysteresis : the particles are only moved when the ratio exceeds the
+     * threshold on two checks in a row, and the speeds used for the new split
+     * are averaged over the checks, so a single noisy period neither triggers
+     * nor drives a redistribution. The new counts are proportional to the
+     * speeds, but each boundary between two ranges only moves inside the
+     * ranges of its two processes : particles are only exchanged between
+     * neighbours (MPI_Sendrecv), and a large correction takes a few periods.
+     *
+     * Every method is collective over the communicator.
+     */
+    class ParticleBalancer {
+    public:
+        /**
+         * @param t_comm      Communicator of the simulation processes
+         * @param t_nbPoints  Total number of particles (constant)
+         * @param t_period    Number of steps between two checks (0 : never)
+         * @param t_threshold Imbalance ratio above which the particles move
+         */
+        ParticleBalancer(MPI_Comm t_comm,
+                         std::size_t t_nbPoints,
+                         std::size_t t_period = 20,
+                         double t_threshold = 1.1);
+
+        /**
+         * @brief Particles of this process taken from the whole cloud
+         */
+        Geometry::CloudOfPoints localPoints(const Geometry::CloudOfPoints & t_all) const;
+
+        /**
+         * @brief Record the time spent advancing the particles of this
+         * process during the last step
+         */
+        void record(double t_seconds);
+
+        /**
+         * @brief Check the balance if a period has elapsed and move the
+         * particles if needed
+         *
+         * @param t_points Particles of this process, replaced by the new ones
+         * @return true if a check was done (the report is up to date)
+         */
+        bool balance(Geometry::CloudOfPoints & t_points);
+
+        /**
+         * @brief Gather the particles of every process in t_all, on the first
+         * process only (t_all is ignored on the other ones)
+         */
+        void gather(const Geometry::CloudOfPoints & t_points,
+                    Geometry::CloudOfPoints * t_all) const;
+
+        /// Imbalance ratio measured by the last check
+        double imbalance() const { return m_imbalance; }
+        /// Number of particles moved by the last check
+        std::size_t moved() const { return m_moved; }
+
+        friend std::ostream & operator<<(std::ostream & os, const ParticleBalancer & t_balancer);
+
+    private:
+        std::size_t first(int t_rank) const { return m_firsts[t_rank]; }
+        std::size_t last(int t_rank) const { return m_firsts[t_rank + 1]; }
+        /**
+         * @brief New boundaries of the ranges, proportional to the speeds and
+         * moving inside the current ranges of the neighbours
+         */
+        std::vector<std::size_t> targetFirsts() const;
+        void exchange(Geometry::CloudOfPoints & t_points,
+                      const std::vector<std::size_t> & t_firsts);
+
+        MPI_Comm m_comm;
+        int m_rank, m_size;
+        std::size_t m_period;
+        double m_threshold;
+        /// First particle of each process, followed by the total number
+        std::vector<std::size_t> m_firsts;
+
+        std::size_t m_nbSteps = 0;
+        double m_seconds = 0.;
+        std::size_t m_nbUpdates = 0;
+
+        /// Speeds (particle updates per second) averaged over the checks
+        std::vector<double> m_speeds;
+        std::vector<int> m_nbThreads;
+        double m_imbalance = 1.;
+        int m_nbOverThreshold = 0;
+        std::size_t m_moved = 0;
+    };
+
+    std::ostream & operator<<(std::ostream & os, const ParticleBalancer & t_balancer);
+} // namespace Simulation
+
+#endif
@@ -0,0 +1,66 @@
+#include "particle_sources.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace Simulation;
+
+namespace {
+    template <typename PointType>
+    bool contains(const Geometry::Rectangle & t_area, const PointType & t_point) {
+        return t_point.x >= t_area.bottomLeft.x && t_point.x <= t_area.topRight.x
+               && t_point.y >= t_area.bottomLeft.y && t_point.y <= t_area.topRight.y;
+    }
+} // namespace
+
+void ParticleSources::reset(std::size_t t_nbPoints) {
+    m_time = 0.;
+    m_births.reserve(std::max(m_capacity, t_nbPoints));
+    m_births.assign(t_nbPoints, 0.);
+}
+
+void ParticleSources::findExpired(const Geometry::CloudOfPoints & t_points,
+                                  std::size_t t_first,
+                                  std::size_t t_last,
+                                  std::vector<std::size_t> & t_expired) const {
+    bool hasLifetime = m_maxAge > 0.;
+    for (std::size_t iPoint = t_first; iPoint < t_last; ++iPoint) {
+        bool expired = hasLifetime && m_time - m_births[iPoint] > m_maxAge;
+        for (std::size_t iSink = 0; !expired && iSink < m_sinks.size(); ++iSink)
+            expired = contains(m_sinks[iSink], t_points[iPoint]);
+        if (expired)
+            t_expired.push_back(iPoint);
+    }
+}
+
+void ParticleSources::apply(Geometry::CloudOfPoints & t_points,
+                            const std::vector<std::vector<std::size_t>> & t_expired) {
+    assert(m_births.size() == t_points.numberOfPoints());
+    // Réserve une fois pour toutes le nombre maximal de particules
+    if (t_points.capacity() < m_capacity)
+        t_points.reserve(m_capacity);
+
+    // En partant des plus grands indices, la dernière particule, qui prend la
+    // place de celle supprimée, n'est jamais elle-même à supprimer
+    for (auto list = t_expired.rbegin(); list != t_expired.rend(); ++list) {
+        for (auto index = list->rbegin(); index != list->rend(); ++index) {
+            t_points.removeAPoint(*index);
+            m_births[*index] = m_births.back();
+            m_births.pop_back();
+        }
+    }
+
+    for (const auto & emitter : m_emitters) {
+        std::size_t room = m_capacity - std::min(m_capacity, t_points.numberOfPoints());
+        std::size_t nbNew = std::min(emitter.rate, room);
+        std::uniform_real_distribution<double> x(emitter.area.bottomLeft.x,
+                                                 emitter.area.topRight.x);
+        std::uniform_real_distribution<double> y(emitter.area.bottomLeft.y,
+                                                 emitter.area.topRight.y);
+        for (std::size_t iNew = 0; iNew < nbNew; ++iNew) {
+            Geometry::Point<double> position { x(m_generator), y(m_generator) };
+            t_points.addAPoint(point { position });
+            m_births.push_back(m_time);
+        }
+    }
+}
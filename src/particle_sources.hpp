@@ -0,0 +1,95 @@
+#ifndef _SIMULATION_PARTICLE_SOURCES_HPP_
+#define _SIMULATION_PARTICLE_SOURCES_HPP_
+#include "cloud_of_points.hpp"
+#include "rectangle.hpp"
+
+#include <random>
+#include <vector>
+
+namespace Simulation {
+    /**
+     * @brief Emitters and sinks of particles
+     *
+     * Each emitter injects a given number of particles per time step at random
+     * positions in its rectangle. A particle is removed when it enters a sink
+     * or when it is older than the maximal lifetime. The number of particles
+     * never exceeds capacity() : injections are dropped once the cloud is
+     * full, so the memory used stays bounded however long the simulation runs.
+     *
+     * The cloud is used as a pool of capacity() points allocated once :
+     * removing a particle moves the last one in its place (O(1), the order of
+     * the particles does not matter) and injecting appends in the reserved
+     * storage, so no reallocation nor compaction happens during the steps.
+     */
+    class ParticleSources {
+    public:
+        using point = Geometry::CloudOfPoints::point;
+
+        struct Emitter {
+            Geometry::Rectangle area;
+            std::size_t rate; ///< Particles injected per time step
+        };
+
+        ParticleSources() = default;
+
+        void addEmitter(const Geometry::Rectangle & t_area, std::size_t t_rate) {
+            m_emitters.push_back({ t_area, t_rate });
+        }
+        void addSink(const Geometry::Rectangle & t_area) { m_sinks.push_back(t_area); }
+        /**
+         * @param t_maxAge Lifetime of a particle, in simulated time (0 : infinite)
+         */
+        void setMaxAge(double t_maxAge) { m_maxAge = t_maxAge; }
+        void setCapacity(std::size_t t_capacity) { m_capacity = t_capacity; }
+
+        /**
+         * @brief Whether the number of particles may change during the simulation
+         */
+        bool isActive() const { return !m_emitters.empty() || !m_sinks.empty() || m_maxAge > 0.; }
+        std::size_t capacity() const { return m_capacity; }
+
+        /**
+         * @brief Start the simulation with t_nbPoints particles born at time 0
+         */
+        void reset(std::size_t t_nbPoints);
+
+        /**
+         * @brief Move to the end of the next time step (before advecting the
+         * particles)
+         */
+        void advance(double dt) { m_time += dt; }
+
+        /**
+         * @brief Append to t_expired, in increasing order, the indices of the
+         * particles of [t_first, t_last) which must be removed
+         *
+         * Read only, may be called concurrently on disjoint ranges.
+         */
+        void findExpired(const Geometry::CloudOfPoints & t_points,
+                         std::size_t t_first,
+                         std::size_t t_last,
+                         std::vector<std::size_t> & t_expired) const;
+
+        /**
+         * @brief Remove the expired particles, then inject the new ones
+         *
+         * @param t_expired Indices found by findExpired, the lists being in
+         *                  increasing order of their ranges
+         */
+        void apply(Geometry::CloudOfPoints & t_points,
+                   const std::vector<std::vector<std::size_t>> & t_expired);
+
+    private:
+        std::vector<Emitter> m_emitters;
+        std::vector<Geometry::Rectangle> m_sinks;
+        double m_maxAge = 0.;
+        std::size_t m_capacity = 0;
+
+        double m_time = 0.;
+        // Date de naissance de chaque particule, dans l'ordre du nuage
+        std::vector<double> m_births;
+        std::minstd_rand m_generator;
+    };
+} // namespace Simulation
+
+#endif
@@ -0,0 +1,90 @@
+#include "particle_trails.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <omp.h>
+
+using namespace Graphisme;
+
+ParticleTrails::ParticleTrails(std::size_t t_nbTrails, std::size_t t_length)
+    : m_nbTrails(t_nbTrails), m_length(std::max<std::size_t>(2, t_length)) {
+    // Coût borné : au plus maxSegments segments à construire et à dessiner
+    m_nbTrails = std::min(m_nbTrails, maxSegments / (2 * (m_length - 1)));
+    m_positions.resize(m_length * m_nbTrails);
+    m_segments.resize(2 * m_nbTrails * (m_length - 1));
+}
+
+bool ParticleTrails::record(const Geometry::CloudOfPoints & t_cloud,
+                            const Numeric::CartesianGridOfSpeed & t_grid) {
+    double start = omp_get_wtime();
+    std::size_t nbPoints = t_cloud.numberOfPoints();
+    if (nbPoints != m_nbPoints) {
+        // Les indices des particules suivies ont changé : nouvelles traces
+        m_nbPoints = nbPoints;
+        m_nbRecorded = 0;
+    }
+    std::size_t nbActive = std::min(m_nbTrails, m_nbPoints);
+    auto traced = [this](std::size_t t_trail) { return t_trail * m_nbPoints / m_nbTrails; };
+
+    bool isMoved = m_nbRecorded == 0;
+    for (std::size_t iTrail = 0; iTrail < nbActive && !isMoved; ++iTrail) {
+        const auto & p = t_cloud[traced(iTrail)];
+        const auto & last = position(0, iTrail);
+        isMoved = double(p.x) != last.x || double(p.y) != last.y;
+    }
+    if (!isMoved)
+        return false;
+
+    m_newest = (m_newest + 1) % m_length;
+    m_nbRecorded = std::min(m_nbRecorded + 1, m_length);
+    for (std::size_t iTrail = 0; iTrail < nbActive; ++iTrail) {
+        const auto & p = t_cloud[traced(iTrail)];
+        m_positions[m_newest * m_nbTrails + iTrail] = { double(p.x), double(p.y) };
+    }
+    updateSegments(t_grid);
+    m_timing.seconds = omp_get_wtime() - start;
+    return true;
+}
+
+void ParticleTrails::updateSegments(const Numeric::CartesianGridOfSpeed & t_grid) {
+    auto bottomLeft = t_grid.getLeftBottomVertex(), topRight = t_grid.getRightTopVertex();
+    auto isInside = [&](const Geometry::Point<double> & p) {
+        return p.x >= bottomLeft.x && p.x <= topRight.x && p.y >= bottomLeft.y
+               && p.y <= topRight.y;
+    };
+    std::size_t nbActive = std::min(m_nbTrails, m_nbPoints);
+    std::size_t nbSegments = 0;
+#pragma omp parallel for reduction(+ : nbSegments)
+    for (std::size_t iTrail = 0; iTrail < m_nbTrails; ++iTrail) {
+        Segment * segments = m_segments.data() + 2 * iTrail * (m_length - 1);
+        for (std::size_t age = 0; age + 1 < m_length; ++age) {
+            Segment & direct = segments[2 * age];
+            Segment & wrapped = segments[2 * age + 1];
+            direct.alpha = wrapped.alpha = 0;
+            if (iTrail >= nbActive || age + 1 >= m_nbRecorded)
+                continue;
+            // Déplacement le plus court sur le tore entre deux positions
+            // successives : une traversée de bord est tracée des deux côtés
+            const auto & p = position(age, iTrail);
+            const auto & q = position(age + 1, iTrail);
+            auto [dx, dy] = t_grid.wrappedDisplacement(p, q);
+            auto alpha = std::uint8_t(std::lround(224. * (m_length - 1 - age) / (m_length - 1)));
+            direct = { p, { p.x + dx, p.y + dy }, alpha };
+            ++nbSegments;
+            if (!isInside(direct.b)) {
+                wrapped = { { q.x - dx, q.y - dy }, q, alpha };
+                ++nbSegments;
+            }
+        }
+    }
+    m_timing.nbSegments = nbSegments;
+}
+
+std::ostream & Graphisme::operator<<(std::ostream & os, const ParticleTrails::Timing & t_timing) {
+    auto flags = os.flags();
+    os << std::fixed << std::setprecision(3) << 1.E3 * t_timing.seconds << " ms ("
+       << t_timing.nbSegments << " segments)";
+    os.flags(flags);
+    return os;
+}
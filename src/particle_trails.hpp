@@ -0,0 +1,84 @@
+#ifndef _GRAPHISM_PARTICLE_TRAILS_HPP_
+#define _GRAPHISM_PARTICLE_TRAILS_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "cloud_of_points.hpp"
+#include "point.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace Graphisme {
+    /**
+     * @brief Recent path of a subset of the particles, drawn as fading lines
+     *
+     * The last length() recorded positions of nbTrails() particles, evenly
+     * spaced in the cloud, are kept in a ring buffer. Each record turns them
+     * into segments (two per pair of consecutive positions, so that a pair
+     * crossing a border of the torus is drawn on both sides), whose opacity
+     * decreases with their age. All the storage is allocated by the
+     * constructor, and the number of segments is capped by maxSegments.
+     */
+    class ParticleTrails {
+    public:
+        /// Segment of a trail, in the coordinates of the domain
+        struct Segment {
+            Geometry::Point<double> a, b;
+            std::uint8_t alpha = 0; ///< 0 : segment not drawn
+        };
+        /// Cost of the last update of the trails
+        struct Timing {
+            double seconds = 0.;
+            std::size_t nbSegments = 0; ///< Drawn segments
+        };
+
+        /// Largest number of segments, the number of trails being reduced
+        static constexpr std::size_t maxSegments = std::size_t(1) << 20;
+
+        /**
+         * @param t_nbTrails Number of traced particles
+         * @param t_length   Number of positions kept per particle (at least 2)
+         */
+        ParticleTrails(std::size_t t_nbTrails, std::size_t t_length);
+
+        std::size_t nbTrails() const { return m_nbTrails; }
+        std::size_t length() const { return m_length; }
+
+        /**
+         * @brief Append the current positions of the traced particles and
+         * update the segments
+         *
+         * Nothing is done if no traced particle moved since the last record
+         * (paused simulation, same frame displayed again). The trails start
+         * again when the number of particles changes (particle sources).
+         *
+         * @return Whether the segments changed
+         */
+        bool record(const Geometry::CloudOfPoints & t_cloud,
+                    const Numeric::CartesianGridOfSpeed & t_grid);
+
+        /// Segments of the trails, 2 * nbTrails() * (length() - 1) of them
+        const std::vector<Segment> & segments() const { return m_segments; }
+        const Timing & timing() const { return m_timing; }
+
+    private:
+        const Geometry::Point<double> & position(std::size_t t_age, std::size_t t_trail) const {
+            std::size_t slot = (m_newest + m_length - t_age) % m_length;
+            return m_positions[slot * m_nbTrails + t_trail];
+        }
+        void updateSegments(const Numeric::CartesianGridOfSpeed & t_grid);
+
+        std::size_t m_nbTrails, m_length;
+        /// Ring of m_length rows of m_nbTrails positions
+        std::vector<Geometry::Point<double>> m_positions;
+        std::size_t m_newest = 0, m_nbRecorded = 0;
+        std::size_t m_nbPoints = 0;
+        std::vector<Segment> m_segments;
+        Timing m_timing;
+    };
+
+    std::ostream & operator<<(std::ostream & os, const ParticleTrails::Timing & t_timing);
+} // namespace Graphisme
+
+#endif
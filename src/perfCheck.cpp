@@ -0,0 +1,249 @@
+#include "ensemble.hpp"
+#include "perf_check.hpp"
+#include "precision.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mpi.h>
+#include <omp.h>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+    struct CheckOptions {
+        std::string input;
+        std::string baseline = "data/perf.baseline";
+        /// Number of measures of each run
+        std::size_t repeat = 5;
+        /// Number of OpenMP threads per process
+        int threads = 2;
+        /// Smallest relative slowdown taken for a regression
+        double tolerance = 0.1;
+        /// Slowdown taken for a regression, in deviations of the noise
+        double deviations = 3.;
+        /// Write the baseline instead of comparing with it
+        bool writeBaseline = false;
+        /// Succeed without comparing anything when there is no baseline
+        bool allowMissingBaseline = false;
+    };
+
+    void printUsage(const char * program) {
+        std::cout << "Usage : " << program << " <ensemble file> [options]" << std::endl
+                  << "Measure the throughputs of the runs of an ensemble file and compare them "
+                     "with a baseline, exit with a failure on a regression"
+                  << std::endl
+                  << "    --baseline=F  baseline file (default data/perf.baseline)" << std::endl
+                  << "    --repeat=R  measures of each run (default 5)" << std::endl
+                  << "    --threads=T  OpenMP threads per process (default 2)" << std::endl
+                  << "    --tolerance=X  smallest relative slowdown taken for a regression "
+                     "(default 0.1)"
+                  << std::endl
+                  << "    --deviations=K  slowdown taken for a regression, in deviations of "
+                     "the noise estimated from the MAD (default 3)"
+                  << std::endl
+                  << "    --write-baseline  write the measures in the baseline file instead of "
+                     "comparing them"
+                  << std::endl
+                  << "    --allow-missing-baseline  succeed without comparing anything when "
+                     "the baseline file does not exist"
+                  << std::endl;
+    }
+
+    CheckOptions parseCheckOptions(int argc, char * argv[]) {
+        CheckOptions options;
+        std::vector<std::string> positional;
+        for (int iArg = 1; iArg < argc; ++iArg) {
+            std::string_view arg { argv[iArg] };
+            if (!arg.starts_with("--")) {
+                positional.emplace_back(arg);
+                continue;
+            }
+            std::string_view name = arg.substr(2);
+            std::string value;
+            if (auto eq = name.find('='); eq != std::string_view::npos) {
+                value = std::string(name.substr(eq + 1));
+                name = name.substr(0, eq);
+            }
+            if (name == "write-baseline") {
+                options.writeBaseline = true;
+                continue;
+            }
+            if (name == "allow-missing-baseline") {
+                options.allowMissingBaseline = true;
+                continue;
+            }
+            if (value.empty())
+                throw std::invalid_argument("--" + std::string(name) + " expects a value");
+            if (name == "baseline")
+                options.baseline = value;
+            else if (name == "repeat")
+                options.repeat = std::stoull(value);
+            else if (name == "threads")
+                options.threads = std::stoi(value);
+            else if (name == "tolerance")
+                options.tolerance = std::stod(value);
+            else if (name == "deviations")
+                options.deviations = std::stod(value);
+            else
+                throw std::invalid_argument("Unknown option --" + std::string(name));
+        }
+        if (positional.size() != 1)
+            throw std::invalid_argument("Expected an ensemble file");
+        if (options.repeat == 0)
+            throw std::invalid_argument("--repeat expects a positive number of measures");
+        if (options.threads < 1)
+            throw std::invalid_argument("--threads expects a positive number of threads");
+        if (options.tolerance < 0. || options.deviations < 0.)
+            throw std::invalid_argument("--tolerance and --deviations expect positive values");
+        options.input = positional[0];
+        return options;
+    }
+
+    /// Baseline, compared on the first process ; return the exit code
+    int checkBaseline(const CheckOptions & t_options, const Simulation::PerfBaseline & t_current) {
+        if (t_options.writeBaseline) {
+            std::ofstream output(t_options.baseline);
+            if (!output) {
+                std::cerr << "Cannot open " << t_options.baseline << std::endl;
+                return EXIT_FAILURE;
+            }
+            output << "# Written by perfCheck.exe --write-baseline (make perf-baseline)"
+                   << std::endl;
+            Simulation::writePerfBaseline(output, t_current);
+            std::cout << "Baseline written in " << t_options.baseline << std::endl;
+            return EXIT_SUCCESS;
+        }
+        // Les mesures de référence ne valent que pour la machine qui les a
+        // prises : le dépôt n'en fournit pas
+        if (!std::filesystem::exists(t_options.baseline)) {
+            (t_options.allowMissingBaseline ? std::cout : std::cerr)
+                << "No baseline in " << t_options.baseline
+                << " : nothing compared, write one with make perf-baseline on the reference "
+                   "machine"
+                << std::endl;
+            return t_options.allowMissingBaseline ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        Simulation::PerfBaseline baseline;
+        try {
+            baseline = Simulation::readPerfBaseline(t_options.baseline);
+        } catch (std::runtime_error & err) {
+            std::cerr << err.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        // Des mesures faites autrement ne sont pas comparables
+        if (baseline.nbProcesses != t_current.nbProcesses
+            || baseline.nbThreads != t_current.nbThreads
+            || baseline.precision != t_current.precision) {
+            std::cerr << "The baseline was measured with " << baseline.nbProcesses
+                      << " processes of " << baseline.nbThreads << " threads in "
+                      << baseline.precision << ", not " << t_current.nbProcesses
+                      << " processes of " << t_current.nbThreads << " threads in "
+                      << t_current.precision << " : write a new baseline" << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::size_t nbRegressions = 0;
+        for (const auto & comparison : Simulation::comparePerformance(
+                 baseline, t_current, t_options.tolerance, t_options.deviations)) {
+            std::cout << comparison << std::endl;
+            nbRegressions += comparison.isRegression() ? 1 : 0;
+        }
+        if (nbRegressions > 0) {
+            std::cout << nbRegressions << " performance regression(s) against "
+                      << t_options.baseline << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "No performance regression against " << t_options.baseline << std::endl;
+        return EXIT_SUCCESS;
+    }
+} // namespace
+
+int main(int argc, char * argv[]) {
+    int provided;
+    if (MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided) != MPI_SUCCESS)
+        return -1;
+    MPI_Comm comm = MPI_COMM_WORLD;
+    MPI_Comm_set_errhandler(comm, MPI_ERRORS_ARE_FATAL);
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    CheckOptions options;
+    Simulation::Ensemble ensemble;
+    try {
+        options = parseCheckOptions(argc, argv);
+    } catch (std::exception & err) {
+        if (rank == 0) {
+            std::cout << err.what() << std::endl;
+            printUsage(argv[0]);
+        }
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+    try {
+        ensemble = Simulation::readEnsemble(options.input);
+    } catch (std::runtime_error & err) {
+        if (rank == 0)
+            std::cerr << err.what() << std::endl;
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+    // Les mesures sont rangées sous le nom de leur simulation
+    std::set<std::string> names;
+    bool hasDuplicates = false;
+    for (const auto & run : ensemble.runs)
+        hasDuplicates = !names.insert(run.name).second || hasDuplicates;
+    bool hasSources = std::any_of(ensemble.scenarios.begin(), ensemble.scenarios.end(),
+                                  [](const Simulation::ScenarioSpec & t_spec) {
+                                      return !t_spec.emitters.empty() || !t_spec.sinks.empty()
+                                             || t_spec.maxAge > 0.;
+                                  });
+    if (hasDuplicates || (size > 1 && hasSources)) {
+        if (rank == 0)
+            std::cerr << (hasDuplicates ? "Each run needs its own name!"
+                                        : "Particle sources need a single process!")
+                      << std::endl;
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+    omp_set_num_threads(options.threads);
+
+    // Chaque simulation est mesurée plusieurs fois de suite par tous les
+    // processus ensemble
+    Simulation::PerfBaseline current;
+    current.nbProcesses = size;
+    current.nbThreads = options.threads;
+    current.precision = sizeof(Numeric::real) == sizeof(float) ? "float" : "double";
+    for (std::size_t iRun = 0; iRun < ensemble.runs.size(); ++iRun) {
+        std::vector<double> particleSamples, fieldSamples;
+        for (std::size_t iRepeat = 0; iRepeat < options.repeat; ++iRepeat) {
+            auto summary = Simulation::runEnsembleMember(ensemble, iRun, comm);
+            particleSamples.push_back(summary.updatesPerSecond);
+            fieldSamples.push_back(summary.fieldUpdatesPerSecond);
+        }
+        const auto & name = ensemble.runs[iRun].name;
+        auto particles = Simulation::measure(particleSamples);
+        current.entries.push_back({ name, "particle_updates_per_s", particles });
+        auto field = Simulation::measure(fieldSamples);
+        if (field.nbSamples > 0)
+            current.entries.push_back({ name, "field_updates_per_s", field });
+        if (rank == 0) {
+            std::cout << "[perf] " << name << " : " << particles.median * 1.E-6
+                      << " M particle updates/s (MAD " << particles.mad * 1.E-6 << ")";
+            if (field.nbSamples > 0)
+                std::cout << ", " << field.median * 1.E-6 << " M cell updates/s (MAD "
+                          << field.mad * 1.E-6 << ")";
+            std::cout << std::endl;
+        }
+    }
+
+    int status = rank == 0 ? checkBaseline(options, current) : EXIT_SUCCESS;
+    MPI_Bcast(&status, 1, MPI_INT, 0, comm);
+    MPI_Finalize();
+    return status;
+}
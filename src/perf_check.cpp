@@ -0,0 +1,142 @@
+#include "perf_check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+using namespace Simulation;
+
+namespace {
+    constexpr char baselineMagic[] = "vortex-perf-baseline";
+
+    double median(std::vector<double> & t_values) {
+        std::size_t half = t_values.size() / 2;
+        std::nth_element(t_values.begin(), t_values.begin() + half, t_values.end());
+        double upper = t_values[half];
+        if (t_values.size() % 2 == 1)
+            return upper;
+        double lower = *std::max_element(t_values.begin(), t_values.begin() + half);
+        return 0.5 * (lower + upper);
+    }
+} // namespace
+
+Measure Simulation::measure(std::vector<double> t_samples) {
+    std::erase_if(t_samples, [](double t_value) { return std::isnan(t_value); });
+    Measure result;
+    result.nbSamples = t_samples.size();
+    if (t_samples.empty())
+        return result;
+    result.median = median(t_samples);
+    for (double & value : t_samples)
+        value = std::abs(value - result.median);
+    result.mad = median(t_samples);
+    return result;
+}
+
+PerfBaseline Simulation::readPerfBaseline(const std::string & t_fileName) {
+    std::ifstream input(t_fileName);
+    if (!input)
+        throw std::runtime_error("Cannot open " + t_fileName);
+    std::size_t lineNumber = 0;
+    auto fail = [&](const std::string & t_message) {
+        throw std::runtime_error(t_fileName + ":" + std::to_string(lineNumber) + ": " + t_message);
+    };
+
+    PerfBaseline baseline;
+    bool hasHeader = false, hasSettings = false;
+    std::string text;
+    while (std::getline(input, text)) {
+        ++lineNumber;
+        std::istringstream line(text.substr(0, text.find('#')));
+        std::string key, extra;
+        if (!(line >> key))
+            continue;
+        if (!hasHeader) {
+            int version = 0;
+            if (key != baselineMagic || !(line >> version) || version != 1)
+                fail(std::string("expected ") + baselineMagic + " 1");
+            hasHeader = true;
+        } else if (key == "settings") {
+            if (!(line >> baseline.nbProcesses >> baseline.nbThreads >> baseline.precision)
+                || line >> extra)
+                fail("expected settings <processes> <threads> <precision>");
+            hasSettings = true;
+        } else {
+            PerfBaseline::Entry entry { key, {}, {} };
+            auto & measure = entry.measure;
+            if (!(line >> entry.metric >> measure.median >> measure.mad >> measure.nbSamples)
+                || line >> extra)
+                fail("expected <run> <metric> <median> <mad> <samples>");
+            baseline.entries.push_back(entry);
+        }
+    }
+    if (!hasSettings)
+        throw std::runtime_error(t_fileName + ": no settings");
+    return baseline;
+}
+
+void Simulation::writePerfBaseline(std::ostream & t_output, const PerfBaseline & t_baseline) {
+    t_output << baselineMagic << " 1" << std::endl
+             << "settings " << t_baseline.nbProcesses << ' ' << t_baseline.nbThreads << ' '
+             << t_baseline.precision << std::endl
+             << "# run metric median mad samples" << std::endl;
+    for (const auto & entry : t_baseline.entries)
+        t_output << entry.run << ' ' << entry.metric << ' ' << std::setprecision(6)
+                 << entry.measure.median << ' ' << entry.measure.mad << ' '
+                 << entry.measure.nbSamples << std::endl;
+}
+
+std::vector<PerfComparison> Simulation::comparePerformance(const PerfBaseline & t_baseline,
+                                                           const PerfBaseline & t_current,
+                                                           double t_tolerance,
+                                                           double t_nbDeviations) {
+    // Écart-type d'un bruit normal estimé par la MAD
+    constexpr double madToDeviation = 1.4826;
+    auto find = [](const PerfBaseline & t_set, const std::string & t_run,
+                   const std::string & t_metric) {
+        return std::find_if(t_set.entries.begin(), t_set.entries.end(), [&](const auto & entry) {
+            return entry.run == t_run && entry.metric == t_metric;
+        });
+    };
+    std::vector<PerfComparison> comparisons;
+    for (const auto & entry : t_baseline.entries) {
+        PerfComparison comparison { entry.run, entry.metric, entry.measure, {} };
+        auto found = find(t_current, entry.run, entry.metric);
+        comparison.isMissing = found == t_current.entries.end();
+        if (!comparison.isMissing) {
+            comparison.current = found->measure;
+            double deviation = madToDeviation * std::hypot(entry.measure.mad, found->measure.mad);
+            comparison.threshold =
+                std::max(t_tolerance * entry.measure.median, t_nbDeviations * deviation);
+        }
+        comparisons.push_back(comparison);
+    }
+    for (const auto & entry : t_current.entries) {
+        if (find(t_baseline, entry.run, entry.metric) != t_baseline.entries.end())
+            continue;
+        PerfComparison comparison { entry.run, entry.metric, {}, entry.measure };
+        comparison.isNew = true;
+        comparisons.push_back(comparison);
+    }
+    return comparisons;
+}
+
+std::ostream & Simulation::operator<<(std::ostream & os, const PerfComparison & t_comparison) {
+    std::ostringstream name;
+    name << t_comparison.run << ' ' << t_comparison.metric;
+    os << std::left << std::setw(40) << name.str() << std::right << std::setprecision(4);
+    if (t_comparison.isMissing)
+        return os << " baseline " << t_comparison.baseline.median << ", not measured : MISSING";
+    if (t_comparison.isNew)
+        return os << " current " << t_comparison.current.median << ", not in the baseline : NEW";
+    double change = t_comparison.current.median / t_comparison.baseline.median - 1.;
+    os << " baseline " << t_comparison.baseline.median << " current "
+       << t_comparison.current.median << " (" << std::showpos << std::fixed
+       << std::setprecision(1) << 100. * change << " %, threshold " << std::noshowpos
+       << -100. * t_comparison.threshold / t_comparison.baseline.median << " %)"
+       << std::defaultfloat << " : " << (t_comparison.isRegression() ? "REGRESSION" : "ok");
+    return os;
+}
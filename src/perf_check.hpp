@@ -0,0 +1,85 @@
+#ifndef _SIMULATION_PERF_CHECK_HPP_
+#define _SIMULATION_PERF_CHECK_HPP_
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Simulation {
+    /**
+     * @brief Median and median absolute deviation of repeated measures
+     *
+     * Unlike the mean and the standard deviation, they ignore a few outliers
+     * (first run with cold caches, another program waking up).
+     */
+    struct Measure {
+        double median = 0.;
+        double mad = 0.;
+        std::size_t nbSamples = 0;
+    };
+
+    /// Measure of the samples which are not NaN
+    Measure measure(std::vector<double> t_samples);
+
+    /**
+     * @brief Throughputs of a set of runs, and the settings they were
+     * measured with
+     *
+     * A baseline file starts with "vortex-perf-baseline 1", then holds the
+     * settings and one line per metric of a run ('#' starts a comment) :
+     *
+     *     settings <processes> <threads> <precision>
+     *     <run> <metric> <median> <mad> <samples>
+     */
+    struct PerfBaseline {
+        struct Entry {
+            std::string run, metric;
+            Measure measure;
+        };
+
+        int nbProcesses = 1;
+        int nbThreads = 1;
+        /// float or double, the precision of the particles and of the field
+        std::string precision;
+        std::vector<Entry> entries;
+    };
+
+    /**
+     * @brief Read a baseline file, throw std::runtime_error with the file
+     * and the line if it cannot be read or is malformed
+     */
+    PerfBaseline readPerfBaseline(const std::string & t_fileName);
+    void writePerfBaseline(std::ostream & t_output, const PerfBaseline & t_baseline);
+
+    /**
+     * @brief Comparison of a metric with its baseline
+     *
+     * The metric regresses when its median falls below the one of the
+     * baseline by more than the threshold : the largest of a relative
+     * tolerance and of a number of deviations of the difference, the
+     * deviation of each side being estimated by 1.4826 times its MAD (the
+     * standard deviation of a normal noise).
+     */
+    struct PerfComparison {
+        std::string run, metric;
+        Measure baseline, current;
+        double threshold = 0.;
+        bool isMissing = false; ///< Not measured by the current runs
+        bool isNew = false;     ///< Not in the baseline
+
+        bool isRegression() const {
+            return isMissing || (!isNew && current.median < baseline.median - threshold);
+        }
+    };
+
+    std::vector<PerfComparison> comparePerformance(const PerfBaseline & t_baseline,
+                                                   const PerfBaseline & t_current,
+                                                   double t_tolerance,
+                                                   double t_nbDeviations);
+
+    /// One line : metric, baseline, current, relative change and verdict
+    std::ostream & operator<<(std::ostream & os, const PerfComparison & t_comparison);
+} // namespace Simulation
+
+#endif
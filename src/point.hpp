@@ -28,6 +28,12 @@ namespace Geometry {
          * @param t_y The ordinate
          */
         Point(RealType t_x, RealType t_y) : x(t_x), y(t_y) {}
+        /**
+         * @brief Convert a point with another kind of real
+         */
+        template <typename OtherRealType>
+        explicit Point(const Point<OtherRealType> & t_point)
+            : x(RealType(t_point.x)), y(RealType(t_point.y)) {}
         /**
          * @brief Copy constructor
          *
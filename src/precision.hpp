@@ -0,0 +1,37 @@
+#ifndef _NUMERIC_PRECISION_HPP_
+#define _NUMERIC_PRECISION_HPP_
+
+#include <mpi.h>
+
+namespace Numeric {
+    /**
+     * @brief Kind of real used to store and advect the particles and the
+     * velocity field
+     *
+     * double by default, float when built with SINGLE_PRECISION defined
+     * (`make all SINGLE_PRECISION=1`). The vortices stay in double.
+     */
+#ifdef SINGLE_PRECISION
+    using real = float;
+#else
+    using real = double;
+#endif
+
+    /**
+     * @brief MPI datatype matching RealType
+     */
+    template <typename RealType>
+    MPI_Datatype mpiType();
+
+    template <>
+    inline MPI_Datatype mpiType<float>() {
+        return MPI_FLOAT;
+    }
+
+    template <>
+    inline MPI_Datatype mpiType<double>() {
+        return MPI_DOUBLE;
+    }
+} // namespace Numeric
+
+#endif
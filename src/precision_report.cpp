@@ -0,0 +1,110 @@
+#include "precision_report.hpp"
+
+#include "runge_kutta.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <omp.h>
+#include <utility>
+
+namespace {
+    // Pas de temps initial des modes interactifs
+    constexpr double dt = 0.1;
+    constexpr std::size_t particlesPerTask = 4096;
+
+    /**
+     * @brief Particles and velocity field advanced in a given precision
+     */
+    template <typename RealType>
+    struct Path {
+        using point = typename Geometry::BasicCloudOfPoints<RealType>::point;
+
+        Numeric::BasicCartesianGridOfSpeed<RealType> grid;
+        Geometry::BasicCloudOfPoints<RealType> points, newPoints;
+        double seconds = 0.;
+
+        Path(const Numeric::CartesianGridOfSpeed & t_grid,
+             const Geometry::CloudOfPoints & t_cloud,
+             const Simulation::Vortices & t_vortices)
+            : grid(t_grid.cellGeometry(), t_grid.getLeftBottomVertex(), t_grid.getStep()),
+              points(t_cloud.numberOfPoints()),
+              newPoints(t_cloud.numberOfPoints()) {
+            for (std::size_t iPoint = 0; iPoint < t_cloud.numberOfPoints(); ++iPoint)
+                points[iPoint] = point { t_cloud[iPoint] };
+            grid.updateVelocityField(t_vortices);
+        }
+
+        void advect(Numeric::Scheme t_scheme) {
+            std::size_t nbPoints = points.numberOfPoints();
+            double t0 = omp_get_wtime();
+#pragma omp parallel for schedule(static)
+            for (std::size_t first = 0; first < nbPoints; first += particlesPerTask) {
+                Numeric::solve_particles(t_scheme, dt, grid, points, newPoints, first,
+                                         std::min(first + particlesPerTask, nbPoints));
+            }
+            seconds += omp_get_wtime() - t0;
+            std::swap(points, newPoints);
+        }
+    };
+} // namespace
+
+int runPrecisionReport(std::size_t t_nbSteps,
+                       Numeric::Scheme t_scheme,
+                       Simulation::Vortices t_vortices,
+                       bool isMobile,
+                       const Numeric::CartesianGridOfSpeed & t_grid,
+                       const Geometry::CloudOfPoints & t_cloud) {
+    Path<float> single(t_grid, t_cloud, t_vortices);
+    Path<double> reference(t_grid, t_cloud, t_vortices);
+
+    std::size_t nbPoints = t_cloud.numberOfPoints();
+    double width = t_grid.getRightTopVertex().x - t_grid.getLeftBottomVertex().x;
+    double height = t_grid.getRightTopVertex().y - t_grid.getLeftBottomVertex().y;
+    double h = t_grid.getStep();
+    std::size_t reportEvery = std::max<std::size_t>(1, t_nbSteps / 10);
+
+    std::cout << "Precision report : " << nbPoints << " particles, " << t_nbSteps
+              << " steps of dt = " << dt << " (" << Numeric::schemeName(t_scheme)
+              << "), distances between the float and the double "
+              << "trajectories" << std::endl;
+    auto flags = std::cout.flags();
+    std::cout << std::scientific << std::setprecision(3);
+
+    for (std::size_t iStep = 1; iStep <= t_nbSteps; ++iStep) {
+        single.advect(t_scheme);
+        reference.advect(t_scheme);
+        if (isMobile) {
+            Numeric::solve_vortices(t_scheme, dt, t_grid, t_vortices);
+            single.grid.updateVelocityField(t_vortices);
+            reference.grid.updateVelocityField(t_vortices);
+        }
+
+        if (iStep % reportEvery != 0 && iStep != t_nbSteps)
+            continue;
+        double maxDist = 0., sumSqrDist = 0.;
+#pragma omp parallel for reduction(max : maxDist) reduction(+ : sumSqrDist)
+        for (std::size_t iPoint = 0; iPoint < nbPoints; ++iPoint) {
+            // Distance sur le tore
+            double dx = std::abs(double(single.points[iPoint].x) - reference.points[iPoint].x);
+            double dy = std::abs(double(single.points[iPoint].y) - reference.points[iPoint].y);
+            dx = std::min(dx, width - dx);
+            dy = std::min(dy, height - dy);
+            double sqrDist = dx * dx + dy * dy;
+            maxDist = std::max(maxDist, std::sqrt(sqrDist));
+            sumSqrDist += sqrDist;
+        }
+        double rmsDist = nbPoints > 0 ? std::sqrt(sumSqrDist / nbPoints) : 0.;
+        std::cout << "step " << iStep << " : max " << maxDist << " (" << maxDist / h
+                  << " h), rms " << rmsDist << " (" << rmsDist / h << " h)" << std::endl;
+    }
+
+    std::cout << std::fixed << std::setprecision(3) << "advection time per step : float "
+              << 1.E3 * single.seconds / t_nbSteps << " ms, double "
+              << 1.E3 * reference.seconds / t_nbSteps << " ms (speedup "
+              << reference.seconds / single.seconds << ")" << std::endl;
+    std::cout.flags(flags);
+    return EXIT_SUCCESS;
+}
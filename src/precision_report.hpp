@@ -0,0 +1,31 @@
+#ifndef _PRECISION_REPORT_HPP_
+#define _PRECISION_REPORT_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "cloud_of_points.hpp"
+#include "scheme.hpp"
+#include "vortex.hpp"
+
+/**
+ * @brief Compare the trajectories of the particles in single and in double
+ * precision
+ *
+ * The particles are advected over t_nbSteps time steps twice, with the
+ * particles and the velocity field stored in float and in double. The
+ * vortices (always in double) are shared by both paths, so the differences
+ * only come from the precision of the particles and of the interpolation.
+ * Every few steps, the distance between the two positions of each particle
+ * is printed (maximum and root mean square, also relative to the step of the
+ * grid), along with the time spent advecting the particles in each precision.
+ *
+ * Runs in a single process, without display nor MPI.
+ *
+ * @return The exit code of the program
+ */
+int runPrecisionReport(std::size_t t_nbSteps,
+                       Numeric::Scheme t_scheme,
+                       Simulation::Vortices t_vortices,
+                       bool isMobile,
+                       const Numeric::CartesianGridOfSpeed & t_grid,
+                       const Geometry::CloudOfPoints & t_cloud);
+
+#endif
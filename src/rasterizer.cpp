@@ -0,0 +1,312 @@
+#include "rasterizer.hpp"
+
+#include "tracer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <omp.h>
+
+using namespace Graphisme;
+
+std::vector<std::uint8_t> Graphisme::ftleColors(const Numeric::FtleField & t_ftle) {
+    double maxValue = 0.;
+    for (double value : t_ftle.values)
+        maxValue = std::max(maxValue, value);
+    std::vector<std::uint8_t> pixels(4 * t_ftle.values.size());
+#pragma omp parallel for
+    for (std::size_t iSeed = 0; iSeed < t_ftle.values.size(); ++iSeed) {
+        // Noir -> rouge -> jaune -> blanc
+        double level = maxValue > 0. ? 3. * std::max(0., t_ftle.values[iSeed]) / maxValue : 0.;
+        pixels[4 * iSeed + 0] = std::uint8_t(255 * std::clamp(level, 0., 1.));
+        pixels[4 * iSeed + 1] = std::uint8_t(255 * std::clamp(level - 1., 0., 1.));
+        pixels[4 * iSeed + 2] = std::uint8_t(255 * std::clamp(level - 2., 0., 1.));
+        pixels[4 * iSeed + 3] = 255;
+    }
+    return pixels;
+}
+
+namespace {
+    double meanSpeed(const Numeric::CartesianGridOfSpeed & t_grid) {
+        auto nbCells = t_grid.cellGeometry();
+        double sum = 0.;
+#pragma omp parallel for reduction(+ : sum)
+        for (std::size_t jy = 0; jy < nbCells.second; ++jy) {
+            for (std::size_t ix = 0; ix < nbCells.first; ++ix) {
+                auto velocity = t_grid.getVelocity(jy, ix);
+                sum += std::hypot(double(velocity.x), double(velocity.y));
+            }
+        }
+        std::size_t nbValues = nbCells.first * nbCells.second;
+        return nbValues > 0 ? sum / nbValues : 0.;
+    }
+} // namespace
+
+std::vector<std::uint8_t>
+Graphisme::velocityColors(const Numeric::CartesianGridOfSpeed & t_grid) {
+    auto nbCells = t_grid.cellGeometry();
+    double mean = meanSpeed(t_grid);
+    std::vector<std::uint8_t> pixels(4 * nbCells.first * nbCells.second);
+#pragma omp parallel for
+    for (std::size_t jy = 0; jy < nbCells.second; ++jy) {
+        for (std::size_t ix = 0; ix < nbCells.first; ++ix) {
+            auto velocity = t_grid.getVelocity(jy, ix);
+            double vx = velocity.x, vy = velocity.y;
+            double magnitude = std::hypot(vx, vy);
+            double brightness = magnitude > 0. ? magnitude / (magnitude + mean) : 0.;
+            // Teinte (TSV, saturation maximale) selon la direction
+            double hue = 3. * (std::atan2(vy, vx) / M_PI + 1.); // Dans [0, 6]
+            std::uint8_t * pixel = pixels.data() + 4 * (jy * nbCells.first + ix);
+            for (int iChannel = 0; iChannel < 3; ++iChannel) {
+                // Rouge, vert, bleu : pics de teinte en 0, 2 et 4 (modulo 6)
+                double distance = std::fmod(std::abs(hue - 2. * iChannel), 6.);
+                distance = std::min(distance, 6. - distance);
+                double level = std::clamp(2. - distance, 0., 1.);
+                pixel[iChannel] = std::uint8_t(std::lround(255. * brightness * level));
+            }
+            pixel[3] = 255;
+        }
+    }
+    return pixels;
+}
+
+std::vector<FieldArrow> Graphisme::velocityArrows(const Numeric::CartesianGridOfSpeed & t_grid,
+                                                  std::size_t t_nbArrows) {
+    std::vector<FieldArrow> arrows;
+    auto nbCells = t_grid.cellGeometry();
+    if (t_nbArrows == 0 || nbCells.first == 0 || nbCells.second == 0)
+        return arrows;
+    std::size_t stride = (std::max(nbCells.first, nbCells.second) + t_nbArrows - 1) / t_nbArrows;
+    double mean = meanSpeed(t_grid);
+    double maxLength = 0.9 * stride;
+    // Une flèche au milieu de chaque bloc de stride x stride cellules
+    for (std::size_t jy = stride / 2; jy < nbCells.second; jy += stride) {
+        for (std::size_t ix = stride / 2; ix < nbCells.first; ix += stride) {
+            auto velocity = t_grid.getVelocity(jy, ix);
+            double vx = velocity.x, vy = velocity.y;
+            double magnitude = std::hypot(vx, vy);
+            double scale = magnitude > 0. ? maxLength / (magnitude + mean) : 0.;
+            arrows.push_back({ ix + 0.5, jy + 0.5, scale * vx, scale * vy });
+        }
+    }
+    return arrows;
+}
+
+Rasterizer::Rasterizer(const std::pair<std::size_t, std::size_t> & t_geometry)
+    : m_width(t_geometry.first), m_height(t_geometry.second) {}
+
+Rasterizer::View Rasterizer::makeView(double t_viewportLeft) const {
+    // Mêmes vues que Screen : (W/2) x (H-128) unités affichées dans 48 % de
+    // la largeur et 80 % de la hauteur de l'image
+    double viewWidth = 0.5 * m_width, viewHeight = double(m_height) - 128.;
+    View view;
+    view.left = t_viewportLeft * m_width;
+    view.top = 0.05 * m_height;
+    view.sx = 0.48 * m_width / viewWidth;
+    view.sy = 0.8 * m_height / viewHeight;
+    view.width = std::size_t(viewWidth) - 1.;
+    view.height = std::size_t(viewHeight) - 1.;
+    view.x0 = std::size_t(view.left);
+    view.y0 = std::size_t(view.top);
+    view.x1 = std::min(m_width, std::size_t(view.left + 0.48 * m_width));
+    view.y1 = std::min(m_height, std::size_t(view.top + 0.8 * m_height));
+    return view;
+}
+
+namespace {
+    inline void plot(std::uint8_t * t_pixel, std::uint8_t r, std::uint8_t g, std::uint8_t b,
+                     std::uint8_t a) {
+        if (a == 255) {
+            t_pixel[0] = r;
+            t_pixel[1] = g;
+            t_pixel[2] = b;
+        } else {
+            // Mélange avec le fond, comme sf::BlendAlpha
+            t_pixel[0] = std::uint8_t((r * a + t_pixel[0] * (255 - a)) / 255);
+            t_pixel[1] = std::uint8_t((g * a + t_pixel[1] * (255 - a)) / 255);
+            t_pixel[2] = std::uint8_t((b * a + t_pixel[2] * (255 - a)) / 255);
+        }
+        t_pixel[3] = 255;
+    }
+} // namespace
+
+void Rasterizer::drawLine(const View & t_view,
+                          double xa,
+                          double ya,
+                          Color ca,
+                          double xb,
+                          double yb,
+                          Color cb,
+                          std::uint8_t * t_pixels) const {
+    double pxa = t_view.left + t_view.sx * xa, pya = t_view.top + t_view.sy * ya;
+    double pxb = t_view.left + t_view.sx * xb, pyb = t_view.top + t_view.sy * yb;
+    double length = std::max(std::abs(pxb - pxa), std::abs(pyb - pya));
+    std::size_t nbSteps = std::max<std::size_t>(1, std::size_t(std::ceil(length)));
+    for (std::size_t iStep = 0; iStep <= nbSteps; ++iStep) {
+        double t = double(iStep) / nbSteps;
+        double x = std::floor(pxa + t * (pxb - pxa)), y = std::floor(pya + t * (pyb - pya));
+        if (x < t_view.x0 || x >= t_view.x1 || y < t_view.y0 || y >= t_view.y1)
+            continue;
+        // Couleur interpolée le long du segment
+        auto mix = [t](std::uint8_t a, std::uint8_t b) {
+            return std::uint8_t(std::lround(a + t * (double(b) - a)));
+        };
+        plot(t_pixels + 4 * (std::size_t(y) * m_width + std::size_t(x)), mix(ca.r, cb.r),
+             mix(ca.g, cb.g), mix(ca.b, cb.b), mix(ca.a, cb.a));
+    }
+}
+
+void Rasterizer::drawVortices(const View & t_view,
+                              const Numeric::CartesianGridOfSpeed & t_grid,
+                              const Simulation::Vortices & t_vortices,
+                              std::uint8_t * t_pixels) const {
+    auto bottomLeft = t_grid.getLeftBottomVertex(), topRight = t_grid.getRightTopVertex();
+    double scalex = t_view.width / (topRight.x - bottomLeft.x);
+    double scaley = t_view.height / (topRight.y - bottomLeft.y);
+    // Disques de rayon 5 (unités de la vue), comme sf::CircleShape { 5 }
+    double rx = 5. * t_view.sx, ry = 5. * t_view.sy;
+    for (std::size_t iVort = 0; iVort < t_vortices.numberOfVortices(); ++iVort) {
+        auto c = t_vortices.getCenter(iVort);
+        double cx = t_view.left + t_view.sx * scalex * (c.x - bottomLeft.x);
+        double cy = t_view.top + t_view.sy * scaley * (c.y - bottomLeft.y);
+        std::size_t xMin = std::max(double(t_view.x0), std::floor(cx - rx));
+        std::size_t yMin = std::max(double(t_view.y0), std::floor(cy - ry));
+        std::size_t xMax = std::min(double(t_view.x1), std::ceil(cx + rx));
+        std::size_t yMax = std::min(double(t_view.y1), std::ceil(cy + ry));
+        for (std::size_t y = yMin; y < yMax; ++y) {
+            for (std::size_t x = xMin; x < xMax; ++x) {
+                double dx = (x + 0.5 - cx) / rx, dy = (y + 0.5 - cy) / ry;
+                if (dx * dx + dy * dy <= 1.)
+                    plot(t_pixels + 4 * (y * m_width + x), 255, 0, 0, 255);
+            }
+        }
+    }
+}
+
+void Rasterizer::drawTexels(const View & t_view,
+                            const Numeric::CartesianGridOfSpeed & t_grid,
+                            const std::vector<std::uint8_t> & t_colors,
+                            std::size_t t_columns,
+                            std::size_t t_rows,
+                            double t_hx,
+                            double t_hy,
+                            std::uint8_t * t_pixels) const {
+    auto bottomLeft = t_grid.getLeftBottomVertex(), topRight = t_grid.getRightTopVertex();
+    // Taille d'un texel en pixels, la première ligne de texels en haut
+    double texelWidth = t_view.sx * t_view.width / (topRight.x - bottomLeft.x) * t_hx;
+    double texelHeight = t_view.sy * t_view.height / (topRight.y - bottomLeft.y) * t_hy;
+#pragma omp parallel for
+    for (std::size_t y = t_view.y0; y < t_view.y1; ++y) {
+        double row = std::floor((y + 0.5 - t_view.top) / texelHeight);
+        if (row < 0. || row >= t_rows)
+            continue;
+        for (std::size_t x = t_view.x0; x < t_view.x1; ++x) {
+            double col = std::floor((x + 0.5 - t_view.left) / texelWidth);
+            if (col < 0. || col >= t_columns)
+                continue;
+            const std::uint8_t * color =
+                t_colors.data() + 4 * (std::size_t(row) * t_columns + std::size_t(col));
+            std::memcpy(t_pixels + 4 * (y * m_width + x), color, 4);
+        }
+    }
+}
+
+void Rasterizer::drawVelocityField(const View & t_view,
+                                   const Numeric::CartesianGridOfSpeed & t_grid,
+                                   std::uint8_t * t_pixels) {
+    // Couleurs et flèches recalculées seulement quand le champ a changé
+    if (!m_hasField || m_fieldGeneration != t_grid.generation()) {
+        m_fieldColors = velocityColors(t_grid);
+        m_arrows = velocityArrows(t_grid, m_nbArrows);
+        m_fieldGeneration = t_grid.generation();
+        m_hasField = true;
+    }
+    auto bottomLeft = t_grid.getLeftBottomVertex(), topRight = t_grid.getRightTopVertex();
+    auto nbCells = t_grid.cellGeometry();
+    drawTexels(t_view, t_grid, m_fieldColors, nbCells.first, nbCells.second, t_grid.getStep(),
+               t_grid.getStep(), t_pixels);
+
+    double hx = t_grid.getStep() * t_view.width / (topRight.x - bottomLeft.x);
+    double hy = t_grid.getStep() * t_view.height / (topRight.y - bottomLeft.y);
+    Color tail { 0, 0, 127 }, head { 255, 255, 255 };
+    for (const auto & arrow : m_arrows)
+        drawLine(t_view, arrow.x * hx, arrow.y * hy, tail, (arrow.x + arrow.dx) * hx,
+                 (arrow.y + arrow.dy) * hy, head, t_pixels);
+}
+
+void Rasterizer::drawFtle(const View & t_view,
+                          const Numeric::CartesianGridOfSpeed & t_grid,
+                          const Numeric::FtleField & t_ftle,
+                          std::uint8_t * t_pixels) {
+    if (m_ftleColors.size() != 4 * t_ftle.values.size())
+        m_ftleColors = ftleColors(t_ftle);
+    drawTexels(t_view, t_grid, m_ftleColors, t_ftle.width, t_ftle.height, t_ftle.hx, t_ftle.hy,
+               t_pixels);
+}
+
+void Rasterizer::drawParticles(const View & t_view,
+                               const Numeric::CartesianGridOfSpeed & t_grid,
+                               const Geometry::CloudOfPoints & t_cloud,
+                               std::uint8_t * t_pixels) const {
+    auto bottomLeft = t_grid.getLeftBottomVertex(), topRight = t_grid.getRightTopVertex();
+    double scalex = t_view.sx * t_view.width / (topRight.x - bottomLeft.x);
+    double scaley = t_view.sy * t_view.height / (topRight.y - bottomLeft.y);
+    // Particules en blanc à moitié transparent, comme dans Screen
+    for (std::size_t iPt = 0; iPt < t_cloud.numberOfPoints(); ++iPt) {
+        double x = std::floor(t_view.left + scalex * (t_cloud[iPt].x - bottomLeft.x));
+        double y = std::floor(t_view.top + scaley * (t_cloud[iPt].y - bottomLeft.y));
+        if (x < t_view.x0 || x >= t_view.x1 || y < t_view.y0 || y >= t_view.y1)
+            continue;
+        plot(t_pixels + 4 * (std::size_t(y) * m_width + std::size_t(x)), 255, 255, 255, 128);
+    }
+}
+
+void Rasterizer::drawTrails(const View & t_view,
+                            const Numeric::CartesianGridOfSpeed & t_grid,
+                            const Geometry::CloudOfPoints & t_cloud,
+                            std::uint8_t * t_pixels) {
+    double t0 = omp_get_wtime();
+    m_trails->record(t_cloud, t_grid);
+    auto bottomLeft = t_grid.getLeftBottomVertex(), topRight = t_grid.getRightTopVertex();
+    double scalex = t_view.width / (topRight.x - bottomLeft.x);
+    double scaley = t_view.height / (topRight.y - bottomLeft.y);
+    for (const auto & segment : m_trails->segments()) {
+        if (segment.alpha == 0)
+            continue;
+        Color color { 0, 191, 255, segment.alpha };
+        drawLine(t_view, scalex * (segment.a.x - bottomLeft.x),
+                 scaley * (segment.a.y - bottomLeft.y), color,
+                 scalex * (segment.b.x - bottomLeft.x), scaley * (segment.b.y - bottomLeft.y),
+                 color, t_pixels);
+    }
+    m_trailsTiming = m_trails->timing();
+    m_trailsTiming.seconds = omp_get_wtime() - t0;
+}
+
+void Rasterizer::render(const Numeric::CartesianGridOfSpeed & t_grid,
+                        const Simulation::Vortices & t_vortices,
+                        const Geometry::CloudOfPoints & t_cloud,
+                        const Numeric::FtleField * t_ftle,
+                        std::uint8_t * t_pixels) {
+    Trace::Scope scope("rasterize", "render");
+    // Fond noir opaque
+    std::size_t nbPixels = m_width * m_height;
+#pragma omp parallel for
+    for (std::size_t iPixel = 0; iPixel < nbPixels; ++iPixel) {
+        t_pixels[4 * iPixel + 0] = 0;
+        t_pixels[4 * iPixel + 1] = 0;
+        t_pixels[4 * iPixel + 2] = 0;
+        t_pixels[4 * iPixel + 3] = 255;
+    }
+
+    View left = makeView(0.01), right = makeView(0.51);
+    if (t_ftle)
+        drawFtle(left, t_grid, *t_ftle, t_pixels);
+    else
+        drawVelocityField(left, t_grid, t_pixels);
+    drawVortices(left, t_grid, t_vortices, t_pixels);
+    if (m_trails)
+        drawTrails(right, t_grid, t_cloud, t_pixels);
+    drawParticles(right, t_grid, t_cloud, t_pixels);
+    drawVortices(right, t_grid, t_vortices, t_pixels);
+}
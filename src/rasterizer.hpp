@@ -0,0 +1,167 @@
+#ifndef _GRAPHISM_RASTERIZER_HPP_
+#define _GRAPHISM_RASTERIZER_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "cloud_of_points.hpp"
+#include "ftle.hpp"
+#include "particle_trails.hpp"
+#include "vortex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace Graphisme {
+    /**
+     * @brief RGBA color of each seed of a FTLE field, from black (FTLE <= 0)
+     * to white (largest FTLE) through red and yellow
+     */
+    std::vector<std::uint8_t> ftleColors(const Numeric::FtleField & t_ftle);
+
+    /**
+     * @brief RGBA color of each cell of a velocity field, row by row : the
+     * hue gives the direction of the velocity and the brightness its
+     * magnitude
+     *
+     * A magnitude m is shown as m / (m + mean magnitude), so that the slow
+     * regions stay visible next to the cores of the vortices.
+     */
+    std::vector<std::uint8_t> velocityColors(const Numeric::CartesianGridOfSpeed & t_grid);
+
+    /// Arrow drawn over a velocity field, in cell units from the first cell
+    struct FieldArrow {
+        double x, y;   ///< Origin, at the center of a cell
+        double dx, dy; ///< Direction and length
+    };
+    /**
+     * @brief Decimated arrows of a velocity field : one arrow per square
+     * block of cells, at most t_nbArrows blocks per row and per column
+     *
+     * The length of an arrow grows with the magnitude as the brightness of
+     * velocityColors, up to nine tenths of a block. No arrow if t_nbArrows
+     * is zero.
+     */
+    std::vector<FieldArrow> velocityArrows(const Numeric::CartesianGridOfSpeed & t_grid,
+                                           std::size_t t_nbArrows);
+
+    /**
+     * @brief Software renderer of the frames of the simulation, for nodes
+     * without display
+     *
+     * Draws the same picture as Screen (velocity field or FTLE field on the
+     * left half, particles on the right half, same views and colors) in a
+     * RGBA buffer in memory, without OpenGL context nor window. The status
+     * text is not drawn.
+     */
+    class Rasterizer {
+    public:
+        /**
+         * @param t_geometry Size of the frames, in pixels
+         */
+        explicit Rasterizer(const std::pair<std::size_t, std::size_t> & t_geometry);
+
+        std::size_t width() const { return m_width; }
+        std::size_t height() const { return m_height; }
+
+        /// Number of arrows per row drawn over the velocity field (0 : none)
+        void setFieldArrows(std::size_t t_nbArrows) {
+            m_nbArrows = t_nbArrows;
+            m_hasField = false;
+        }
+        /// Draw trails behind t_nbTrails particles, as Screen::setTrails
+        void setTrails(std::size_t t_nbTrails, std::size_t t_length) {
+            if (t_nbTrails == 0)
+                m_trails.reset();
+            else
+                m_trails.emplace(t_nbTrails, t_length);
+        }
+        /**
+         * @brief Cost of the last drawing of the trails (record and lines),
+         * nullptr without trails
+         */
+        const ParticleTrails::Timing * trailsTiming() const {
+            return m_trails ? &m_trailsTiming : nullptr;
+        }
+
+        /**
+         * @brief Draw a frame in t_pixels (4 * width() * height() bytes, row
+         * by row from the top)
+         *
+         * @param t_ftle If not null, FTLE field drawn in place of the
+         * velocity field
+         */
+        void render(const Numeric::CartesianGridOfSpeed & t_grid,
+                    const Simulation::Vortices & t_vortices,
+                    const Geometry::CloudOfPoints & t_cloud,
+                    const Numeric::FtleField * t_ftle,
+                    std::uint8_t * t_pixels);
+
+    private:
+        struct Color {
+            std::uint8_t r, g, b, a = 255;
+        };
+        /// Part of the image showing a view of the domain (see Screen)
+        struct View {
+            double left, top;           ///< Pixel of the origin of the view
+            double sx, sy;              ///< Pixels per unit of the view
+            double width, height;       ///< Drawn area of the view, in its units
+            std::size_t x0, y0, x1, y1; ///< Clipping rectangle, in pixels
+        };
+
+        View makeView(double t_viewportLeft) const;
+        void drawLine(const View & t_view,
+                      double xa,
+                      double ya,
+                      Color ca,
+                      double xb,
+                      double yb,
+                      Color cb,
+                      std::uint8_t * t_pixels) const;
+        void drawVortices(const View & t_view,
+                          const Numeric::CartesianGridOfSpeed & t_grid,
+                          const Simulation::Vortices & t_vortices,
+                          std::uint8_t * t_pixels) const;
+        /**
+         * @brief Draw an image of t_columns x t_rows texels (t_colors), a
+         * texel covering t_hx x t_hy units of the domain
+         */
+        void drawTexels(const View & t_view,
+                        const Numeric::CartesianGridOfSpeed & t_grid,
+                        const std::vector<std::uint8_t> & t_colors,
+                        std::size_t t_columns,
+                        std::size_t t_rows,
+                        double t_hx,
+                        double t_hy,
+                        std::uint8_t * t_pixels) const;
+        void drawVelocityField(const View & t_view,
+                               const Numeric::CartesianGridOfSpeed & t_grid,
+                               std::uint8_t * t_pixels);
+        void drawFtle(const View & t_view,
+                      const Numeric::CartesianGridOfSpeed & t_grid,
+                      const Numeric::FtleField & t_ftle,
+                      std::uint8_t * t_pixels);
+        void drawParticles(const View & t_view,
+                           const Numeric::CartesianGridOfSpeed & t_grid,
+                           const Geometry::CloudOfPoints & t_cloud,
+                           std::uint8_t * t_pixels) const;
+        void drawTrails(const View & t_view,
+                        const Numeric::CartesianGridOfSpeed & t_grid,
+                        const Geometry::CloudOfPoints & t_cloud,
+                        std::uint8_t * t_pixels);
+
+        std::size_t m_width, m_height;
+        /// Colors of the FTLE field, computed at its first display
+        std::vector<std::uint8_t> m_ftleColors;
+        /// Colors and arrows of the velocity field of generation m_fieldGeneration
+        std::vector<std::uint8_t> m_fieldColors;
+        std::vector<FieldArrow> m_arrows;
+        std::uint64_t m_fieldGeneration = 0;
+        bool m_hasField = false;
+        std::size_t m_nbArrows = 32;
+        std::optional<ParticleTrails> m_trails;
+        ParticleTrails::Timing m_trailsTiming;
+    };
+} // namespace Graphisme
+
+#endif
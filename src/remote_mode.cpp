@@ -0,0 +1,176 @@
+#include "remote_mode.hpp"
+
+#include "frame_socket.hpp"
+#include "interactive.hpp"
+#include "mixing_statistics.hpp"
+#include "screen.hpp"
+#include "session_log.hpp"
+#include "step_pipeline.hpp"
+#include "tracer.hpp"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <omp.h>
+#include <optional>
+
+namespace {
+    volatile std::sig_atomic_t s_isStopRequested = 0;
+
+    extern "C" void requestStop(int) { s_isStopRequested = 1; }
+} // namespace
+
+int runServer(const Options & t_options,
+              Simulation::Vortices t_vortices,
+              bool isMobile,
+              Numeric::CartesianGridOfSpeed t_grid,
+              Geometry::CloudOfPoints t_cloud,
+              Simulation::ParticleSources t_sources) {
+    Numeric::StepPipeline pipeline;
+    pipeline.setScheme(t_options.scheme);
+    pipeline.setTimeInterpolation(t_options.interpolateField);
+    pipeline.setVelocitySource(t_options.particleVelocity);
+    pipeline.setLazyField(t_options.lazyField);
+    t_grid.setTiledLayout(t_options.tiledField);
+    if (t_sources.isActive())
+        pipeline.setSources(&t_sources);
+    std::optional<Simulation::MixingStatistics> statistics;
+    std::optional<Simulation::MixingLog> mixingLog;
+    if (t_options.mixingPeriod > 0) {
+        statistics.emplace(t_cloud, t_grid, t_options.mixingPeriod);
+        mixingLog.emplace(t_options.mixingLog, t_options.mixingHistogram);
+        pipeline.setMixingStatistics(&*statistics);
+    }
+    std::optional<Simulation::SessionRecorder> recorder;
+    if (!t_options.recordSession.empty())
+        recorder.emplace(t_options.recordSession);
+
+    std::optional<Simulation::FrameServer> server;
+    try {
+        // Les sources ne remplissent jamais le nuage au-delà de leur capacité
+        server.emplace(Simulation::SocketAddress::parse(t_options.serve),
+                       t_grid,
+                       t_vortices.numberOfVortices(),
+                       std::max(t_cloud.numberOfPoints(), t_sources.capacity()));
+    } catch (std::exception & err) {
+        std::cerr << err.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Serving frames on " << t_options.serve << ", stop with Ctrl-C" << std::endl;
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    Trace::setThreadName("main");
+    // Les spectateurs lancent l'animation
+    SimulationControl control;
+    double time = 0.;
+    std::size_t iStep = 0;
+    auto publish = [&](bool t_hasField) {
+        Simulation::FrameHeader header;
+        header.step = iStep;
+        header.dt = control.dt;
+        header.time = time;
+        header.hasField = t_hasField;
+        server->publish(header, t_vortices, t_grid, t_cloud);
+    };
+    std::size_t nbViewers = 0;
+    double start = omp_get_wtime();
+    std::deque<UiEvent> orders;
+    while (!s_isStopRequested) {
+        control.advance = false;
+        // En pause, l'attente des ordres ne consomme pas de temps de calcul
+        for (UiEvent order : server->poll(control.mustStep() || !orders.empty() ? 0 : 50))
+            orders.push_back(order);
+        // Un ordre par itération, comme au clavier : deux Advance font deux pas
+        if (!orders.empty()) {
+            control.apply(orders.front());
+            if (recorder)
+                recorder->record(iStep, orders.front());
+            orders.pop_front();
+        }
+        if (server->nbViewers() != nbViewers) {
+            nbViewers = server->nbViewers();
+            std::cout << nbViewers << " viewer(s) connected at step " << iStep << std::endl;
+        }
+        if (server->wantsFrame()) {
+            t_grid.completeVelocityField();
+            publish(true);
+        }
+        if (!control.mustStep())
+            continue;
+
+        ++iStep;
+        time += control.dt;
+        // Sans spectateur, aucune image n'est préparée
+        bool isFrame = server->hasViewers()
+                       && (control.advance || iStep % t_options.frameInterval == 0);
+        pipeline.step(control.dt, t_grid, t_vortices, t_cloud, isMobile, isFrame);
+        if (isFrame)
+            publish(isMobile);
+        if (mixingLog)
+            mixingLog->write(*statistics);
+        if (t_options.timings)
+            std::cout << "[timings] step " << iStep << " : " << pipeline.timings() << std::endl;
+    }
+    std::cout << iStep << " steps computed in " << omp_get_wtime() - start << " s, "
+              << server->nbSent() << " frames sent (" << server->nbDropped() << " dropped) to "
+              << server->nbConnections() << " viewer connection(s)" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int runRemoteViewer(const Options & t_options) {
+    std::optional<Simulation::FrameClient> client;
+    try {
+        client.emplace(Simulation::SocketAddress::parse(t_options.connect));
+    } catch (std::exception & err) {
+        std::cerr << err.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    printKeyboardHelp();
+
+    const auto & geometry = client->geometry();
+    Numeric::CartesianGridOfSpeed grid({ geometry.width, geometry.height },
+                                       { geometry.left, geometry.bottom }, geometry.step);
+    Simulation::Vortices vortices;
+    Geometry::CloudOfPoints cloud;
+    Graphisme::Screen myScreen({ t_options.resx, t_options.resy },
+                               { grid.getLeftBottomVertex(), grid.getRightTopVertex() });
+    myScreen.setFieldArrows(t_options.fieldArrows);
+    myScreen.setTrails(t_options.trails, t_options.trailLength);
+    Trace::setThreadName("display");
+
+    bool hasFrame = false;
+    while (myScreen.isOpen()) {
+        auto start = std::chrono::system_clock::now();
+        sf::Event event;
+        {
+            Trace::Scope scope("poll events", "ui");
+            while (myScreen.pollEvent(event)) {
+                UiEvent ui_event = translateEvent(myScreen, event);
+                if (ui_event == UiEvent::Noop)
+                    continue;
+                client->send(ui_event);
+                if (ui_event == UiEvent::CloseWindow)
+                    myScreen.close();
+            }
+        }
+        if (!myScreen.isOpen())
+            break;
+        try {
+            // Sans nouvelle image, la boucle ne tourne pas à vide
+            hasFrame = client->receive(10, vortices, grid, cloud) || hasFrame;
+        } catch (std::runtime_error & err) {
+            std::cerr << err.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (!client->isConnected()) {
+            std::cout << "The simulation stopped serving frames" << std::endl;
+            myScreen.close();
+        }
+        if (myScreen.isOpen() && hasFrame)
+            drawFrame(myScreen, grid, vortices, cloud, client->header().dt, start);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,39 @@
+#ifndef _REMOTE_MODE_HPP_
+#define _REMOTE_MODE_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "cloud_of_points.hpp"
+#include "options.hpp"
+#include "particle_sources.hpp"
+#include "vortex.hpp"
+
+/**
+ * @brief Run the simulation without window, publishing its frames to remote
+ * viewers
+ *
+ * The simulation runs in a single process, without MPI, and listens on the
+ * address options.serve (see Simulation::FrameServer). Viewers may connect
+ * and disconnect at any time : the simulation starts paused, every viewer
+ * drives it with its keyboard and receives one frame out of
+ * options.frameInterval steps, the slow ones losing frames instead of
+ * slowing down the simulation. It stops on SIGINT or SIGTERM.
+ *
+ * @return The exit code of the program
+ */
+int runServer(const Options & t_options,
+              Simulation::Vortices t_vortices,
+              bool isMobile,
+              Numeric::CartesianGridOfSpeed t_grid,
+              Geometry::CloudOfPoints t_cloud,
+              Simulation::ParticleSources t_sources);
+
+/**
+ * @brief Display the frames of the simulation serving on options.connect
+ * and send it the orders of the keyboard
+ *
+ * The window is closed when the simulation stops serving.
+ *
+ * @return The exit code of the program
+ */
+int runRemoteViewer(const Options & t_options);
+
+#endif
@@ -1,86 +1,175 @@
 #include "runge_kutta.hpp"
 
 #include "cartesian_grid_of_speed.hpp"
+#include "explicit_runge_kutta.hpp"
 
 #include <iostream>
 #include <omp.h>
 
 using namespace Geometry;
 
-Geometry::CloudOfPoints Numeric::solve_RK4_fixed_vortices(
-    double dt, const CartesianGridOfSpeed & t_velocity, const Geometry::CloudOfPoints & t_points) {
-    constexpr double onesixth = 1. / 6.;
-    using vector = Simulation::Vortices::vector;
-    using point = Simulation::Vortices::point;
+namespace {
+    template <const auto & Tableau, typename Source, typename RealType>
+    void advanceParticles(double dt,
+                          const Source & t_source,
+                          const BasicCloudOfPoints<RealType> & t_points,
+                          BasicCloudOfPoints<RealType> & t_newPoints,
+                          std::size_t t_first,
+                          std::size_t t_last) {
+        for (std::size_t iPoint = t_first; iPoint < t_last; ++iPoint)
+            t_newPoints[iPoint] = Numeric::advance<Tableau>(t_source, t_points[iPoint], dt);
+    }
 
-    Geometry::CloudOfPoints newCloud(t_points.numberOfPoints());
-// On ne bouge que les points :
-#pragma omp parallel for
-    for (std::size_t iPoint = 0; iPoint < t_points.numberOfPoints(); ++iPoint) {
-        point p = t_points[iPoint];
-        vector v1 = t_velocity.computeVelocityFor(p);
-        point p1 = p + 0.5 * dt * v1;
-        p1 = t_velocity.updatePosition(p1);
-        vector v2 = t_velocity.computeVelocityFor(p1);
-        point p2 = p + 0.5 * dt * v2;
-        p2 = t_velocity.updatePosition(p2);
-        vector v3 = t_velocity.computeVelocityFor(p2);
-        point p3 = p + dt * v3;
-        p3 = t_velocity.updatePosition(p3);
-        vector v4 = t_velocity.computeVelocityFor(p3);
-        newCloud[iPoint] =
-            t_velocity.updatePosition(p + onesixth * dt * (v1 + 2. * v2 + 2. * v3 + v4));
+    template <typename Source, typename RealType>
+    void advanceParticles(Numeric::Scheme t_scheme,
+                          double dt,
+                          const Source & t_source,
+                          const BasicCloudOfPoints<RealType> & t_points,
+                          BasicCloudOfPoints<RealType> & t_newPoints,
+                          std::size_t t_first,
+                          std::size_t t_last) {
+        using namespace Numeric;
+        switch (t_scheme) {
+        case Scheme::Heun:
+            return advanceParticles<Tableaux::Heun>(dt, t_source, t_points, t_newPoints, t_first,
+                                                    t_last);
+        case Scheme::RK3:
+            return advanceParticles<Tableaux::RK3>(dt, t_source, t_points, t_newPoints, t_first,
+                                                   t_last);
+        case Scheme::RK4:
+            return advanceParticles<Tableaux::RK4>(dt, t_source, t_points, t_newPoints, t_first,
+                                                   t_last);
+        case Scheme::RK5:
+            return advanceParticles<Tableaux::RK5>(dt, t_source, t_points, t_newPoints, t_first,
+                                                   t_last);
+        }
+    }
+
+    template <const auto & Tableau, typename RealType>
+    void advanceParticlesDirect(double dt,
+                                const Simulation::Vortices & t_vortices,
+                                const Numeric::BasicCartesianGridOfSpeed<RealType> & t_domain,
+                                const BasicCloudOfPoints<RealType> & t_points,
+                                BasicCloudOfPoints<RealType> & t_newPoints,
+                                std::size_t t_first,
+                                std::size_t t_last) {
+        Numeric::DirectVelocity<RealType, Numeric::BasicCartesianGridOfSpeed<RealType>> source {
+            t_vortices, t_domain
+        };
+        Numeric::advanceBatch<Tableau>(source, &t_points[t_first], &t_newPoints[t_first],
+                                       t_last - t_first, dt);
     }
-    return newCloud;
-}
 
-Geometry::CloudOfPoints
-    Numeric::solve_RK4_movable_vortices(double dt,
-                                        CartesianGridOfSpeed & t_velocity,
-                                        Simulation::Vortices & t_vortices,
-                                        const Geometry::CloudOfPoints & t_points) {
-    constexpr double onesixth = 1. / 6.;
-    using vector = Simulation::Vortices::vector;
-    using point = Simulation::Vortices::point;
+    template <const auto & Tableau>
+    void advanceVortices(double dt,
+                         const Numeric::CartesianGridOfSpeed & t_velocity,
+                         Simulation::Vortices & t_vortices) {
+        using point = Simulation::Vortices::point;
+        Numeric::VortexVelocity<Numeric::CartesianGridOfSpeed> source { t_vortices, t_velocity };
 
-    Geometry::CloudOfPoints newCloud(t_points.numberOfPoints());
-    // On ne bouge que les points :
-#pragma omp parallel for
-    for (std::size_t iPoint = 0; iPoint < t_points.numberOfPoints(); ++iPoint) {
-        point p = t_points[iPoint];
-        vector v1 = t_velocity.computeVelocityFor(p);
-        point p1 = p + 0.5 * dt * v1;
-        p1 = t_velocity.updatePosition(p1);
-        vector v2 = t_velocity.computeVelocityFor(p1);
-        point p2 = p + 0.5 * dt * v2;
-        p2 = t_velocity.updatePosition(p2);
-        vector v3 = t_velocity.computeVelocityFor(p2);
-        point p3 = p + dt * v3;
-        p3 = t_velocity.updatePosition(p3);
-        vector v4 = t_velocity.computeVelocityFor(p3);
-        newCloud[iPoint] =
-            t_velocity.updatePosition(p + onesixth * dt * (v1 + 2. * v2 + 2. * v3 + v4));
+        std::vector<point> newVortexCenter;
+        newVortexCenter.reserve(t_vortices.numberOfVortices());
+        for (std::size_t iVortex = 0; iVortex < t_vortices.numberOfVortices(); ++iVortex) {
+            newVortexCenter.emplace_back(
+                Numeric::advance<Tableau>(source, t_vortices.getCenter(iVortex), dt));
+        }
+        for (std::size_t iVortex = 0; iVortex < t_vortices.numberOfVortices(); ++iVortex) {
+            t_vortices.setVortex(iVortex, newVortexCenter[iVortex],
+                                 t_vortices.getIntensity(iVortex));
+        }
     }
-    std::vector<point> newVortexCenter;
-    newVortexCenter.reserve(t_vortices.numberOfVortices());
-    for (std::size_t iVortex = 0; iVortex < t_vortices.numberOfVortices(); ++iVortex) {
-        point p = t_vortices.getCenter(iVortex);
-        vector v1 = t_vortices.computeSpeed(p);
-        point p1 = p + 0.5 * dt * v1;
-        p1 = t_velocity.updatePosition(p1);
-        vector v2 = t_vortices.computeSpeed(p1);
-        point p2 = p + 0.5 * dt * v2;
-        p2 = t_velocity.updatePosition(p2);
-        vector v3 = t_vortices.computeSpeed(p2);
-        point p3 = p + dt * v3;
-        p3 = t_velocity.updatePosition(p3);
-        vector v4 = t_vortices.computeSpeed(p3);
-        newVortexCenter.emplace_back(
-            t_velocity.updatePosition(p + onesixth * dt * (v1 + 2. * v2 + 2. * v3 + v4)));
+} // namespace
+
+template <typename RealType>
+void Numeric::solve_particles(Scheme t_scheme,
+                              double dt,
+                              const BasicCartesianGridOfSpeed<RealType> & t_velocity,
+                              const Geometry::BasicCloudOfPoints<RealType> & t_points,
+                              Geometry::BasicCloudOfPoints<RealType> & t_newPoints,
+                              std::size_t t_first,
+                              std::size_t t_last,
+                              bool t_interpolateInTime) {
+    if (t_interpolateInTime)
+        advanceParticles(t_scheme, dt, InterpolatedGridVelocity<RealType> { t_velocity }, t_points,
+                         t_newPoints, t_first, t_last);
+    else
+        advanceParticles(t_scheme, dt, GridVelocity<RealType> { t_velocity }, t_points,
+                         t_newPoints, t_first, t_last);
+}
+
+template void Numeric::solve_particles(Scheme,
+                                       double,
+                                       const BasicCartesianGridOfSpeed<float> &,
+                                       const Geometry::BasicCloudOfPoints<float> &,
+                                       Geometry::BasicCloudOfPoints<float> &,
+                                       std::size_t,
+                                       std::size_t,
+                                       bool);
+template void Numeric::solve_particles(Scheme,
+                                       double,
+                                       const BasicCartesianGridOfSpeed<double> &,
+                                       const Geometry::BasicCloudOfPoints<double> &,
+                                       Geometry::BasicCloudOfPoints<double> &,
+                                       std::size_t,
+                                       std::size_t,
+                                       bool);
+
+template <typename RealType>
+void Numeric::solve_particles_direct(Scheme t_scheme,
+                                     double dt,
+                                     const Simulation::Vortices & t_vortices,
+                                     const BasicCartesianGridOfSpeed<RealType> & t_domain,
+                                     const Geometry::BasicCloudOfPoints<RealType> & t_points,
+                                     Geometry::BasicCloudOfPoints<RealType> & t_newPoints,
+                                     std::size_t t_first,
+                                     std::size_t t_last) {
+    if (t_first >= t_last)
+        return;
+    switch (t_scheme) {
+    case Scheme::Heun:
+        return advanceParticlesDirect<Tableaux::Heun>(dt, t_vortices, t_domain, t_points,
+                                                      t_newPoints, t_first, t_last);
+    case Scheme::RK3:
+        return advanceParticlesDirect<Tableaux::RK3>(dt, t_vortices, t_domain, t_points,
+                                                     t_newPoints, t_first, t_last);
+    case Scheme::RK4:
+        return advanceParticlesDirect<Tableaux::RK4>(dt, t_vortices, t_domain, t_points,
+                                                     t_newPoints, t_first, t_last);
+    case Scheme::RK5:
+        return advanceParticlesDirect<Tableaux::RK5>(dt, t_vortices, t_domain, t_points,
+                                                     t_newPoints, t_first, t_last);
     }
-    for (std::size_t iVortex = 0; iVortex < t_vortices.numberOfVortices(); ++iVortex) {
-        t_vortices.setVortex(iVortex, newVortexCenter[iVortex], t_vortices.getIntensity(iVortex));
+}
+
+template void Numeric::solve_particles_direct(Scheme,
+                                              double,
+                                              const Simulation::Vortices &,
+                                              const BasicCartesianGridOfSpeed<float> &,
+                                              const Geometry::BasicCloudOfPoints<float> &,
+                                              Geometry::BasicCloudOfPoints<float> &,
+                                              std::size_t,
+                                              std::size_t);
+template void Numeric::solve_particles_direct(Scheme,
+                                              double,
+                                              const Simulation::Vortices &,
+                                              const BasicCartesianGridOfSpeed<double> &,
+                                              const Geometry::BasicCloudOfPoints<double> &,
+                                              Geometry::BasicCloudOfPoints<double> &,
+                                              std::size_t,
+                                              std::size_t);
+
+void Numeric::solve_vortices(Scheme t_scheme,
+                             double dt,
+                             const CartesianGridOfSpeed & t_velocity,
+                             Simulation::Vortices & t_vortices) {
+    switch (t_scheme) {
+    case Scheme::Heun:
+        return advanceVortices<Tableaux::Heun>(dt, t_velocity, t_vortices);
+    case Scheme::RK3:
+        return advanceVortices<Tableaux::RK3>(dt, t_velocity, t_vortices);
+    case Scheme::RK4:
+        return advanceVortices<Tableaux::RK4>(dt, t_velocity, t_vortices);
+    case Scheme::RK5:
+        return advanceVortices<Tableaux::RK5>(dt, t_velocity, t_vortices);
     }
-    t_velocity.updateVelocityField(t_vortices);
-    return newCloud;
 }
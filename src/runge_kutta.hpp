@@ -2,20 +2,63 @@
 #define _NUMERIC_RUNGE_KUTTA_HPP_
 #include "cartesian_grid_of_speed.hpp"
 #include "cloud_of_points.hpp"
+#include "scheme.hpp"
 #include "vortex.hpp"
 
 #include <utility>
 
 namespace Numeric {
 
-    Geometry::CloudOfPoints solve_RK4_fixed_vortices(double dt,
-                                                     const CartesianGridOfSpeed & speed,
-                                                     const Geometry::CloudOfPoints & t_points);
+    /**
+     * @brief Advance the particles [t_first, t_last) of t_points in the
+     * velocity field and store them at the same indices in t_newPoints
+     *
+     * Sequential building block used by the task based step pipeline. The
+     * computations are done in RealType (instantiated for float and double).
+     * The scheme is chosen once for the whole range, the integrator itself
+     * being specialized at compile time for each scheme (see
+     * explicit_runge_kutta.hpp).
+     *
+     * @param t_interpolateInTime If true, the pending field of t_velocity
+     * must hold the complete field at the end of the step : the stages then
+     * use the field interpolated in time at their node instead of the
+     * current one
+     */
+    template <typename RealType>
+    void solve_particles(Scheme t_scheme,
+                         double dt,
+                         const BasicCartesianGridOfSpeed<RealType> & t_velocity,
+                         const Geometry::BasicCloudOfPoints<RealType> & t_points,
+                         Geometry::BasicCloudOfPoints<RealType> & t_newPoints,
+                         std::size_t t_first,
+                         std::size_t t_last,
+                         bool t_interpolateInTime = false);
 
-    Geometry::CloudOfPoints solve_RK4_movable_vortices(double dt,
-                                                       CartesianGridOfSpeed & t_velocity,
-                                                       Simulation::Vortices & t_vortices,
-                                                       const Geometry::CloudOfPoints & t_points);
+    /**
+     * @brief Same as solve_particles, but the velocities are summed directly
+     * over the vortices instead of being interpolated in the grid
+     *
+     * Exact, and cheaper than the interpolation when there are few vortices.
+     * The particles are advanced by batches through a vectorized kernel (see
+     * Vortices::computeSpeeds). The grid only gives the periodic domain.
+     */
+    template <typename RealType>
+    void solve_particles_direct(Scheme t_scheme,
+                                double dt,
+                                const Simulation::Vortices & t_vortices,
+                                const BasicCartesianGridOfSpeed<RealType> & t_domain,
+                                const Geometry::BasicCloudOfPoints<RealType> & t_points,
+                                Geometry::BasicCloudOfPoints<RealType> & t_newPoints,
+                                std::size_t t_first,
+                                std::size_t t_last);
+
+    /**
+     * @brief Advance the centers of the vortices in their own velocity field
+     */
+    void solve_vortices(Scheme t_scheme,
+                        double dt,
+                        const CartesianGridOfSpeed & t_velocity,
+                        Simulation::Vortices & t_vortices);
 } // namespace Numeric
 
 #endif
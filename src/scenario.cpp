@@ -0,0 +1,456 @@
+#include "scenario.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+using namespace Simulation;
+
+namespace {
+    constexpr char scenarioMagic[] = "vortex-scenario";
+    constexpr char vortexFileMagic[8] = { 'V', 'O', 'R', 'T', 'I', 'C', 'E', 'S' };
+
+    /// Réel écrit avec le moins de chiffres qui le relisent exactement
+    struct Exact {
+        double value;
+    };
+    std::ostream & operator<<(std::ostream & os, Exact t_real) {
+        char buffer[32];
+        auto end = std::to_chars(buffer, buffer + sizeof(buffer), t_real.value).ptr;
+        return os.write(buffer, end - buffer);
+    }
+
+    /**
+     * @brief Lines of a configuration file, with the position of the last one
+     * read for the error messages
+     */
+    class LineReader {
+    public:
+        LineReader(const std::string & t_fileName) : m_fileName(t_fileName), m_input(t_fileName) {
+            if (!m_input)
+                throw std::runtime_error("Cannot open " + t_fileName);
+        }
+
+        bool next(std::string & t_line) {
+            if (!std::getline(m_input, t_line))
+                return false;
+            ++m_lineNumber;
+            return true;
+        }
+        /// Next line, which must exist
+        std::istringstream values(const char * t_what) {
+            std::string line;
+            if (!next(line))
+                fail(std::string("missing ") + t_what);
+            return std::istringstream(line);
+        }
+        /// Skip the comment line preceding a value in the historical format
+        bool skipComment() {
+            std::string line;
+            return next(line);
+        }
+
+        [[noreturn]] void fail(const std::string & t_message) const {
+            throw std::runtime_error(m_fileName + ":" + std::to_string(m_lineNumber) + ": "
+                                     + t_message);
+        }
+        template <typename... Values>
+        void read(std::istream & t_line, const char * t_what, Values &... t_values) {
+            if (!(t_line >> ... >> t_values))
+                fail(std::string("malformed ") + t_what);
+        }
+
+        const std::string & fileName() const { return m_fileName; }
+
+    private:
+        std::string m_fileName;
+        std::ifstream m_input;
+        std::size_t m_lineNumber = 0;
+    };
+
+    /// Format of the files of data/ : each value line follows a comment line
+    void readHistoricalSpec(LineReader & t_reader, ScenarioSpec & t_spec) {
+        using point = Geometry::Point<double>;
+        // La première ligne de commentaire est déjà lue
+        auto line = t_reader.values("grid");
+        auto & grid = t_spec.grid;
+        t_reader.read(line, "grid", grid.left, grid.bottom, grid.nx, grid.ny, grid.step);
+
+        t_reader.skipComment();
+        line = t_reader.values("particle generation");
+        int modeGeneration;
+        ScenarioSpec::Seeding seeding;
+        t_reader.read(line, "particle generation", modeGeneration);
+        if (modeGeneration == 0) { // Génération sur toute la grille
+            t_reader.read(line, "particle generation", seeding.nbPoints);
+        } else {
+            seeding.wholeDomain = false;
+            t_reader.read(line, "particle generation", seeding.bottomLeft.x, seeding.bottomLeft.y,
+                          seeding.topRight.x, seeding.topRight.y, seeding.nbPoints);
+        }
+        t_spec.seedings.push_back(seeding);
+
+        t_reader.skipComment();
+        line = t_reader.values("number of vortices");
+        std::size_t nbVortices;
+        t_reader.read(line, "number of vortices", nbVortices);
+        t_reader.skipComment();
+        for (std::size_t iVortex = 0; iVortex < nbVortices; ++iVortex) {
+            line = t_reader.values("vortex");
+            ScenarioSpec::VortexValue vortex;
+            t_reader.read(line, "vortex", vortex.x, vortex.y, vortex.intensity);
+            t_spec.vortices.push_back(vortex);
+        }
+        t_reader.skipComment();
+        line = t_reader.values("vortex mobility");
+        int isMobile;
+        t_reader.read(line, "vortex mobility", isMobile);
+        t_spec.isMobile = isMobile != 0;
+
+        // Sections facultatives : émetteurs et puits de particules
+        std::string text;
+        t_reader.skipComment();
+        if (!t_reader.next(text))
+            return;
+        std::istringstream emitters(text);
+        std::size_t nbEmitters = 0, nbSinks = 0;
+        t_reader.read(emitters, "number of emitters", nbEmitters);
+        t_reader.skipComment();
+        for (std::size_t iEmitter = 0; iEmitter < nbEmitters; ++iEmitter) {
+            line = t_reader.values("emitter");
+            ScenarioSpec::Emitter emitter;
+            t_reader.read(line, "emitter", emitter.bottomLeft.x, emitter.bottomLeft.y,
+                          emitter.topRight.x, emitter.topRight.y, emitter.rate);
+            t_spec.emitters.push_back(emitter);
+        }
+        t_reader.skipComment();
+        line = t_reader.values("number of sinks");
+        t_reader.read(line, "number of sinks", nbSinks);
+        t_reader.skipComment();
+        for (std::size_t iSink = 0; iSink < nbSinks; ++iSink) {
+            line = t_reader.values("sink");
+            point bottomLeft, topRight;
+            t_reader.read(line, "sink", bottomLeft.x, bottomLeft.y, topRight.x, topRight.y);
+            t_spec.sinks.emplace_back(bottomLeft, topRight);
+        }
+        t_reader.skipComment();
+        line = t_reader.values("particle lifetime");
+        t_reader.read(line, "particle lifetime", t_spec.maxAge, t_spec.maxParticles);
+    }
+
+    void readKeyedSpec(LineReader & t_reader, ScenarioSpec & t_spec) {
+        using point = Geometry::Point<double>;
+        auto directory = std::filesystem::path(t_reader.fileName()).parent_path();
+        bool hasGrid = false;
+        std::string text;
+        while (t_reader.next(text)) {
+            std::istringstream line(text.substr(0, text.find('#')));
+            std::string key;
+            if (!(line >> key))
+                continue;
+            if (key == "grid") {
+                auto & grid = t_spec.grid;
+                t_reader.read(line, "grid", grid.left, grid.bottom, grid.nx, grid.ny, grid.step);
+                hasGrid = true;
+            } else if (key == "mobile") {
+                int isMobile;
+                t_reader.read(line, "mobile", isMobile);
+                t_spec.isMobile = isMobile != 0;
+            } else if (key == "particles") {
+                std::string kind;
+                t_reader.read(line, "particles", kind);
+                ScenarioSpec::Seeding seeding;
+                if (kind == "domain") {
+                    t_reader.read(line, "particles", seeding.nbPoints);
+                } else if (kind == "rect") {
+                    seeding.wholeDomain = false;
+                    t_reader.read(line, "particles", seeding.bottomLeft.x, seeding.bottomLeft.y,
+                                  seeding.topRight.x, seeding.topRight.y, seeding.nbPoints);
+                } else {
+                    t_reader.fail("unknown particle seeding " + kind);
+                }
+                t_spec.seedings.push_back(seeding);
+            } else if (key == "vortex") {
+                ScenarioSpec::VortexValue vortex;
+                t_reader.read(line, "vortex", vortex.x, vortex.y, vortex.intensity);
+                if (vortex.intensity == 0.)
+                    t_reader.fail("null vortex intensity");
+                t_spec.vortices.push_back(vortex);
+            } else if (key == "vortices") {
+                std::string kind;
+                t_reader.read(line, "vortices", kind);
+                if (kind == "file") {
+                    std::string path;
+                    t_reader.read(line, "vortices", path);
+                    try {
+                        readVortexFile((directory / path).string(), t_spec.vortices);
+                    } catch (std::runtime_error & err) {
+                        t_reader.fail(err.what());
+                    }
+                } else {
+                    ScenarioSpec::RandomVortices random;
+                    if (kind == "random") {
+                        t_reader.read(line, "vortices", random.count, random.seed,
+                                      random.intensity);
+                    } else if (kind == "gaussian") {
+                        random.isGaussian = true;
+                        t_reader.read(line, "vortices", random.count, random.seed, random.cx,
+                                      random.cy, random.sigma, random.intensity);
+                    } else {
+                        t_reader.fail("unknown vortex generation " + kind);
+                    }
+                    if (random.intensity <= 0.)
+                        t_reader.fail("the intensity of random vortices must be positive");
+                    t_spec.randomVortices.push_back(random);
+                }
+            } else if (key == "emitter") {
+                ScenarioSpec::Emitter emitter;
+                t_reader.read(line, "emitter", emitter.bottomLeft.x, emitter.bottomLeft.y,
+                              emitter.topRight.x, emitter.topRight.y, emitter.rate);
+                t_spec.emitters.push_back(emitter);
+            } else if (key == "sink") {
+                point bottomLeft, topRight;
+                t_reader.read(line, "sink", bottomLeft.x, bottomLeft.y, topRight.x, topRight.y);
+                t_spec.sinks.emplace_back(bottomLeft, topRight);
+            } else if (key == "max-age") {
+                t_reader.read(line, "max-age", t_spec.maxAge);
+            } else if (key == "max-particles") {
+                t_reader.read(line, "max-particles", t_spec.maxParticles);
+            } else {
+                t_reader.fail("unknown key " + key);
+            }
+            std::string extra;
+            if (line >> extra)
+                t_reader.fail("unexpected value " + extra + " after " + key);
+        }
+        if (!hasGrid)
+            t_reader.fail("no grid given");
+    }
+} // namespace
+
+std::size_t ScenarioSpec::numberOfPoints() const {
+    std::size_t nbPoints = 0;
+    for (const auto & seeding : seedings) {
+        auto lattice = Geometry::pointLattice(seeding.nbPoints);
+        nbPoints += lattice.first * lattice.second;
+    }
+    return nbPoints;
+}
+
+std::size_t ScenarioSpec::numberOfVortices() const {
+    std::size_t nbVortices = vortices.size();
+    for (const auto & random : randomVortices)
+        nbVortices += random.count;
+    return nbVortices;
+}
+
+void ScenarioSpec::scaleParticles(double t_factor) {
+    auto scaled = [t_factor](std::size_t t_count) {
+        return std::size_t(std::llround(t_count * t_factor));
+    };
+    for (auto & seeding : seedings)
+        seeding.nbPoints = scaled(seeding.nbPoints);
+    for (auto & emitter : emitters)
+        emitter.rate = scaled(emitter.rate);
+    maxParticles = scaled(maxParticles);
+}
+
+void ScenarioSpec::refineGrid(double t_factor) {
+    double height = grid.ny * grid.step;
+    std::size_t nx = std::max<std::size_t>(1, std::size_t(std::llround(grid.nx * t_factor)));
+    grid.step *= double(grid.nx) / nx;
+    grid.nx = nx;
+    grid.ny = std::max<std::size_t>(1, std::size_t(std::llround(height / grid.step)));
+}
+
+ScenarioSpec Simulation::readScenarioSpec(const std::string & t_fileName) {
+    LineReader reader(t_fileName);
+    ScenarioSpec spec;
+    std::string first;
+    if (!reader.next(first))
+        reader.fail("empty file");
+    std::istringstream header(first);
+    std::string magic;
+    int version = 0;
+    if (header >> magic && magic == scenarioMagic) {
+        if (!(header >> version) || version != 1)
+            reader.fail("unsupported scenario version");
+        readKeyedSpec(reader, spec);
+    } else {
+        readHistoricalSpec(reader, spec);
+    }
+    // Les particules injectées doivent tenir dans la réserve fixée une fois
+    // pour toutes
+    if (!spec.emitters.empty() && spec.maxParticles <= spec.numberOfPoints())
+        reader.fail("emitters need a maximal number of particles above the initial one");
+    return spec;
+}
+
+void Simulation::writeScenarioSpec(std::ostream & t_output,
+                                   const ScenarioSpec & t_spec,
+                                   const std::string & t_vortexFile) {
+    auto area = [&t_output](const Geometry::Point<double> & t_bottomLeft,
+                            const Geometry::Point<double> & t_topRight) -> std::ostream & {
+        return t_output << Exact { t_bottomLeft.x } << ' ' << Exact { t_bottomLeft.y } << ' '
+                        << Exact { t_topRight.x } << ' ' << Exact { t_topRight.y };
+    };
+    const auto & grid = t_spec.grid;
+    t_output << scenarioMagic << " 1\n"
+             << "grid " << Exact { grid.left } << ' ' << Exact { grid.bottom } << ' ' << grid.nx
+             << ' ' << grid.ny << ' ' << Exact { grid.step } << '\n'
+             << "mobile " << int(t_spec.isMobile) << '\n';
+    for (const auto & seeding : t_spec.seedings) {
+        if (seeding.wholeDomain) {
+            t_output << "particles domain " << seeding.nbPoints << '\n';
+        } else {
+            t_output << "particles rect ";
+            area(seeding.bottomLeft, seeding.topRight) << ' ' << seeding.nbPoints << '\n';
+        }
+    }
+    if (!t_vortexFile.empty()) {
+        t_output << "vortices file " << t_vortexFile << '\n';
+    } else {
+        for (const auto & vortex : t_spec.vortices)
+            t_output << "vortex " << Exact { vortex.x } << ' ' << Exact { vortex.y } << ' '
+                     << Exact { vortex.intensity } << '\n';
+    }
+    for (const auto & random : t_spec.randomVortices) {
+        if (random.isGaussian)
+            t_output << "vortices gaussian " << random.count << ' ' << random.seed << ' '
+                     << Exact { random.cx } << ' ' << Exact { random.cy } << ' '
+                     << Exact { random.sigma } << ' ' << Exact { random.intensity } << '\n';
+        else
+            t_output << "vortices random " << random.count << ' ' << random.seed << ' '
+                     << Exact { random.intensity } << '\n';
+    }
+    for (const auto & emitter : t_spec.emitters) {
+        t_output << "emitter ";
+        area(emitter.bottomLeft, emitter.topRight) << ' ' << emitter.rate << '\n';
+    }
+    for (const auto & sink : t_spec.sinks) {
+        t_output << "sink ";
+        area(sink.first, sink.second) << '\n';
+    }
+    if (t_spec.maxAge > 0.)
+        t_output << "max-age " << Exact { t_spec.maxAge } << '\n';
+    if (t_spec.maxParticles > 0)
+        t_output << "max-particles " << t_spec.maxParticles << '\n';
+}
+
+Scenario Simulation::buildScenario(const ScenarioSpec & t_spec) {
+    using point = Geometry::Point<double>;
+    const auto & spec = t_spec.grid;
+    Scenario scenario;
+    scenario.isMobile = t_spec.isMobile;
+    scenario.grid =
+        Numeric::CartesianGridOfSpeed({ spec.nx, spec.ny }, point { spec.left, spec.bottom },
+                                      spec.step);
+    point bottomLeft = scenario.grid.getLeftBottomVertex();
+    point topRight = scenario.grid.getRightTopVertex();
+
+    // Tourbillons donnés, puis tirés au hasard
+    std::vector<ScenarioSpec::VortexValue> values = t_spec.vortices;
+    values.reserve(t_spec.numberOfVortices());
+    for (const auto & random : t_spec.randomVortices)
+        appendRandomVortices(random, bottomLeft, topRight, values);
+    scenario.vortices = Vortices(values.size(), { bottomLeft, topRight });
+    for (std::size_t iVortex = 0; iVortex < values.size(); ++iVortex)
+        scenario.vortices.setVortex(iVortex, point { values[iVortex].x, values[iVortex].y },
+                                    values[iVortex].intensity);
+
+    // Toutes les zones dans un seul nuage, rempli en parallèle
+    scenario.cloud = Geometry::CloudOfPoints(t_spec.numberOfPoints());
+    std::size_t first = 0;
+    for (const auto & seeding : t_spec.seedings) {
+        auto lattice = Geometry::pointLattice(seeding.nbPoints);
+        Geometry::Rectangle area =
+            seeding.wholeDomain ? Geometry::Rectangle { bottomLeft, topRight }
+                                : Geometry::Rectangle { seeding.bottomLeft, seeding.topRight };
+        Geometry::generatePointsIn(lattice, area, scenario.cloud, first);
+        first += lattice.first * lattice.second;
+    }
+
+    auto & sources = scenario.sources;
+    for (const auto & emitter : t_spec.emitters)
+        sources.addEmitter({ emitter.bottomLeft, emitter.topRight }, emitter.rate);
+    for (const auto & sink : t_spec.sinks)
+        sources.addSink({ sink.first, sink.second });
+    std::size_t nbPoints = scenario.cloud.numberOfPoints();
+    sources.setMaxAge(t_spec.maxAge);
+    sources.setCapacity(std::max(t_spec.maxParticles, nbPoints));
+    sources.reset(nbPoints);
+    return scenario;
+}
+
+void Simulation::appendRandomVortices(const ScenarioSpec::RandomVortices & t_random,
+                                      const Geometry::Point<double> & t_bottomLeft,
+                                      const Geometry::Point<double> & t_topRight,
+                                      std::vector<ScenarioSpec::VortexValue> & t_vortices) {
+    double width = t_topRight.x - t_bottomLeft.x, height = t_topRight.y - t_bottomLeft.y;
+    auto wrap = [](double t_value, double t_origin, double t_period) {
+        double offset = std::fmod(t_value - t_origin, t_period);
+        return t_origin + (offset < 0. ? offset + t_period : offset);
+    };
+    // Mêmes tirages sur tous les processus : seule la graine compte
+    std::mt19937_64 generator(t_random.seed);
+    std::uniform_real_distribution<double> uniform(0., 1.);
+    std::normal_distribution<double> normal(0., 1.);
+    for (std::size_t iRandom = 0; iRandom < t_random.count; ++iRandom) {
+        double x, y;
+        if (t_random.isGaussian) {
+            x = wrap(t_random.cx + t_random.sigma * normal(generator), t_bottomLeft.x, width);
+            y = wrap(t_random.cy + t_random.sigma * normal(generator), t_bottomLeft.y, height);
+        } else {
+            x = t_bottomLeft.x + width * uniform(generator);
+            y = t_bottomLeft.y + height * uniform(generator);
+        }
+        double sign = uniform(generator) < 0.5 ? -1. : 1.;
+        t_vortices.push_back({ x, y, sign * t_random.intensity * (1. - uniform(generator)) });
+    }
+}
+
+void Simulation::writeVortexFile(const std::string & t_fileName,
+                                 const std::vector<ScenarioSpec::VortexValue> & t_vortices) {
+    std::ofstream output(t_fileName, std::ios::binary);
+    std::uint64_t nbVortices = t_vortices.size();
+    output.write(vortexFileMagic, sizeof(vortexFileMagic));
+    output.write(reinterpret_cast<const char *>(&nbVortices), sizeof(nbVortices));
+    for (const auto & vortex : t_vortices) {
+        double values[3] = { vortex.x, vortex.y, vortex.intensity };
+        output.write(reinterpret_cast<const char *>(values), sizeof(values));
+    }
+    if (!output)
+        throw std::runtime_error("Cannot write " + t_fileName);
+}
+
+void Simulation::readVortexFile(const std::string & t_fileName,
+                                std::vector<ScenarioSpec::VortexValue> & t_vortices) {
+    std::ifstream input(t_fileName, std::ios::binary);
+    if (!input)
+        throw std::runtime_error("Cannot open " + t_fileName);
+    char magic[sizeof(vortexFileMagic)];
+    std::uint64_t nbVortices = 0;
+    input.read(magic, sizeof(magic));
+    input.read(reinterpret_cast<char *>(&nbVortices), sizeof(nbVortices));
+    if (!input || std::memcmp(magic, vortexFileMagic, sizeof(magic)) != 0)
+        throw std::runtime_error(t_fileName + " is not a vortex file");
+    // Lecture d'un bloc, sans analyse de texte
+    std::size_t first = t_vortices.size();
+    std::vector<double> values(3 * nbVortices);
+    input.read(reinterpret_cast<char *>(values.data()), values.size() * sizeof(double));
+    if (!input)
+        throw std::runtime_error(t_fileName + " is truncated");
+    t_vortices.resize(first + nbVortices);
+    for (std::size_t iVortex = 0; iVortex < nbVortices; ++iVortex) {
+        t_vortices[first + iVortex] = { values[3 * iVortex], values[3 * iVortex + 1],
+                                        values[3 * iVortex + 2] };
+        if (values[3 * iVortex + 2] == 0.)
+            throw std::runtime_error(t_fileName + " holds a vortex of null intensity");
+    }
+}
@@ -0,0 +1,164 @@
+#ifndef _SIMULATION_SCENARIO_HPP_
+#define _SIMULATION_SCENARIO_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "cloud_of_points.hpp"
+#include "particle_sources.hpp"
+#include "rectangle.hpp"
+#include "vortex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Simulation {
+    /**
+     * @brief Description of the initial state of a simulation, as read from
+     * a configuration file, before the particles and the vortices are
+     * generated
+     *
+     * Two formats are read :
+     * - the historical format of the files of data/, a fixed sequence of
+     *   lines each preceded by a comment line ;
+     * - the keyed format, whose first line is "vortex-scenario 1" and whose
+     *   other lines each hold a key followed by its values, in any order
+     *   ('#' starts a comment) :
+     *
+     *       grid <left> <bottom> <nx> <ny> <step>
+     *       mobile <0|1>
+     *       particles domain <n>
+     *       particles rect <xl> <yb> <xr> <yt> <n>
+     *       vortex <x> <y> <intensity>
+     *       vortices random <n> <seed> <intensity>
+     *       vortices gaussian <n> <seed> <cx> <cy> <sigma> <intensity>
+     *       vortices file <path>
+     *       emitter <xl> <yb> <xr> <yt> <rate>
+     *       sink <xl> <yb> <xr> <yt>
+     *       max-age <t>
+     *       max-particles <n>
+     *
+     * Every key but grid, mobile, max-age and max-particles may be repeated.
+     * With emitters, the maximal number of particles must be above the
+     * number of particles of the initial cloud.
+     * Each seeding region holds a regular lattice of about n particles. The
+     * random vortices are drawn from their seed (so every process builds the
+     * same ones), with an intensity of random sign and of magnitude in
+     * (0, intensity]. Their centers are uniform in the domain, or normally
+     * distributed around (cx, cy) and wrapped in the domain. The path of a
+     * vortex file is relative to the scenario file (see readVortexFile).
+     */
+    struct ScenarioSpec {
+        struct Grid {
+            double left = 0., bottom = 0.;
+            std::size_t nx = 0, ny = 0;
+            double step = 0.;
+        };
+        struct Seeding {
+            bool wholeDomain = true;
+            Geometry::Point<double> bottomLeft, topRight;
+            std::size_t nbPoints = 0;
+        };
+        struct VortexValue {
+            double x, y, intensity;
+        };
+        struct RandomVortices {
+            bool isGaussian = false;
+            std::size_t count = 0;
+            std::uint64_t seed = 0;
+            double cx = 0., cy = 0., sigma = 0.;
+            double intensity = 1.;
+        };
+        struct Emitter {
+            Geometry::Point<double> bottomLeft, topRight;
+            std::size_t rate = 0;
+        };
+
+        Grid grid;
+        bool isMobile = false;
+        std::vector<Seeding> seedings;
+        /// Vortices given one by one or by files, before the random ones
+        std::vector<VortexValue> vortices;
+        std::vector<RandomVortices> randomVortices;
+        std::vector<Emitter> emitters;
+        std::vector<std::pair<Geometry::Point<double>, Geometry::Point<double>>> sinks;
+        double maxAge = 0.;
+        std::size_t maxParticles = 0;
+
+        /// Number of particles of the initial cloud
+        std::size_t numberOfPoints() const;
+        std::size_t numberOfVortices() const;
+        /**
+         * @brief Multiply the numbers of particles of the seedings, the rates
+         * of the emitters and the maximal number of particles by t_factor
+         */
+        void scaleParticles(double t_factor);
+        /**
+         * @brief Multiply the number of cells per direction by t_factor over
+         * the same domain (to the step if the factor is not an integer)
+         */
+        void refineGrid(double t_factor);
+    };
+
+    /**
+     * @brief Initial state of a simulation
+     */
+    struct Scenario {
+        Vortices vortices;
+        bool isMobile = false;
+        Numeric::CartesianGridOfSpeed grid;
+        Geometry::CloudOfPoints cloud;
+        ParticleSources sources;
+    };
+
+    /**
+     * @brief Read a configuration file in either format
+     *
+     * Throw std::runtime_error, with the file and the line, if the file
+     * cannot be read or is malformed.
+     */
+    ScenarioSpec readScenarioSpec(const std::string & t_fileName);
+    /**
+     * @brief Write t_spec in the keyed format
+     *
+     * @param t_vortexFile If not empty, the vortices given one by one are not
+     * listed but read from this file, to be written by the caller with
+     * writeVortexFile
+     */
+    void writeScenarioSpec(std::ostream & t_output,
+                           const ScenarioSpec & t_spec,
+                           const std::string & t_vortexFile = "");
+    /**
+     * @brief Generate the vortices, the grid (without its field) and the
+     * particles of t_spec, the particles in parallel in a single cloud
+     */
+    Scenario buildScenario(const ScenarioSpec & t_spec);
+    inline Scenario readScenario(const std::string & t_fileName) {
+        return buildScenario(readScenarioSpec(t_fileName));
+    }
+
+    /**
+     * @brief Append the vortices drawn by t_random in the domain
+     * [t_bottomLeft, t_topRight] to t_vortices
+     */
+    void appendRandomVortices(const ScenarioSpec::RandomVortices & t_random,
+                              const Geometry::Point<double> & t_bottomLeft,
+                              const Geometry::Point<double> & t_topRight,
+                              std::vector<ScenarioSpec::VortexValue> & t_vortices);
+
+    /**
+     * @brief Binary list of vortices : the 8 bytes "VORTICES", the number of
+     * vortices as a 64 bits unsigned integer, then x, y and intensity of each
+     * vortex as doubles, in the byte order of the machine
+     */
+    void writeVortexFile(const std::string & t_fileName,
+                         const std::vector<ScenarioSpec::VortexValue> & t_vortices);
+    /**
+     * @brief Append the vortices of a file written by writeVortexFile to
+     * t_vortices, throw std::runtime_error if it cannot be read
+     */
+    void readVortexFile(const std::string & t_fileName,
+                        std::vector<ScenarioSpec::VortexValue> & t_vortices);
+} // namespace Simulation
+
+#endif
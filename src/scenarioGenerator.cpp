@@ -0,0 +1,139 @@
+#include "scenario.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+    struct GeneratorOptions {
+        std::string input, output;
+        /// Factor applied to the numbers of particles (seedings, emitters)
+        double particles = 1.;
+        /// Factor applied to the number of cells per direction
+        double grid = 1.;
+        /// If not zero, total number of vortices
+        std::size_t vortices = 0;
+        std::uint64_t seed = 1;
+    };
+
+    /// Vortex lists longer than this are written in a binary side file
+    constexpr std::size_t maxListedVortices = 64;
+
+    void printUsage(const char * program) {
+        std::cout << "Usage : " << program << " <input> <output> [options]" << std::endl
+                  << "Write in the keyed scenario format a scaled variant of a configuration "
+                     "file (historical or keyed format)"
+                  << std::endl
+                  << "    --particles=F  multiply the numbers of particles by F" << std::endl
+                  << "    --grid=F  multiply the number of cells per direction by F, the domain "
+                     "being kept"
+                  << std::endl
+                  << "    --vortices=N  add random vortices up to N vortices" << std::endl
+                  << "    --seed=S  seed of the added vortices (default 1)" << std::endl;
+    }
+
+    GeneratorOptions parseGeneratorOptions(int argc, char * argv[]) {
+        GeneratorOptions options;
+        std::vector<std::string> positional;
+        for (int iArg = 1; iArg < argc; ++iArg) {
+            std::string_view arg { argv[iArg] };
+            if (!arg.starts_with("--")) {
+                positional.emplace_back(arg);
+                continue;
+            }
+            std::string_view name = arg.substr(2);
+            std::string value;
+            if (auto eq = name.find('='); eq != std::string_view::npos) {
+                value = std::string(name.substr(eq + 1));
+                name = name.substr(0, eq);
+            }
+            if (value.empty())
+                throw std::invalid_argument("--" + std::string(name) + " expects a value");
+            if (name == "particles")
+                options.particles = std::stod(value);
+            else if (name == "grid")
+                options.grid = std::stod(value);
+            else if (name == "vortices")
+                options.vortices = std::stoull(value);
+            else if (name == "seed")
+                options.seed = std::stoull(value);
+            else
+                throw std::invalid_argument("Unknown option --" + std::string(name));
+        }
+        if (positional.size() != 2)
+            throw std::invalid_argument("Expected an input and an output file");
+        if (options.particles <= 0. || options.grid <= 0.)
+            throw std::invalid_argument("The scale factors must be positive");
+        options.input = positional[0];
+        options.output = positional[1];
+        return options;
+    }
+
+} // namespace
+
+int main(int argc, char * argv[]) {
+    GeneratorOptions options;
+    try {
+        options = parseGeneratorOptions(argc, argv);
+    } catch (std::exception & err) {
+        std::cout << err.what() << std::endl;
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Simulation::ScenarioSpec spec;
+    try {
+        spec = Simulation::readScenarioSpec(options.input);
+    } catch (std::runtime_error & err) {
+        std::cerr << err.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    spec.refineGrid(options.grid);
+    spec.scaleParticles(options.particles);
+    const auto & grid = spec.grid;
+
+    // Tourbillons ajoutés uniformément dans le domaine, d'intensité au plus
+    // celle des tourbillons donnés
+    if (options.vortices > spec.numberOfVortices()) {
+        double intensity = 0.;
+        for (const auto & vortex : spec.vortices)
+            intensity = std::max(intensity, std::abs(vortex.intensity));
+        for (const auto & random : spec.randomVortices)
+            intensity = std::max(intensity, random.intensity);
+        Simulation::ScenarioSpec::RandomVortices added;
+        added.count = options.vortices - spec.numberOfVortices();
+        added.seed = options.seed;
+        added.intensity = intensity > 0. ? intensity : 1.;
+        // Tirés une fois pour toutes : le fichier produit est explicite
+        Simulation::appendRandomVortices(added, { grid.left, grid.bottom },
+                                         { grid.left + grid.nx * grid.step,
+                                           grid.bottom + grid.ny * grid.step },
+                                         spec.vortices);
+    }
+
+    std::string vortexFile;
+    if (spec.vortices.size() > maxListedVortices) {
+        std::filesystem::path output(options.output);
+        vortexFile = output.stem().string() + ".vortices";
+        Simulation::writeVortexFile((output.parent_path() / vortexFile).string(), spec.vortices);
+    }
+    std::ofstream output(options.output);
+    Simulation::writeScenarioSpec(output, spec, vortexFile);
+    if (!output) {
+        std::cerr << "Cannot write " << options.output << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << options.output << " : " << grid.nx << " x " << grid.ny << " cells, "
+              << spec.numberOfPoints() << " particles, " << spec.numberOfVortices()
+              << " vortices" << (vortexFile.empty() ? "" : " (listed in " + vortexFile + ")")
+              << std::endl;
+    return EXIT_SUCCESS;
+}
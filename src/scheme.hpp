@@ -0,0 +1,44 @@
+#ifndef _NUMERIC_SCHEME_HPP_
+#define _NUMERIC_SCHEME_HPP_
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace Numeric {
+    /**
+     * @brief Time integration scheme of the particles and of the vortices
+     *
+     * See the tableaux of the same names in explicit_runge_kutta.hpp.
+     */
+    enum class Scheme { Heun, RK3, RK4, RK5 };
+
+    inline const char * schemeName(Scheme t_scheme) {
+        switch (t_scheme) {
+        case Scheme::Heun:
+            return "heun";
+        case Scheme::RK3:
+            return "rk3";
+        case Scheme::RK4:
+            return "rk4";
+        case Scheme::RK5:
+            return "rk5";
+        }
+        return "?";
+    }
+
+    /**
+     * @brief Scheme named t_name (heun, rk3, rk4 or rk5)
+     *
+     * Throw std::invalid_argument on an unknown name.
+     */
+    inline Scheme parseScheme(std::string_view t_name) {
+        for (Scheme scheme : { Scheme::Heun, Scheme::RK3, Scheme::RK4, Scheme::RK5 }) {
+            if (t_name == schemeName(scheme))
+                return scheme;
+        }
+        throw std::invalid_argument("Unknown scheme " + std::string(t_name));
+    }
+} // namespace Numeric
+
+#endif
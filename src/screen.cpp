@@ -1,13 +1,19 @@
 #include "screen.hpp"
 
-#include <SFML/Graphics/CircleShape.hpp>
+#include "rasterizer.hpp"
+
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/Graphics/Texture.hpp>
 #include <SFML/Graphics/PrimitiveType.hpp>
 #include <SFML/Graphics/Rect.hpp>
 #include <SFML/Graphics/VertexArray.hpp>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iostream>
 #include <locale>
 #include <omp.h>
+#include <vector>
 
 Graphisme::Screen::Screen(
     const std::pair<std::size_t, std::size_t> & t_geometry,
@@ -28,7 +34,7 @@ Graphisme::Screen::Screen(
 
 void Graphisme::Screen::displayVelocityField(const Numeric::CartesianGridOfSpeed & grid,
                                              const Simulation::Vortices & vortices) {
-    using vector = Numeric::CartesianGridOfSpeed::vector;
+    using vector = Geometry::Vector<double>;
     m_window.setView(m_velocityView);
     // Affichage moité gauche de l'écran :
     auto screenSize = m_velocityView.getSize();
@@ -43,66 +49,65 @@ void Graphisme::Screen::displayVelocityField(const Numeric::CartesianGridOfSpeed
     double hx = grid.getStep() * scalex;
     double hy = grid.getStep() * scaley;
 
-    if (m_grid.getVertexCount() == 0) {
-        m_grid = sf::VertexArray(sf::Lines, 2 * (nbCells.first + nbCells.second + 2));
-        std::size_t indDrawVert = 0;
-        for (std::size_t ix = 0; ix <= nbCells.first; ++ix) {
-            m_grid[indDrawVert] = sf::Vertex(sf::Vector2f(ix * hx, 0));
-            m_grid[indDrawVert].color = sf::Color(64, 0, 0);
-            ++indDrawVert;
-            m_grid[indDrawVert] = sf::Vertex(sf::Vector2f(ix * hx, height));
-            m_grid[indDrawVert].color = sf::Color(64, 0, 0);
-            ++indDrawVert;
-        }
-        for (std::size_t jy = 0; jy <= nbCells.second; ++jy) {
-            m_grid[indDrawVert] = sf::Vertex(sf::Vector2f(0, jy * hy));
-            m_grid[indDrawVert].color = sf::Color(64, 0, 0);
-            ++indDrawVert;
-            m_grid[indDrawVert] = sf::Vertex(sf::Vector2f(width, jy * hy));
-            m_grid[indDrawVert].color = sf::Color(64, 0, 0);
-            ++indDrawVert;
+    // Texture et flèches reconstruites seulement quand le champ a changé
+    if (!m_hasField || m_fieldGeneration != grid.generation()) {
+        if (m_field.getSize().x != nbCells.first || m_field.getSize().y != nbCells.second)
+            m_field.create(nbCells.first, nbCells.second);
+        m_field.update(velocityColors(grid).data());
+
+        auto arrows = velocityArrows(grid, m_nbArrows);
+        m_arrows.setPrimitiveType(sf::Lines);
+        m_arrows.resize(2 * arrows.size());
+        for (std::size_t iArrow = 0; iArrow < arrows.size(); ++iArrow) {
+            const auto & arrow = arrows[iArrow];
+            m_arrows[2 * iArrow] =
+                sf::Vertex(sf::Vector2f(arrow.x * hx, arrow.y * hy), sf::Color(0, 0, 127));
+            m_arrows[2 * iArrow + 1] =
+                sf::Vertex(sf::Vector2f((arrow.x + arrow.dx) * hx, (arrow.y + arrow.dy) * hy),
+                           sf::Color(255, 255, 255));
         }
+        m_fieldGeneration = grid.generation();
+        m_hasField = true;
     }
+    // Une ligne de texture par ligne de cellules, la première en haut
+    sf::Sprite sprite(m_field);
+    sprite.setScale(float(hx), float(hy));
+    m_window.draw(sprite);
+    m_window.draw(m_arrows);
+    drawVortices(grid, vortices, scalex, scaley);
+    m_window.setView(m_window.getDefaultView());
+}
+//-----------------------------------------------------------------------------------------------------------
+void Graphisme::Screen::displayFtle(const Numeric::FtleField & t_ftle,
+                                    const Numeric::CartesianGridOfSpeed & grid,
+                                    const Simulation::Vortices & vortices) {
+    using vector = Geometry::Vector<double>;
+    m_window.setView(m_velocityView);
+    auto screenSize = m_velocityView.getSize();
+    std::size_t width = screenSize.x - 1;
+    std::size_t height = screenSize.y - 1;
 
-    if (m_velocity.getVertexCount() == 0) {
-        m_velocity = sf::VertexArray(sf::Lines, 2 * nbCells.first * nbCells.second);
-    }
+    vector domainDimension { grid.getLeftBottomVertex(), grid.getRightTopVertex() };
+    double scalex = width / domainDimension.x;
+    double scaley = height / domainDimension.y;
 
-// Affichage des vecteurs :
-#pragma omp parallel for
-    for (std::size_t jy = 0; jy < nbCells.second; ++jy) {
-        for (std::size_t ix = 0; ix < nbCells.first; ++ix) {
-            std::size_t indDrawVert = 2 * (jy * nbCells.first + ix);
-            double xdeb = (ix + 0.5) * hx;
-            double ydeb = (jy + 0.5) * hy;
-            double xfin = xdeb + scalex * grid.getVelocity(jy, ix).x;
-            double yfin = ydeb + scaley * grid.getVelocity(jy, ix).y;
-            m_velocity[indDrawVert] = sf::Vertex(sf::Vector2f(xdeb, ydeb));
-            m_velocity[indDrawVert].color = sf::Color(0, 0, 127);
-            ++indDrawVert;
-            m_velocity[indDrawVert] = sf::Vertex(sf::Vector2f(xfin, yfin));
-            m_velocity[indDrawVert].color = sf::Color(255, 255, 255);
-            ++indDrawVert;
-        }
-    }
-    m_window.draw(m_grid);
-    m_window.draw(m_velocity);
-    // Affichage des vortices :
-    for (std::size_t iVort = 0; iVort < vortices.numberOfVortices(); ++iVort) {
-        auto c = vortices.getCenter(iVort);
-        sf::CircleShape shape { 5 };
-        shape.setPosition(scalex * (c.x - grid.getLeftBottomVertex().x) - 5,
-                          scaley * (c.y - grid.getLeftBottomVertex().y) - 5);
-        shape.setFillColor(sf::Color::Red);
-        m_window.draw(shape);
+    if (m_ftle.getSize().x != t_ftle.width || m_ftle.getSize().y != t_ftle.height) {
+        m_ftle.create(t_ftle.width, t_ftle.height);
+        m_ftle.update(ftleColors(t_ftle).data());
     }
+    // Une ligne de texture par ligne de graines, la première en haut comme
+    // la première ligne de cellules du champ de vitesse
+    sf::Sprite sprite(m_ftle);
+    sprite.setScale(float(scalex * t_ftle.hx), float(scaley * t_ftle.hy));
+    m_window.draw(sprite);
+    drawVortices(grid, vortices, scalex, scaley);
     m_window.setView(m_window.getDefaultView());
 }
 //-----------------------------------------------------------------------------------------------------------
 void Graphisme::Screen::displayParticles(const Numeric::CartesianGridOfSpeed & grid,
                                          const Simulation::Vortices & vortices,
                                          const Geometry::CloudOfPoints & points) {
-    using vector = Numeric::CartesianGridOfSpeed::vector;
+    using vector = Geometry::Vector<double>;
     m_window.setView(m_particlesView);
     // Affichage moité gauche de l'écran :
     auto screenSize = m_particlesView.getSize();
@@ -114,10 +119,12 @@ void Graphisme::Screen::displayParticles(const Numeric::CartesianGridOfSpeed & g
     double scalex = width / domainDimension.x;
     double scaley = height / domainDimension.y;
 
-    if (m_particles.getVertexCount() == 0) {
-        m_particles = sf::VertexArray(sf::Points, points.numberOfPoints());
+    // Le nombre de particules peut varier d'une image à l'autre (émetteurs et
+    // puits)
+    if (m_particles.getVertexCount() != points.numberOfPoints()) {
+        m_particles.setPrimitiveType(sf::Points);
+        m_particles.resize(points.numberOfPoints());
     }
-    assert(m_particles.getVertexCount() == points.numberOfPoints());
     // Affichage des particules en 3/4 transparents :
 
 #pragma omp parallel for
@@ -127,17 +134,77 @@ void Graphisme::Screen::displayParticles(const Numeric::CartesianGridOfSpeed & g
                            float(scaley * (points[iPt].y - grid.getLeftBottomVertex().y)) };
         m_particles[iPt].color = sf::Color(255, 255, 255, 128);
     }
+    if (m_trails && m_trails->record(points, grid)) {
+        double t0 = omp_get_wtime();
+        const auto & segments = m_trails->segments();
+        auto bottomLeft = grid.getLeftBottomVertex();
+#pragma omp parallel for
+        for (std::size_t iSegment = 0; iSegment < segments.size(); ++iSegment) {
+            const auto & segment = segments[iSegment];
+            // Les segments non tracés restent dans le tableau, transparents
+            sf::Color color(0, 191, 255, segment.alpha);
+            m_trailLines[2 * iSegment] = sf::Vertex(
+                sf::Vector2f(float(scalex * (segment.a.x - bottomLeft.x)),
+                             float(scaley * (segment.a.y - bottomLeft.y))),
+                color);
+            m_trailLines[2 * iSegment + 1] = sf::Vertex(
+                sf::Vector2f(float(scalex * (segment.b.x - bottomLeft.x)),
+                             float(scaley * (segment.b.y - bottomLeft.y))),
+                color);
+        }
+        m_trailsTiming = m_trails->timing();
+        m_trailsTiming.seconds += omp_get_wtime() - t0;
+    }
+    if (m_trails)
+        m_window.draw(m_trailLines);
     m_window.draw(m_particles);
-    // Affichage des vortices :
+    drawVortices(grid, vortices, scalex, scaley);
+    m_window.setView(m_window.getDefaultView());
+}
+//-----------------------------------------------------------------------------------------------------------
+void Graphisme::Screen::setTrails(std::size_t t_nbTrails, std::size_t t_length) {
+    if (t_nbTrails == 0) {
+        m_trails.reset();
+        m_trailLines.clear();
+        return;
+    }
+    m_trails.emplace(t_nbTrails, t_length);
+    // Deux sommets par segment, alloués une fois pour toutes
+    m_trailLines.setPrimitiveType(sf::Lines);
+    m_trailLines.resize(2 * m_trails->segments().size());
+    for (std::size_t iVertex = 0; iVertex < m_trailLines.getVertexCount(); ++iVertex)
+        m_trailLines[iVertex].color = sf::Color::Transparent;
+    m_trailsTiming = ParticleTrails::Timing();
+}
+//-----------------------------------------------------------------------------------------------------------
+void Graphisme::Screen::drawVortices(const Numeric::CartesianGridOfSpeed & grid,
+                                     const Simulation::Vortices & vortices,
+                                     double scalex,
+                                     double scaley) {
+    // Disques de rayon 5, en éventails de triangles
+    constexpr std::size_t nbSides = 16;
+    constexpr double radius = 5.;
+    if (m_vortices.getVertexCount() != 3 * nbSides * vortices.numberOfVortices()) {
+        m_vortices.setPrimitiveType(sf::Triangles);
+        m_vortices.resize(3 * nbSides * vortices.numberOfVortices());
+    }
     for (std::size_t iVort = 0; iVort < vortices.numberOfVortices(); ++iVort) {
         auto c = vortices.getCenter(iVort);
-        sf::CircleShape shape { 5 };
-        shape.setPosition(scalex * (c.x - grid.getLeftBottomVertex().x) - 5,
-                          scaley * (c.y - grid.getLeftBottomVertex().y) - 5);
-        shape.setFillColor(sf::Color::Red);
-        m_window.draw(shape);
+        float cx = float(scalex * (c.x - grid.getLeftBottomVertex().x));
+        float cy = float(scaley * (c.y - grid.getLeftBottomVertex().y));
+        for (std::size_t iSide = 0; iSide < nbSides; ++iSide) {
+            double a0 = 2. * M_PI * iSide / nbSides, a1 = 2. * M_PI * (iSide + 1) / nbSides;
+            std::size_t index = 3 * (iVort * nbSides + iSide);
+            m_vortices[index] = sf::Vertex(sf::Vector2f(cx, cy), sf::Color::Red);
+            m_vortices[index + 1] = sf::Vertex(
+                sf::Vector2f(cx + radius * std::cos(a0), cy + radius * std::sin(a0)),
+                sf::Color::Red);
+            m_vortices[index + 2] = sf::Vertex(
+                sf::Vector2f(cx + radius * std::cos(a1), cy + radius * std::sin(a1)),
+                sf::Color::Red);
+        }
     }
-    m_window.setView(m_window.getDefaultView());
+    m_window.draw(m_vortices);
 }
 //
 void Graphisme::Screen::drawText(const std::string & t_string,
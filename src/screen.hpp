@@ -2,11 +2,15 @@
 #define _GRAPHISM_SCREEN_HPP_
 #include "cartesian_grid_of_speed.hpp"
 #include "cloud_of_points.hpp"
+#include "ftle.hpp"
+#include "particle_trails.hpp"
 #include "vortex.hpp"
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 #include <SFML/Window/Window.hpp>
+#include <cstdint>
+#include <optional>
 #include <utility>
 
 namespace Graphisme {
@@ -21,15 +25,56 @@ namespace Graphisme {
 
         void close() { m_window.close(); }
 
+        /**
+         * @brief Display the velocity field, with the vortices
+         *
+         * The field is drawn as a texture of one pixel per cell (see
+         * velocityColors), under decimated arrows (see velocityArrows). Both
+         * are only rebuilt when the generation of the field changed : with
+         * fixed vortices, the cost of a frame does not depend on the size of
+         * the grid.
+         */
         void displayVelocityField(const Numeric::CartesianGridOfSpeed & grid,
                                   const Simulation::Vortices & vortices);
+        /// Number of arrows per row drawn over the velocity field (0 : none)
+        void setFieldArrows(std::size_t t_nbArrows) {
+            m_nbArrows = t_nbArrows;
+            m_hasField = false;
+        }
+        /**
+         * @brief Display a FTLE field in place of the velocity field
+         *
+         * The field is drawn as a texture of one pixel per seed, colored from
+         * black (FTLE <= 0) to white (largest FTLE) through red and yellow.
+         * The texture is only built at the first call : the field is not
+         * expected to change.
+         */
+        void displayFtle(const Numeric::FtleField & t_ftle,
+                         const Numeric::CartesianGridOfSpeed & grid,
+                         const Simulation::Vortices & vortices);
+        /**
+         * @brief Display the particles, with the vortices, and the trails of
+         * the traced particles if any (see setTrails)
+         */
         void displayParticles(const Numeric::CartesianGridOfSpeed & grid,
                               const Simulation::Vortices & vortices,
                               const Geometry::CloudOfPoints & points);
+        /**
+         * @brief Draw the last t_length positions of t_nbTrails particles
+         * behind them (see ParticleTrails), nothing if t_nbTrails is zero
+         */
+        void setTrails(std::size_t t_nbTrails, std::size_t t_length);
+        /**
+         * @brief Cost of the last update of the trails (record and vertices),
+         * nullptr without trails
+         */
+        const ParticleTrails::Timing * trailsTiming() const {
+            return m_trails ? &m_trailsTiming : nullptr;
+        }
 
         void clear(sf::Color t_color) { m_window.clear(t_color); }
 
-        void resize(sf::Event & event) {
+        void resize(const sf::Event & event) {
             sf::FloatRect visibleArea(0.f, 0.f, event.size.width, event.size.height);
             m_window.setView(sf::View(visibleArea));
         }
@@ -43,12 +88,30 @@ namespace Graphisme {
         void display() { m_window.display(); }
 
     private:
+        /**
+         * @brief Draw all the vortices in the current view, as red discs in
+         * a single vertex array
+         */
+        void drawVortices(const Numeric::CartesianGridOfSpeed & grid,
+                          const Simulation::Vortices & vortices,
+                          double scalex,
+                          double scaley);
+
         sf::RenderWindow m_window;
         sf::Font m_font;
         sf::View m_velocityView, m_particlesView;
-        sf::VertexArray m_grid;      /// Grid display
-        sf::VertexArray m_velocity;  /// Velocity display
+        sf::Texture m_field;         /// Velocity display
+        sf::VertexArray m_arrows;    /// Arrows over the velocity display
+        sf::VertexArray m_vortices;  /// Vortices display
         sf::VertexArray m_particles; /// Particles display
+        sf::VertexArray m_trailLines; /// Trails display
+        std::optional<ParticleTrails> m_trails;
+        ParticleTrails::Timing m_trailsTiming;
+        sf::Texture m_ftle;          /// FTLE display
+        /// Generation of the displayed velocity field
+        std::uint64_t m_fieldGeneration = 0;
+        bool m_hasField = false;
+        std::size_t m_nbArrows = 32;
     };
 } // namespace Graphisme
 
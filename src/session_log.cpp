@@ -0,0 +1,108 @@
+#include "session_log.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace Simulation;
+
+namespace {
+    constexpr char sessionMagic[] = "vortex-session";
+} // namespace
+
+SessionRecorder::SessionRecorder(const std::string & t_fileName)
+    : m_output(t_fileName), m_start(std::chrono::steady_clock::now()) {
+    if (!m_output)
+        std::cerr << "Cannot open " << t_fileName << ", the session is not recorded" << std::endl;
+    m_output << sessionMagic << " 1" << std::endl << "# step seconds order" << std::endl;
+}
+
+void SessionRecorder::record(std::size_t t_step, UiEvent t_event) {
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - m_start;
+    m_output << t_step << ' ' << std::fixed << std::setprecision(3) << seconds.count() << ' '
+             << t_event << std::endl;
+}
+
+SessionReplay::SessionReplay(const std::string & t_fileName) {
+    std::ifstream input(t_fileName);
+    if (!input)
+        throw std::runtime_error("Cannot open " + t_fileName);
+    std::size_t lineNumber = 0;
+    auto fail = [&](const std::string & t_message) {
+        throw std::runtime_error(t_fileName + ":" + std::to_string(lineNumber) + ": "
+                                 + t_message);
+    };
+    bool hasHeader = false;
+    std::string text;
+    while (std::getline(input, text)) {
+        ++lineNumber;
+        std::string content = text.substr(0, text.find('#'));
+        std::istringstream line(content);
+        std::string first;
+        if (!(line >> first))
+            continue;
+        if (!hasHeader) {
+            int version = 0;
+            if (first != sessionMagic || !(line >> version) || version != 1)
+                fail(std::string("expected ") + sessionMagic + " 1");
+            hasHeader = true;
+            continue;
+        }
+        Order order;
+        std::string name, extra;
+        std::istringstream values(content);
+        if (!(values >> order.step >> order.seconds >> name) || values >> extra)
+            fail("expected <step> <seconds> <order>");
+        order.event = parseUiEvent(name);
+        if (order.event == UiEvent::Noop)
+            fail("unknown order " + name);
+        if (!m_orders.empty() && order.step < m_orders.back().step)
+            fail("orders not sorted by step");
+        m_orders.push_back(order);
+    }
+    if (!hasHeader)
+        throw std::runtime_error(t_fileName + ": empty session log");
+}
+
+bool SessionReplay::apply(std::size_t t_step, SimulationControl & t_control) {
+    if (m_isOver)
+        return false;
+    if (m_start == std::chrono::steady_clock::time_point {})
+        m_start = std::chrono::steady_clock::now();
+    bool isClosed = false;
+    while (!isClosed && m_next < m_orders.size() && m_orders[m_next].step <= t_step) {
+        const Order & order = m_orders[m_next++];
+        isClosed = order.event == UiEvent::CloseWindow;
+        if (!isClosed)
+            t_control.apply(order.event);
+    }
+    // Sans pas à calculer, aucun ordre suivant ne peut être atteint ; un
+    // journal interrompu s'arrête à son dernier ordre
+    if (isClosed || !t_control.mustStep() || m_next == m_orders.size()) {
+        m_isOver = true;
+        m_lastStep = t_step;
+        m_end = std::chrono::steady_clock::now();
+        t_control.animate = t_control.advance = false;
+    }
+    return !m_isOver;
+}
+
+SimulationControl SessionReplay::controlAt(std::size_t t_step) const {
+    SimulationControl control;
+    for (const Order & order : m_orders) {
+        if (order.step > t_step)
+            break;
+        if (!(order.event == UiEvent::CloseWindow))
+            control.apply(order.event);
+    }
+    return control;
+}
+
+std::ostream & Simulation::operator<<(std::ostream & os, const SessionReplay & t_replay) {
+    std::chrono::duration<double> replayed = t_replay.m_end - t_replay.m_start;
+    double recorded = t_replay.m_next > 0 ? t_replay.m_orders[t_replay.m_next - 1].seconds : 0.;
+    os << t_replay.m_next << " orders replayed over " << t_replay.m_lastStep << " steps in "
+       << replayed.count() << " s (recorded session : " << recorded << " s)";
+    return os;
+}
@@ -0,0 +1,106 @@
+#ifndef _SIMULATION_SESSION_LOG_HPP_
+#define _SIMULATION_SESSION_LOG_HPP_
+#include "interactive.hpp"
+#include "ui_events.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Simulation {
+    /**
+     * @brief Log of the orders of the user applied by the simulation, so that
+     * an interactive session can be replayed step by step
+     *
+     * The orders are logged by the simulation side, where they are applied
+     * between two time steps : the step index of an order is exact, whatever
+     * the delays of the window and of the messages. The log is a text file
+     * whose first line is "vortex-session 1", then one line per order :
+     *
+     *     <step> <seconds> <order>
+     *
+     * where step is the number of time steps computed when the order was
+     * applied, seconds the time elapsed since the start of the session and
+     * order the name of the UiEvent. Each line is flushed, so the log of an
+     * interrupted session is usable.
+     */
+    class SessionRecorder {
+    public:
+        explicit SessionRecorder(const std::string & t_fileName);
+
+        void record(std::size_t t_step, UiEvent t_event);
+
+    private:
+        std::ofstream m_output;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    /**
+     * @brief Orders of a session logged by SessionRecorder, given back to the
+     * simulation at the same steps
+     *
+     * The same scenario and options give the same time steps, whatever the
+     * speed of the machine and of the display. The recorded CloseWindow is
+     * not applied : it ends the replay, which stops the animation.
+     */
+    class SessionReplay {
+    public:
+        struct Order {
+            std::size_t step;
+            double seconds;
+            UiEvent event;
+        };
+
+        /**
+         * @brief Read a log, throw std::runtime_error with the file and the
+         * line if it cannot be read or is malformed
+         */
+        explicit SessionReplay(const std::string & t_fileName);
+
+        /**
+         * @brief Apply to t_control the orders recorded once t_step steps
+         * were computed
+         *
+         * The replay is over at the recorded CloseWindow, after the last
+         * order of a log without it (interrupted session), or when t_control
+         * no longer computes steps while the next order is recorded at a
+         * later step (inconsistent log).
+         *
+         * @return false once the replay is over
+         */
+        bool apply(std::size_t t_step, SimulationControl & t_control);
+
+        /**
+         * @brief State of a control given all the orders recorded up to step
+         * t_step, for the display of a replayed session
+         */
+        SimulationControl controlAt(std::size_t t_step) const;
+        /// Number of steps computed when the last order was recorded
+        std::size_t recordedSteps() const { return m_orders.empty() ? 0 : m_orders.back().step; }
+
+        bool isOver() const { return m_isOver; }
+        /// Number of steps computed when the replay ended
+        std::size_t lastStep() const { return m_lastStep; }
+
+        friend std::ostream & operator<<(std::ostream & os, const SessionReplay & t_replay);
+
+    private:
+        std::vector<Order> m_orders;
+        std::size_t m_next = 0;
+        bool m_isOver = false;
+        std::size_t m_lastStep = 0;
+        /// Start of the replay (first call to apply) and end
+        std::chrono::steady_clock::time_point m_start, m_end;
+    };
+
+    /**
+     * @brief Summary of a replay : orders, steps and durations of the
+     * recorded and replayed sessions
+     */
+    std::ostream & operator<<(std::ostream & os, const SessionReplay & t_replay);
+} // namespace Simulation
+
+#endif
@@ -0,0 +1,184 @@
+#include "shared_frame.hpp"
+
+#include "tracer.hpp"
+#include "triple_buffer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <vector>
+
+using namespace Simulation;
+
+struct SharedFrame::Header {
+    std::atomic<std::uint8_t> state;
+    std::uint64_t steps[3];
+    std::uint64_t nbPoints[3];
+    /// Generation of the velocity field of each slot
+    std::uint64_t generations[3];
+};
+
+namespace {
+    constexpr std::size_t alignment = 64;
+
+    std::size_t alignUp(std::size_t t_bytes) {
+        return (t_bytes + alignment - 1) / alignment * alignment;
+    }
+} // namespace
+
+SharedFrame::SharedFrame(MPI_Comm t_comm,
+                         int t_simRank,
+                         int t_screenRank,
+                         bool t_enable,
+                         const Vortices & t_vortices,
+                         const Numeric::CartesianGridOfSpeed & t_grid,
+                         const Geometry::CloudOfPoints & t_cloud,
+                         std::size_t t_capacity) {
+    using point = Geometry::CloudOfPoints::point;
+    using vector = Numeric::CartesianGridOfSpeed::vector;
+    if (!t_enable)
+        return;
+
+    int rank, size;
+    MPI_Comm_rank(t_comm, &rank);
+    MPI_Comm_size(t_comm, &size);
+
+    // Les deux processus sont sur le même nœud s'ils ont le même représentant
+    // dans le communicateur des processus partageant la mémoire
+    MPI_Comm nodeComm;
+    MPI_Comm_split_type(t_comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &nodeComm);
+    int leader = rank;
+    MPI_Bcast(&leader, 1, MPI_INT, 0, nodeComm);
+    MPI_Comm_free(&nodeComm);
+    std::vector<int> leaders(size);
+    MPI_Allgather(&leader, 1, MPI_INT, leaders.data(), 1, MPI_INT, t_comm);
+    if (leaders[t_simRank] != leaders[t_screenRank])
+        return;
+
+    bool isSim = rank == t_simRank;
+    bool participates = isSim || rank == t_screenRank;
+    MPI_Comm_split(t_comm, participates ? 0 : MPI_UNDEFINED, isSim ? 0 : 1, &m_pairComm);
+    if (!participates)
+        return;
+
+    auto dimensions = t_grid.cellGeometry();
+    std::size_t nbCells = dimensions.first * dimensions.second;
+    std::size_t nbPoints = t_cloud.numberOfPoints();
+    std::size_t capacity = std::max(nbPoints, t_capacity);
+    m_nbVortices = t_vortices.numberOfVortices();
+
+    m_vorticesOffset = 0;
+    m_fieldOffset = alignUp(3 * m_nbVortices * sizeof(double));
+    m_particlesOffset = m_fieldOffset + alignUp(nbCells * sizeof(vector));
+    m_slotBytes = m_particlesOffset + alignUp(capacity * sizeof(point));
+    std::size_t totalBytes = alignUp(sizeof(Header)) + 3 * m_slotBytes;
+
+    // Seul le processus de calcul alloue, l'affichage récupère l'adresse de
+    // son segment
+    MPI_Win_allocate_shared(isSim ? totalBytes : 0, 1, MPI_INFO_NULL, m_pairComm, &m_base,
+                            &m_window);
+    if (!isSim) {
+        MPI_Aint segmentSize;
+        int dispUnit;
+        MPI_Win_shared_query(m_window, 0, &segmentSize, &dispUnit, &m_base);
+    }
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, m_window);
+
+    char * slots = static_cast<char *>(m_base) + alignUp(sizeof(Header));
+    m_clouds.reserve(3);
+    m_grids.reserve(3);
+    for (std::size_t iSlot = 0; iSlot < 3; ++iSlot) {
+        char * slot = slots + iSlot * m_slotBytes;
+        m_clouds.emplace_back(nbPoints,
+                              Geometry::CloudOfPoints::allocator_type(
+                                  slot + m_particlesOffset, capacity * sizeof(point)),
+                              capacity);
+        m_grids.emplace_back(dimensions, t_grid.getLeftBottomVertex(), t_grid.getStep(),
+                             Numeric::CartesianGridOfSpeed::allocator_type(
+                                 slot + m_fieldOffset, nbCells * sizeof(vector)));
+    }
+
+    if (isSim) {
+        Header * head = ::new (m_base) Header;
+        head->state.store(TripleBufferState::initial());
+        std::fill(std::begin(head->steps), std::end(head->steps), 0);
+        std::fill(std::begin(head->nbPoints), std::end(head->nbPoints), nbPoints);
+        std::fill(std::begin(head->generations), std::end(head->generations),
+                  t_grid.generation());
+        for (std::size_t iSlot = 0; iSlot < 3; ++iSlot) {
+            std::copy(t_cloud.begin(), t_cloud.end(), m_clouds[iSlot].begin());
+            m_grids[iSlot].copyVelocityFieldFrom(t_grid);
+            double * vortices = slotVortices(iSlot);
+            for (std::size_t iVortex = 0; iVortex < m_nbVortices; ++iVortex) {
+                vortices[3 * iVortex + 0] = t_vortices.getCenter(iVortex).x;
+                vortices[3 * iVortex + 1] = t_vortices.getCenter(iVortex).y;
+                vortices[3 * iVortex + 2] = t_vortices.getIntensity(iVortex);
+            }
+        }
+    }
+    MPI_Win_sync(m_window);
+    MPI_Barrier(m_pairComm);
+    MPI_Win_sync(m_window);
+    if (!isSim) {
+        for (std::size_t iSlot = 0; iSlot < 3; ++iSlot)
+            m_grids[iSlot].setGeneration(header().generations[iSlot]);
+    }
+}
+
+SharedFrame::~SharedFrame() {
+    if (m_window != MPI_WIN_NULL) {
+        MPI_Win_unlock_all(m_window);
+        MPI_Win_free(&m_window);
+    }
+    if (m_pairComm != MPI_COMM_NULL)
+        MPI_Comm_free(&m_pairComm);
+}
+
+double * SharedFrame::slotVortices(std::size_t t_slot) const {
+    char * slot = static_cast<char *>(m_base) + alignUp(sizeof(Header)) + t_slot * m_slotBytes;
+    return reinterpret_cast<double *>(slot + m_vorticesOffset);
+}
+
+void SharedFrame::publish(const Vortices & t_vortices,
+                          const Numeric::CartesianGridOfSpeed & t_grid,
+                          bool fieldChanged,
+                          std::size_t t_step) {
+    Trace::Scope scope("publish frame", "shm");
+    if (fieldChanged) {
+        double * vortices = slotVortices(m_back);
+        for (std::size_t iVortex = 0; iVortex < m_nbVortices; ++iVortex) {
+            vortices[3 * iVortex + 0] = t_vortices.getCenter(iVortex).x;
+            vortices[3 * iVortex + 1] = t_vortices.getCenter(iVortex).y;
+        }
+        m_grids[m_back].copyVelocityFieldFrom(t_grid);
+        header().generations[m_back] = t_grid.generation();
+    }
+    header().steps[m_back] = t_step;
+    header().nbPoints[m_back] = m_clouds[m_back].numberOfPoints();
+    MPI_Win_sync(m_window);
+    m_lastPublished = m_back;
+    m_back = TripleBufferState::publish(header().state, m_back);
+}
+
+bool SharedFrame::update() {
+    MPI_Win_sync(m_window);
+    if (!TripleBufferState::acquire(header().state, m_front))
+        return false;
+    // Les points ajoutés ne sont pas initialisés : ils sont déjà écrits dans
+    // la fenêtre
+    m_clouds[m_front].resize(header().nbPoints[m_front]);
+    // Le champ de l'emplacement n'a pas forcément changé : sa génération le
+    // dit à l'affichage
+    m_grids[m_front].setGeneration(header().generations[m_front]);
+    return true;
+}
+
+void SharedFrame::readVortices(Vortices & t_vortices) const {
+    const double * vortices = slotVortices(m_front);
+    for (std::size_t iVortex = 0; iVortex < m_nbVortices; ++iVortex) {
+        t_vortices.setVortex(iVortex, { vortices[3 * iVortex + 0], vortices[3 * iVortex + 1] },
+                             vortices[3 * iVortex + 2]);
+    }
+}
+
+std::size_t SharedFrame::frontStep() const { return header().steps[m_front]; }
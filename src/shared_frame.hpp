@@ -0,0 +1,134 @@
+#ifndef _SIMULATION_SHARED_FRAME_HPP_
+#define _SIMULATION_SHARED_FRAME_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "cloud_of_points.hpp"
+#include "vortex.hpp"
+
+#include <cstdint>
+#include <mpi.h>
+#include <vector>
+
+namespace Simulation {
+    /**
+     * @brief State of the simulation shared between the simulation process and
+     * the screen process when they run on the same node
+     *
+     * The vortices, the velocity field and the particles are stored in three
+     * slots of a MPI shared memory window (MPI_Win_allocate_shared), exchanged
+     * as a lock-free triple buffer (see TripleBufferState) whose state lives in
+     * the window too. The simulation process computes the new positions of the
+     * particles directly in its back slot and publishes it, the screen process
+     * displays its front slot in place : no message nor copy of the particles
+     * is needed.
+     *
+     * When the two processes are on different nodes, isShared() returns false
+     * and the caller must fall back to message passing.
+     */
+    class SharedFrame {
+    public:
+        /**
+         * @brief Build the shared window (collective over t_comm)
+         *
+         * @param t_comm       Communicator containing both processes
+         * @param t_simRank    Rank of the simulation process in t_comm
+         * @param t_screenRank Rank of the screen process in t_comm
+         * @param t_enable     If false, never share memory (every process must
+         *                     pass the same value)
+         * @param t_vortices   Initial vortices
+         * @param t_grid       Initial velocity field
+         * @param t_cloud      Initial particles
+         * @param t_capacity   Maximal number of particles of a frame
+         */
+        SharedFrame(MPI_Comm t_comm,
+                    int t_simRank,
+                    int t_screenRank,
+                    bool t_enable,
+                    const Vortices & t_vortices,
+                    const Numeric::CartesianGridOfSpeed & t_grid,
+                    const Geometry::CloudOfPoints & t_cloud,
+                    std::size_t t_capacity);
+        SharedFrame(const SharedFrame &) = delete;
+        SharedFrame & operator=(const SharedFrame &) = delete;
+        /**
+         * @brief Free the window (collective)
+         */
+        ~SharedFrame();
+
+        /**
+         * @brief Whether the two processes share the frame
+         */
+        bool isShared() const { return m_window != MPI_WIN_NULL; }
+
+        //@name Simulation process side
+        //@{
+        /**
+         * @brief Particles of the slot to write
+         */
+        Geometry::CloudOfPoints & backCloud() { return m_clouds[m_back]; }
+        /**
+         * @brief Particles of the last published slot (read only, the screen
+         * may be displaying them)
+         */
+        const Geometry::CloudOfPoints & lastPublishedCloud() const {
+            return m_clouds[m_lastPublished];
+        }
+        /**
+         * @brief Complete the back slot and publish it
+         *
+         * @param t_vortices    Vortices at the end of the step
+         * @param t_grid        Velocity field at the end of the step
+         * @param fieldChanged  Whether the field (and the vortices) must be
+         *                      copied in the slot
+         * @param t_step        Number of the time step
+         */
+        void publish(const Vortices & t_vortices,
+                     const Numeric::CartesianGridOfSpeed & t_grid,
+                     bool fieldChanged,
+                     std::size_t t_step);
+        //@}
+
+        //@name Screen process side
+        //@{
+        /**
+         * @brief Switch to the newest published slot, if any
+         *
+         * The front cloud is resized to the number of particles of the slot.
+         *
+         * @return true if a new frame is available
+         */
+        bool update();
+        const Geometry::CloudOfPoints & frontCloud() const { return m_clouds[m_front]; }
+        const Numeric::CartesianGridOfSpeed & frontGrid() const { return m_grids[m_front]; }
+        /**
+         * @brief Copy the vortices of the front slot
+         */
+        void readVortices(Vortices & t_vortices) const;
+        std::size_t frontStep() const;
+        //@}
+
+    private:
+        struct Header;
+
+        Header & header() const { return *static_cast<Header *>(m_base); }
+        double * slotVortices(std::size_t t_slot) const;
+
+        MPI_Comm m_pairComm = MPI_COMM_NULL;
+        MPI_Win m_window = MPI_WIN_NULL;
+        void * m_base = nullptr;
+        std::size_t m_nbVortices = 0;
+        std::size_t m_vorticesOffset = 0, m_fieldOffset = 0, m_particlesOffset = 0;
+        std::size_t m_slotBytes = 0;
+
+        // Vues sur les trois emplacements de la fenêtre, construites sur
+        // place : une affectation ne les lierait pas à leur emplacement
+        std::vector<Geometry::CloudOfPoints> m_clouds;
+        std::vector<Numeric::CartesianGridOfSpeed> m_grids;
+
+        // Côté calcul
+        std::uint8_t m_back = 0, m_lastPublished = 2;
+        // Côté affichage
+        std::uint8_t m_front = 2;
+    };
+} // namespace Simulation
+
+#endif
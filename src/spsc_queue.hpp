@@ -0,0 +1,53 @@
+#ifndef _SPSC_QUEUE_HPP_
+#define _SPSC_QUEUE_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+/**
+ * @brief Bounded lock-free queue for one producer thread and one consumer
+ * thread
+ *
+ * @tparam T        Type of the elements (should be cheap to copy)
+ * @tparam Capacity Maximal number of elements waiting in the queue
+ */
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+public:
+    /**
+     * @brief Push an element (producer side)
+     *
+     * @return false if the queue is full, the element is then dropped
+     */
+    bool push(const T & t_value) {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        std::size_t next = (tail + 1) % (Capacity + 1);
+        if (next == m_head.load(std::memory_order_acquire))
+            return false;
+        m_elements[tail] = t_value;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pop the oldest element (consumer side)
+     */
+    std::optional<T> pop() {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return std::nullopt;
+        T value = m_elements[head];
+        m_head.store((head + 1) % (Capacity + 1), std::memory_order_release);
+        return value;
+    }
+
+private:
+    std::array<T, Capacity + 1> m_elements;
+    // Sur des lignes de cache différentes pour éviter le faux partage
+    alignas(64) std::atomic<std::size_t> m_head { 0 };
+    alignas(64) std::atomic<std::size_t> m_tail { 0 };
+};
+
+#endif
@@ -0,0 +1,294 @@
+#include "step_pipeline.hpp"
+
+#include "runge_kutta.hpp"
+#include "tracer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <omp.h>
+#include <ostream>
+
+using namespace Numeric;
+
+void StepPipeline::step(double dt,
+                        CartesianGridOfSpeed & t_velocity,
+                        Simulation::Vortices & t_vortices,
+                        Geometry::CloudOfPoints & t_points,
+                        bool isMobile,
+                        bool isDisplayFrame) {
+    step(dt, t_velocity, t_vortices, t_points, m_newPoints, isMobile, isDisplayFrame);
+    std::swap(t_points, m_newPoints);
+}
+
+bool StepPipeline::isDirect(double dt,
+                            const CartesianGridOfSpeed & t_velocity,
+                            const Simulation::Vortices & t_vortices,
+                            const Geometry::CloudOfPoints & t_points,
+                            Geometry::CloudOfPoints & t_newPoints) {
+    if (m_velocitySource != VelocitySource::Automatic)
+        return m_velocitySource == VelocitySource::Direct;
+
+    std::size_t nbVortices = t_vortices.numberOfVortices();
+    if (m_gridCost == 0.) {
+        // Mesure sur un échantillon des particules (les nouvelles positions
+        // seront écrasées par le pas lui-même), en gardant le meilleur de
+        // quelques essais
+        constexpr std::size_t sampleSize = 2048;
+        constexpr int nbTrials = 3;
+        std::size_t nbSamples = std::min(sampleSize, t_points.numberOfPoints());
+        if (nbSamples == 0 || nbVortices == 0)
+            return false;
+        double gridTime = 0., directTime = 0.;
+        for (int iTrial = 0; iTrial < nbTrials; ++iTrial) {
+            double t0 = omp_get_wtime();
+            solve_particles(m_scheme, dt, t_velocity, t_points, t_newPoints, 0, nbSamples);
+            double t1 = omp_get_wtime();
+            solve_particles_direct(m_scheme, dt, t_vortices, t_velocity, t_points, t_newPoints, 0,
+                                   nbSamples);
+            double t2 = omp_get_wtime();
+            gridTime = iTrial == 0 ? t1 - t0 : std::min(gridTime, t1 - t0);
+            directTime = iTrial == 0 ? t2 - t1 : std::min(directTime, t2 - t1);
+        }
+        m_gridCost = std::max(gridTime, 1.E-12) / nbSamples;
+        m_directCostPerVortex = directTime / (nbSamples * nbVortices);
+    }
+    return nbVortices * m_directCostPerVortex < m_gridCost;
+}
+
+void StepPipeline::step(double dt,
+                        CartesianGridOfSpeed & t_velocity,
+                        Simulation::Vortices & t_vortices,
+                        const Geometry::CloudOfPoints & t_points,
+                        Geometry::CloudOfPoints & t_newPoints,
+                        bool isMobile,
+                        bool isDisplayFrame) {
+    std::size_t nbPoints = t_points.numberOfPoints();
+    t_newPoints.resize(nbPoints);
+
+    std::size_t nbRows = t_velocity.cellGeometry().second;
+    std::size_t nbParticleTasks = (nbPoints + m_particlesPerTask - 1) / m_particlesPerTask;
+    std::size_t nbRowTasks = (nbRows + m_rowsPerTask - 1) / m_rowsPerTask;
+    // Un champ paresseux est complété par bandes de tuiles entières
+    constexpr std::size_t tileSize = CartesianGridOfSpeed::tileSize;
+    std::size_t nbTileRowTasks = (nbRows + tileSize - 1) / tileSize;
+
+    // Nombre de tâches restantes par phase : la dernière tâche d'une phase
+    // déclenche les suivantes.
+    std::atomic<std::size_t> pendingParticles { nbParticleTasks };
+    std::atomic<std::size_t> pendingRows { nbRowTasks };
+    // Le nouveau champ ne peut remplacer l'ancien qu'une fois les particules
+    // et les lignes du champ calculées
+    std::atomic<int> pendingCommit { nbParticleTasks > 0 ? 2 : 1 };
+
+    if (m_sources) {
+        m_sources->advance(dt);
+        // Les listes gardent leur capacité d'un pas à l'autre
+        if (m_expired.size() < nbParticleTasks)
+            m_expired.resize(nbParticleTasks);
+        for (auto & expired : m_expired)
+            expired.clear();
+    }
+
+    if (m_statistics)
+        m_statistics->beginStep(dt, nbParticleTasks);
+
+    bool direct = isDirect(dt, t_velocity, t_vortices, t_points, t_newPoints);
+    // Les vortex mobiles sont déplacés pendant que les particules les lisent
+    if (direct && isMobile)
+        m_startVortices = t_vortices;
+    const Simulation::Vortices & particleVortices = isMobile ? m_startVortices : t_vortices;
+
+    m_timings = StepTimings {};
+    m_timings.particleVelocity = direct ? VelocitySource::Direct : VelocitySource::Grid;
+    double start = omp_get_wtime();
+
+    Trace::Scope stepScope("step", "pipeline");
+    auto record = [&](PhaseTiming & phase, const char * name, double t0, double t1) {
+        Trace::record(name, "pipeline", t0, t1);
+#pragma omp critical(step_timings)
+        {
+            if (phase.nbTasks == 0) {
+                phase.begin = t0 - start;
+                phase.end = t1 - start;
+            } else {
+                phase.begin = std::min(phase.begin, t0 - start);
+                phase.end = std::max(phase.end, t1 - start);
+            }
+            phase.busy += t1 - t0;
+            ++phase.nbTasks;
+        }
+    };
+
+    auto transfer = [&](const auto & hook, const auto & data) {
+        if (!hook)
+            return;
+        double t0 = omp_get_wtime();
+#pragma omp critical(step_transfer)
+        hook(data);
+        record(m_timings.transfer, "transfer", t0, omp_get_wtime());
+    };
+
+    auto frameReady = [&]() {
+        if (!m_frameHook || !isDisplayFrame)
+            return;
+        double t0 = omp_get_wtime();
+#pragma omp critical(step_transfer)
+        m_frameHook(t_vortices, t_velocity, t_newPoints);
+        record(m_timings.transfer, "transfer", t0, omp_get_wtime());
+    };
+
+    auto applySources = [&]() {
+        if (!m_sources)
+            return;
+        double t0 = omp_get_wtime();
+        m_sources->apply(t_newPoints, m_expired);
+        record(m_timings.sources, "sources", t0, omp_get_wtime());
+    };
+
+    // Avec interpolation en temps, les particules ont besoin du champ de fin
+    // de pas : elles partent après la dernière tâche du champ
+    bool interpolate = m_timeInterpolation && isMobile && !direct;
+    // Les particules menées par la vitesse directe ne lisent pas le champ :
+    // hors des images affichées, il n'est évalué qu'au besoin, comme un champ
+    // paresseux
+    bool lazy = (m_lazyField || (direct && !isDisplayFrame)) && isMobile && !interpolate;
+    // Le champ de début de pas est lu partout par l'interpolation en temps
+    if (interpolate && !t_velocity.isVelocityFieldComplete())
+        t_velocity.completeVelocityField();
+
+    // Le champ paresseux est complété par des tâches, seulement pour
+    // l'affichage
+    std::atomic<std::size_t> pendingTileRows { nbTileRowTasks };
+    auto completeField = [&]() {
+        for (std::size_t iTask = 0; iTask < nbTileRowTasks; ++iTask) {
+            // Dans un lambda, les variables capturées seraient sinon
+            // firstprivate (et les compteurs atomiques ne se copient pas)
+#pragma omp task default(shared) firstprivate(iTask)
+            {
+                double t0 = omp_get_wtime();
+                std::size_t firstRow = iTask * tileSize;
+                t_velocity.completeVelocityFieldRows(firstRow,
+                                                     std::min(firstRow + tileSize, nbRows));
+                record(m_timings.field, "field tiles", t0, omp_get_wtime());
+                if (pendingTileRows.fetch_sub(1) == 1) {
+                    t_velocity.completeVelocityField();
+                    transfer(m_fieldHook, t_velocity);
+                    frameReady();
+                }
+            }
+        }
+    };
+
+    auto commitField = [&]() {
+        if (pendingCommit.fetch_sub(1) == 1) {
+            if (lazy) {
+                t_velocity.invalidateVelocityField(t_vortices);
+                if (isDisplayFrame)
+                    completeField();
+                return;
+            }
+            t_velocity.commitVelocityField();
+            transfer(m_fieldHook, t_velocity);
+            frameReady();
+        }
+    };
+
+    auto spawnParticles = [&]() {
+        for (std::size_t iTask = 0; iTask < nbParticleTasks; ++iTask) {
+#pragma omp task default(shared) firstprivate(iTask)
+            {
+                double t0 = omp_get_wtime();
+                std::size_t first = iTask * m_particlesPerTask;
+                std::size_t last = std::min(first + m_particlesPerTask, nbPoints);
+                if (direct)
+                    solve_particles_direct(m_scheme, dt, particleVortices, t_velocity, t_points,
+                                           t_newPoints, first, last);
+                else
+                    solve_particles(m_scheme, dt, t_velocity, t_points, t_newPoints, first, last,
+                                    interpolate);
+                if (m_sources)
+                    m_sources->findExpired(t_newPoints, first, last, m_expired[iTask]);
+                if (m_statistics)
+                    m_statistics->track(t_points, t_newPoints, first, last, iTask);
+                record(m_timings.particles, "particles", t0, omp_get_wtime());
+                if (pendingParticles.fetch_sub(1) == 1) {
+                    if (m_statistics)
+                        m_statistics->endStep();
+                    applySources();
+                    transfer(m_cloudHook, t_newPoints);
+                    if (isMobile)
+                        commitField();
+                    else
+                        frameReady();
+                }
+            }
+        }
+    };
+
+#pragma omp parallel
+#pragma omp single
+    {
+        if (isMobile) {
+#pragma omp task
+            {
+                double t0 = omp_get_wtime();
+                solve_vortices(m_scheme, dt, t_velocity, t_vortices);
+                record(m_timings.vortices, "vortices", t0, omp_get_wtime());
+                transfer(m_vorticesHook, t_vortices);
+
+                if (lazy) {
+                    commitField();
+                } else {
+                    for (std::size_t iTask = 0; iTask < nbRowTasks; ++iTask) {
+#pragma omp task firstprivate(iTask)
+                        {
+                            double t0 = omp_get_wtime();
+                            std::size_t firstRow = iTask * m_rowsPerTask;
+                            std::size_t lastRow = std::min(firstRow + m_rowsPerTask, nbRows);
+                            t_velocity.updateVelocityFieldRows(t_vortices, firstRow, lastRow);
+                            record(m_timings.field, "field rows", t0, omp_get_wtime());
+                            if (pendingRows.fetch_sub(1) == 1) {
+                                if (interpolate)
+                                    spawnParticles();
+                                commitField();
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        if (nbParticleTasks == 0) {
+            if (m_statistics)
+                m_statistics->endStep();
+            applySources();
+            transfer(m_cloudHook, t_newPoints);
+            if (!isMobile)
+                frameReady();
+        }
+        if (!interpolate)
+            spawnParticles();
+    }
+
+    m_timings.wall = omp_get_wtime() - start;
+}
+
+std::ostream & Numeric::operator<<(std::ostream & os, const StepTimings & t_timings) {
+    auto phase = [&os](const char * name, const PhaseTiming & t_phase) {
+        if (t_phase.nbTasks == 0)
+            return;
+        os << " | " << name << " [" << 1.E3 * t_phase.begin << ", " << 1.E3 * t_phase.end
+           << "] busy " << 1.E3 * t_phase.busy << " (" << t_phase.nbTasks << " tasks)";
+    };
+    auto flags = os.flags();
+    os << std::fixed << std::setprecision(3) << "wall " << 1.E3 * t_timings.wall << " ms";
+    phase("particles", t_timings.particles);
+    phase("sources", t_timings.sources);
+    phase("vortices", t_timings.vortices);
+    phase("field", t_timings.field);
+    phase("transfer", t_timings.transfer);
+    os << " | velocity " << velocitySourceName(t_timings.particleVelocity);
+    os.flags(flags);
+    return os;
+}
@@ -0,0 +1,225 @@
+#ifndef _NUMERIC_STEP_PIPELINE_HPP_
+#define _NUMERIC_STEP_PIPELINE_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "cloud_of_points.hpp"
+#include "mixing_statistics.hpp"
+#include "particle_sources.hpp"
+#include "scheme.hpp"
+#include "velocity_source.hpp"
+#include "vortex.hpp"
+
+#include <functional>
+#include <iosfwd>
+#include <vector>
+
+namespace Numeric {
+    /**
+     * @brief Time interval covered by one phase of a time step
+     *
+     * begin and end are relative to the start of the step, busy is the sum of
+     * the durations of the tasks of the phase (all in seconds). A phase whose
+     * [begin, end] interval intersects the one of another phase ran
+     * concurrently with it.
+     */
+    struct PhaseTiming {
+        double begin = 0., end = 0.;
+        double busy = 0.;
+        std::size_t nbTasks = 0;
+    };
+
+    struct StepTimings {
+        PhaseTiming particles, sources, vortices, field, transfer;
+        double wall = 0.;
+        /// Velocity source used by the particles (Grid or Direct)
+        VelocitySource particleVelocity = VelocitySource::Grid;
+    };
+
+    std::ostream & operator<<(std::ostream & os, const StepTimings & t_timings);
+
+    /**
+     * @brief Advance the simulation by one time step as a graph of OpenMP tasks
+     *
+     * The step is split into independent tasks :
+     * - particle chunks, which only read the current velocity field (and
+     *   find the particles to remove, if there are particle sources) ;
+     * - the removal and injection of particles, once all the chunks are done ;
+     * - the vortex advection, which spawns the field rows tasks as soon as the
+     *   new centers are known ;
+     * - field rows, computed in the pending buffer of the grid ;
+     * - the outbound transfers, started by hooks as soon as their data is
+     *   ready.
+     *
+     * There is no barrier between phases : the last task of a phase triggers
+     * its successors. The new field is committed once both the particles and
+     * the field rows are done.
+     *
+     * With time interpolation (mobile vortices only), the particle chunks are
+     * started by the last field rows task instead : their stages then use the
+     * field interpolated between the start and the end of the step, at the
+     * cost of the overlap between the particles and the field.
+     *
+     * With a lazy field (mobile vortices only), no field rows are computed
+     * during the step : the new field is only invalidated once the particles
+     * are done, its tiles being computed when the particles of the next step
+     * read them. It is completed by tasks only for a display frame.
+     */
+    class StepPipeline {
+    public:
+        using VorticesHook = std::function<void(const Simulation::Vortices &)>;
+        using FieldHook = std::function<void(const CartesianGridOfSpeed &)>;
+        using CloudHook = std::function<void(const Geometry::CloudOfPoints &)>;
+        using FrameHook = std::function<void(const Simulation::Vortices &,
+                                             const CartesianGridOfSpeed &,
+                                             const Geometry::CloudOfPoints &)>;
+
+        StepPipeline(std::size_t t_particlesPerTask = 4096, std::size_t t_rowsPerTask = 4)
+            : m_particlesPerTask(t_particlesPerTask), m_rowsPerTask(t_rowsPerTask) {}
+
+        /**
+         * @name Hooks
+         *
+         * Called from inside a task as soon as the corresponding data is up to
+         * date. Calls to hooks are serialized, so they may issue MPI calls with
+         * MPI_THREAD_SERIALIZED. They should not block (use MPI_Isend).
+         */
+        //@{
+        void onVorticesReady(VorticesHook t_hook) { m_vorticesHook = std::move(t_hook); }
+        void onFieldReady(FieldHook t_hook) { m_fieldHook = std::move(t_hook); }
+        void onCloudReady(CloudHook t_hook) { m_cloudHook = std::move(t_hook); }
+        /**
+         * @brief Called once the whole new state (vortices, committed field and
+         * particles) is ready
+         */
+        void onFrameReady(FrameHook t_hook) { m_frameHook = std::move(t_hook); }
+        //@}
+
+        /**
+         * @brief Emitters and sinks applied to the particles at each step
+         *
+         * t_sources must outlive the pipeline (nullptr : constant number of
+         * particles). Its particles must be the ones given to the next step.
+         */
+        void setSources(Simulation::ParticleSources * t_sources) { m_sources = t_sources; }
+
+        /**
+         * @brief Statistics updated by the particle tasks, right after each
+         * chunk is advanced (nullptr : none)
+         *
+         * t_statistics must outlive the pipeline. Not compatible with particle
+         * sources, which change the order of the particles.
+         */
+        void setMixingStatistics(Simulation::MixingStatistics * t_statistics) {
+            m_statistics = t_statistics;
+        }
+
+        /**
+         * @brief Time integration scheme of the particles and of the vortices
+         * (RK4 by default)
+         */
+        void setScheme(Scheme t_scheme) { m_scheme = t_scheme; }
+
+        /**
+         * @brief Whether the particles see the velocity field interpolated in
+         * time during a step with mobile vortices (default : the field at the
+         * start of the step)
+         *
+         * Keeps the stages of the particles consistent with the motion of the
+         * vortices, which allows larger time steps. The start and end fields
+         * are the current and pending buffers of the grid, so nothing is
+         * allocated.
+         */
+        void setTimeInterpolation(bool t_interpolate) { m_timeInterpolation = t_interpolate; }
+
+        /**
+         * @brief Where the particles take their velocity from (the grid by
+         * default)
+         *
+         * With VelocitySource::Automatic, the costs of both sources are
+         * measured once on a sample of the particles : the direct sum is used
+         * when its cost for the current number of vortices is lower than the
+         * one of the interpolation. In direct mode, the particles no longer
+         * depend on the field, which is only computed for the display frames
+         * : in between, mobile vortices leave it lazy (the time interpolation
+         * does not apply).
+         */
+        void setVelocitySource(VelocitySource t_source) { m_velocitySource = t_source; }
+
+        /**
+         * @brief Whether the field of mobile vortices is evaluated lazily
+         * (see CartesianGridOfSpeed::invalidateVelocityField)
+         *
+         * Worth it when the particles only cover a part of the domain and not
+         * every step is displayed. Not used with time interpolation, which
+         * needs the whole field of the end of the step.
+         */
+        void setLazyField(bool t_lazy) { m_lazyField = t_lazy; }
+
+        /**
+         * @brief Advance t_points (and the vortices and the field if
+         * isMobile) by dt
+         *
+         * The new positions are written in an internal buffer which is then
+         * swapped with t_points, so no allocation occurs after the first step.
+         *
+         * @param isDisplayFrame Whether the new state will be displayed : the
+         * frame hook is only called (and a lazy field only completed) for
+         * display frames
+         */
+        void step(double dt,
+                  CartesianGridOfSpeed & t_velocity,
+                  Simulation::Vortices & t_vortices,
+                  Geometry::CloudOfPoints & t_points,
+                  bool isMobile,
+                  bool isDisplayFrame = true);
+        /**
+         * @brief Same as above, but the new positions are written in
+         * t_newPoints (resized if needed) and t_points is left untouched
+         *
+         * t_newPoints keeps its storage : it is never reallocated as long as
+         * its capacity is large enough.
+         */
+        void step(double dt,
+                  CartesianGridOfSpeed & t_velocity,
+                  Simulation::Vortices & t_vortices,
+                  const Geometry::CloudOfPoints & t_points,
+                  Geometry::CloudOfPoints & t_newPoints,
+                  bool isMobile,
+                  bool isDisplayFrame = true);
+
+        const StepTimings & timings() const { return m_timings; }
+
+    private:
+        /**
+         * @brief Whether the particles of the next step use the direct sum
+         */
+        bool isDirect(double dt,
+                      const CartesianGridOfSpeed & t_velocity,
+                      const Simulation::Vortices & t_vortices,
+                      const Geometry::CloudOfPoints & t_points,
+                      Geometry::CloudOfPoints & t_newPoints);
+
+        std::size_t m_particlesPerTask, m_rowsPerTask;
+        Scheme m_scheme = Scheme::RK4;
+        bool m_timeInterpolation = false;
+        VelocitySource m_velocitySource = VelocitySource::Grid;
+        bool m_lazyField = false;
+        // Coûts mesurés (secondes par particule) de l'interpolation et de la
+        // somme directe pour un vortex, nuls tant qu'ils ne sont pas mesurés
+        double m_gridCost = 0., m_directCostPerVortex = 0.;
+        // Vortex du début du pas, lus par les particules en mode direct
+        // pendant que les tâches des vortex les déplacent
+        Simulation::Vortices m_startVortices;
+        VorticesHook m_vorticesHook;
+        FieldHook m_fieldHook;
+        CloudHook m_cloudHook;
+        FrameHook m_frameHook;
+        Simulation::ParticleSources * m_sources = nullptr;
+        Simulation::MixingStatistics * m_statistics = nullptr;
+        // Indices des particules à supprimer, par tâche
+        std::vector<std::vector<std::size_t>> m_expired;
+        Geometry::CloudOfPoints m_newPoints;
+        StepTimings m_timings;
+    };
+} // namespace Numeric
+
+#endif
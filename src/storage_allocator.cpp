@@ -0,0 +1,50 @@
+#include "storage_allocator.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <omp.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace {
+    constexpr std::size_t pageSize = 4096;
+    constexpr std::size_t hugePageSize = std::size_t(2) << 20;
+    // En dessous, lancer une région parallèle coûte plus que le placement
+    constexpr std::size_t firstTouchBytes = 64 * pageSize;
+
+    std::align_val_t storageAlignment(std::size_t t_bytes, std::size_t t_alignment) {
+        std::size_t alignment = std::max(t_alignment, alignof(std::max_align_t));
+        if (t_bytes >= hugePageSize)
+            alignment = std::max(alignment, hugePageSize);
+        return std::align_val_t(alignment);
+    }
+} // namespace
+
+Memory::Placement & Memory::placement() {
+    static Placement s_placement;
+    return s_placement;
+}
+
+void * Memory::allocateStorage(std::size_t t_bytes, std::size_t t_alignment) {
+    auto * storage = static_cast<char *>(
+        ::operator new(t_bytes, storageAlignment(t_bytes, t_alignment)));
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (placement().hugePages && t_bytes >= hugePageSize)
+        madvise(storage, t_bytes, MADV_HUGEPAGE);
+#endif
+    // Dans une région parallèle, la boucle ne serait exécutée que par un
+    // thread : autant laisser le premier calcul placer les pages
+    if (placement().firstTouch && t_bytes >= firstTouchBytes && !omp_in_parallel()) {
+        std::size_t nbPages = (t_bytes + pageSize - 1) / pageSize;
+#pragma omp parallel for schedule(static)
+        for (std::size_t iPage = 0; iPage < nbPages; ++iPage)
+            storage[iPage * pageSize] = 0;
+    }
+    return storage;
+}
+
+void Memory::deallocateStorage(void * t_storage, std::size_t t_bytes, std::size_t t_alignment) {
+    ::operator delete(t_storage, storageAlignment(t_bytes, t_alignment));
+}
@@ -0,0 +1,144 @@
+#ifndef _MEMORY_STORAGE_ALLOCATOR_HPP_
+#define _MEMORY_STORAGE_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Memory {
+    /**
+     * @brief Placement in memory of the heap storage of the simulation
+     *
+     * To be set once at startup, before any storage is allocated.
+     */
+    struct Placement {
+        /**
+         * @brief Touch the pages of large storages in parallel when they are
+         * allocated
+         *
+         * Each page is then placed by the operating system on the NUMA node
+         * of the thread touching it first. The pages are touched with a
+         * static schedule, the same as the `omp parallel for` loops over the
+         * particles or the cells : with bound threads (OMP_PROC_BIND), each
+         * thread of these loops finds its chunk on its own node, and the
+         * tasks of the step pipeline read every node evenly instead of all
+         * reading from the node of the master thread.
+         */
+        bool firstTouch = true;
+        /**
+         * @brief Ask for transparent huge pages on large storages (Linux only)
+         *
+         * Fewer TLB misses on large grids, but the placement is then done
+         * by pages of 2 MiB.
+         */
+        bool hugePages = false;
+    };
+
+    Placement & placement();
+
+    /**
+     * @brief Allocate t_bytes on the heap, aligned on t_alignment, with the
+     * current placement
+     *
+     * Storages of at least 2 MiB are aligned on 2 MiB (huge page).
+     */
+    void * allocateStorage(std::size_t t_bytes, std::size_t t_alignment);
+    void deallocateStorage(void * t_storage, std::size_t t_bytes, std::size_t t_alignment);
+
+    /**
+     * @brief Allocator of the bulk storage of the simulation (particles,
+     * velocity field)
+     *
+     * By default it allocates on the heap. It may instead be bound to a buffer
+     * allocated elsewhere (for instance a MPI shared memory window) : the
+     * container then lives in this buffer as long as it fits in it. The
+     * buffer is handed out once at a time (std::bad_alloc otherwise), and it
+     * never follows a move assignment or a swap into another container : the
+     * elements are moved instead.
+     *
+     * Elements are default-initialized rather than value-initialized, so
+     * building a container of points or vectors does not write zeros in its
+     * storage. On the heap, its pages are touched as set by placement().
+     *
+     * @tparam T Type of the elements
+     */
+    template <typename T>
+    class StorageAllocator {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::false_type;
+        using propagate_on_container_swap = std::false_type;
+
+        StorageAllocator() = default;
+        /**
+         * @brief Bind the allocator to an external buffer
+         *
+         * The buffer is not owned by the allocator. A container should be built
+         * with its final size in it : growing it beyond t_bytes moves its
+         * elements back on the heap.
+         *
+         * @param t_buffer Start of the buffer, suitably aligned for T
+         * @param t_bytes  Size of the buffer in bytes
+         */
+        StorageAllocator(void * t_buffer, std::size_t t_bytes)
+            : m_buffer(t_buffer), m_bytes(t_bytes), m_isInUse(std::make_shared<bool>(false)) {}
+        template <typename U>
+        StorageAllocator(const StorageAllocator<U> & t_other)
+            : m_buffer(t_other.buffer()), m_bytes(t_other.bytes()), m_isInUse(t_other.isInUse()) {}
+
+        T * allocate(std::size_t n) {
+            if (m_buffer != nullptr && n * sizeof(T) <= m_bytes) {
+                // Un seul conteneur à la fois dans le tampon extérieur
+                if (*m_isInUse)
+                    throw std::bad_alloc();
+                *m_isInUse = true;
+                return static_cast<T *>(m_buffer);
+            }
+            if (n > std::size_t(-1) / sizeof(T))
+                throw std::bad_array_new_length();
+            return static_cast<T *>(allocateStorage(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T * p, std::size_t n) {
+            if (p != m_buffer)
+                deallocateStorage(p, n * sizeof(T), alignof(T));
+            else
+                *m_isInUse = false;
+        }
+
+        template <typename U>
+        void construct(U * p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+            ::new (static_cast<void *>(p)) U;
+        }
+
+        template <typename U, typename... Args>
+        void construct(U * p, Args &&... args) {
+            ::new (static_cast<void *>(p)) U(std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief A copy of a container always goes on the heap
+         */
+        StorageAllocator select_on_container_copy_construction() const { return {}; }
+
+        void * buffer() const { return m_buffer; }
+        std::size_t bytes() const { return m_bytes; }
+        /// Whether the external buffer holds a container (shared by the copies)
+        const std::shared_ptr<bool> & isInUse() const { return m_isInUse; }
+
+        template <typename U>
+        bool operator==(const StorageAllocator<U> & t_other) const {
+            return m_buffer == t_other.buffer();
+        }
+
+    private:
+        void * m_buffer = nullptr;
+        std::size_t m_bytes = 0;
+        std::shared_ptr<bool> m_isInUse;
+    };
+} // namespace Memory
+
+#endif
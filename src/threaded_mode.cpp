@@ -0,0 +1,173 @@
+#include "threaded_mode.hpp"
+
+#include "interactive.hpp"
+#include "mixing_statistics.hpp"
+#include "screen.hpp"
+#include "spsc_queue.hpp"
+#include "step_pipeline.hpp"
+#include "tracer.hpp"
+#include "triple_buffer.hpp"
+#include "ui_events.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <thread>
+
+namespace {
+    /**
+     * @brief State of the simulation exchanged between the compute and the
+     * display threads
+     */
+    struct Frame {
+        Simulation::Vortices vortices;
+        Numeric::CartesianGridOfSpeed grid;
+        Geometry::CloudOfPoints cloud;
+        std::size_t step = 0;
+    };
+
+    using EventQueue = SpscQueue<UiEvent, 64>;
+
+    void computeLoop(const Options & t_options,
+                     Simulation::Vortices vortices,
+                     bool isMobile,
+                     Numeric::CartesianGridOfSpeed grid,
+                     Simulation::ParticleSources sources,
+                     TripleBuffer<Frame> & t_frames,
+                     EventQueue & t_events,
+                     std::optional<Simulation::SessionReplay> t_replay) {
+        Trace::setThreadName("compute");
+        SimulationControl control;
+        Numeric::StepPipeline pipeline;
+        pipeline.setScheme(t_options.scheme);
+        pipeline.setTimeInterpolation(t_options.interpolateField);
+        pipeline.setVelocitySource(t_options.particleVelocity);
+        pipeline.setLazyField(t_options.lazyField);
+        grid.setTiledLayout(t_options.tiledField);
+        if (sources.isActive())
+            pipeline.setSources(&sources);
+        std::optional<Simulation::MixingStatistics> statistics;
+        std::optional<Simulation::MixingLog> mixingLog;
+        if (t_options.mixingPeriod > 0) {
+            statistics.emplace(t_frames.lastPublished().cloud, grid, t_options.mixingPeriod);
+            mixingLog.emplace(t_options.mixingLog, t_options.mixingHistogram);
+            pipeline.setMixingStatistics(&*statistics);
+        }
+        std::optional<Simulation::SessionRecorder> recorder;
+        if (!t_options.recordSession.empty())
+            recorder.emplace(t_options.recordSession);
+        std::size_t iStep = 0;
+        // Particules des pas intermédiaires entre deux images affichées
+        Geometry::CloudOfPoints cloud;
+        bool isCloudPublished = true;
+
+        while (!control.closing) {
+            control.advance = false;
+            if (auto event = t_events.pop()) {
+                control.apply(*event);
+                if (recorder)
+                    recorder->record(iStep, *event);
+            }
+            if (control.closing)
+                break;
+            if (t_replay && !t_replay->isOver() && !t_replay->apply(iStep, control))
+                std::cout << "[replay] " << *t_replay << std::endl;
+
+            if (!control.mustStep()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+
+            // Les nouvelles positions d'une image affichée sont calculées
+            // directement dans le tampon d'écriture, à partir du dernier état
+            // (publié, que l'affichage ne fait que lire, ou intermédiaire)
+            ++iStep;
+            bool isDisplayFrame = control.advance || iStep % t_options.frameInterval == 0;
+            const Geometry::CloudOfPoints & input =
+                isCloudPublished ? t_frames.lastPublished().cloud : cloud;
+            if (isDisplayFrame) {
+                Frame & next = t_frames.back();
+                pipeline.step(control.dt, grid, vortices, input, next.cloud, isMobile);
+                if (isMobile) {
+                    next.vortices = vortices;
+                    // Sans la copie rangée par tuiles, propre à la simulation
+                    next.grid.copyVelocityFieldFrom(grid);
+                }
+                next.step = iStep;
+                t_frames.publish();
+            } else if (isCloudPublished) {
+                pipeline.step(control.dt, grid, vortices, input, cloud, isMobile, false);
+            } else {
+                pipeline.step(control.dt, grid, vortices, cloud, isMobile, false);
+            }
+            isCloudPublished = isDisplayFrame;
+            if (mixingLog)
+                mixingLog->write(*statistics);
+
+            if (t_options.timings)
+                std::cout << "[timings] step " << iStep << " : " << pipeline.timings()
+                          << std::endl;
+        }
+    }
+} // namespace
+
+int runThreaded(const Options & t_options,
+                const Simulation::Vortices & t_vortices,
+                bool isMobile,
+                const Numeric::CartesianGridOfSpeed & t_grid,
+                const Geometry::CloudOfPoints & t_cloud,
+                const Simulation::ParticleSources & t_sources,
+                const Numeric::FtleField * t_ftle,
+                std::optional<Simulation::SessionReplay> t_replay) {
+    printKeyboardHelp();
+
+    TripleBuffer<Frame> frames { Frame { t_vortices, t_grid, t_cloud } };
+    EventQueue events;
+
+    std::thread compute(computeLoop, std::cref(t_options), t_vortices, isMobile, t_grid,
+                        t_sources, std::ref(frames), std::ref(events), t_replay);
+
+    Graphisme::Screen myScreen({ t_options.resx, t_options.resy },
+                               { t_grid.getLeftBottomVertex(), t_grid.getRightTopVertex() });
+    myScreen.setFieldArrows(t_options.fieldArrows);
+    myScreen.setTrails(t_options.trails, t_options.trailLength);
+    // Seulement pour l'affichage du pas de temps
+    SimulationControl control;
+    Trace::setThreadName("display");
+
+    while (myScreen.isOpen()) {
+        auto start = std::chrono::system_clock::now();
+        sf::Event event;
+        {
+            Trace::Scope scope("poll events", "ui");
+            while (myScreen.pollEvent(event)) {
+                UiEvent ui_event = translateEvent(myScreen, event);
+                // Pendant un rejeu, le clavier ne peut que fermer la fenêtre
+                if (ui_event == UiEvent::Noop || (t_replay && !(ui_event == UiEvent::CloseWindow)))
+                    continue;
+                if (ui_event == UiEvent::CloseWindow) {
+                    // L'ordre de fermeture ne doit pas être perdu
+                    while (!events.push(ui_event))
+                        std::this_thread::yield();
+                    myScreen.close();
+                } else if (!events.push(ui_event)) {
+                    std::cerr << "Event queue full, dropping " << ui_event << std::endl;
+                    continue;
+                }
+                control.apply(ui_event);
+            }
+        }
+
+        frames.update();
+        const Frame & frame = frames.front();
+        if (t_replay)
+            control.dt = t_replay->controlAt(frame.step).dt;
+        if (myScreen.isOpen())
+            drawFrame(myScreen, frame.grid, frame.vortices, frame.cloud, control.dt, start,
+                      t_ftle);
+    }
+
+    compute.join();
+    return EXIT_SUCCESS;
+}
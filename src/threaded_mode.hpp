@@ -0,0 +1,37 @@
+#ifndef _THREADED_MODE_HPP_
+#define _THREADED_MODE_HPP_
+#include "cartesian_grid_of_speed.hpp"
+#include "cloud_of_points.hpp"
+#include "ftle.hpp"
+#include "options.hpp"
+#include "particle_sources.hpp"
+#include "session_log.hpp"
+#include "vortex.hpp"
+
+#include <optional>
+
+/**
+ * @brief Run the simulation in a single process, without MPI
+ *
+ * A compute thread advances the simulation and publishes each new state in a
+ * lock-free triple buffer, while the calling thread handles the window : it
+ * always displays the newest complete state and never waits for the compute
+ * thread. Keyboard orders go to the compute thread through a lock-free SPSC
+ * queue.
+ *
+ * @param t_ftle If not null, FTLE field displayed in place of the velocity
+ * field
+ * @param t_replay If set, session whose orders replace the keyboard, which
+ * can only close the window
+ * @return The exit code of the program
+ */
+int runThreaded(const Options & t_options,
+                const Simulation::Vortices & t_vortices,
+                bool isMobile,
+                const Numeric::CartesianGridOfSpeed & t_grid,
+                const Geometry::CloudOfPoints & t_cloud,
+                const Simulation::ParticleSources & t_sources,
+                const Numeric::FtleField * t_ftle = nullptr,
+                std::optional<Simulation::SessionReplay> t_replay = std::nullopt);
+
+#endif
@@ -0,0 +1,181 @@
+#include "tracer.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <vector>
+
+namespace {
+    struct Interval {
+        const char * name;
+        const char * category;
+        double begin, end;
+    };
+
+    /**
+     * @brief Intervals of one thread, only written by this thread and read
+     * once every thread is done
+     */
+    struct ThreadBuffer {
+        std::vector<Interval> ring;
+        /// Number of intervals recorded, the last ring.size() ones being kept
+        std::size_t count = 0;
+        std::string name;
+    };
+
+    // Le registre n'est verrouillé que lorsqu'un thread enregistre son
+    // premier intervalle ; les tampons survivent à leur thread
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> registry;
+    std::size_t capacity = 0;
+    std::string processName;
+    /// Début de l'enregistrement, sur l'horloge du premier processus
+    double origin = 0.;
+    /// Horloge du premier processus moins celle de ce processus
+    double offset = 0.;
+
+    thread_local ThreadBuffer * current = nullptr;
+
+    ThreadBuffer & threadBuffer() {
+        if (current == nullptr) {
+            auto buffer = std::make_unique<ThreadBuffer>();
+            buffer->ring.resize(capacity);
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffer->name = "thread " + std::to_string(registry.size());
+            current = buffer.get();
+            registry.push_back(std::move(buffer));
+        }
+        return *current;
+    }
+} // namespace
+
+void Trace::detail::push(const char * t_name,
+                         const char * t_category,
+                         double t_begin,
+                         double t_end) {
+    ThreadBuffer & buffer = threadBuffer();
+    buffer.ring[buffer.count % capacity] = Interval { t_name, t_category, t_begin, t_end };
+    ++buffer.count;
+}
+
+void Trace::start(std::size_t t_capacity) {
+    capacity = std::max<std::size_t>(t_capacity, 1);
+    origin = now();
+    detail::isEnabled = true;
+}
+
+void Trace::synchronize(MPI_Comm t_comm) {
+    if (!isEnabled())
+        return;
+    constexpr int TAG = 'T';
+    constexpr int nbRounds = 8;
+    int rank, size;
+    MPI_Comm_rank(t_comm, &rank);
+    MPI_Comm_size(t_comm, &size);
+    // Le premier processus répond par son heure ; l'écart est estimé au
+    // milieu de l'aller-retour le plus court
+    for (int peer = 1; peer < size; ++peer) {
+        if (rank == 0) {
+            for (int iRound = 0; iRound < nbRounds; ++iRound) {
+                double request;
+                MPI_Recv(&request, 1, MPI_DOUBLE, peer, TAG, t_comm, MPI_STATUS_IGNORE);
+                double reply = now();
+                MPI_Send(&reply, 1, MPI_DOUBLE, peer, TAG, t_comm);
+            }
+        } else if (rank == peer) {
+            double fastest = std::numeric_limits<double>::infinity();
+            for (int iRound = 0; iRound < nbRounds; ++iRound) {
+                double sent = now(), reply;
+                MPI_Send(&sent, 1, MPI_DOUBLE, 0, TAG, t_comm);
+                MPI_Recv(&reply, 1, MPI_DOUBLE, 0, TAG, t_comm, MPI_STATUS_IGNORE);
+                double received = now();
+                if (received - sent < fastest) {
+                    fastest = received - sent;
+                    offset = reply - 0.5 * (sent + received);
+                }
+            }
+        }
+    }
+    MPI_Bcast(&origin, 1, MPI_DOUBLE, 0, t_comm);
+}
+
+void Trace::setThreadName(const char * t_name) {
+    if (isEnabled())
+        threadBuffer().name = t_name;
+}
+
+void Trace::setProcessName(const std::string & t_name) { processName = t_name; }
+
+void Trace::write(const std::string & t_fileName, MPI_Comm t_comm) {
+    if (!isEnabled())
+        return;
+    int rank = 0, size = 1;
+    if (t_comm != MPI_COMM_NULL) {
+        MPI_Comm_rank(t_comm, &rank);
+        MPI_Comm_size(t_comm, &size);
+    }
+
+    // Événements de ce processus au format Chrome trace, en microsecondes
+    // depuis le début de l'enregistrement du premier processus
+    std::ostringstream events;
+    events << std::fixed << std::setprecision(3);
+    unsigned long long counts[2] = { 0, 0 }; // Intervalles gardés, écrasés
+    events << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << rank
+           << ",\"args\":{\"name\":\"rank " << rank
+           << (processName.empty() ? "" : " (" + processName + ")") << "\"}}";
+    for (std::size_t iThread = 0; iThread < registry.size(); ++iThread) {
+        const ThreadBuffer & buffer = *registry[iThread];
+        events << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << rank
+               << ",\"tid\":" << iThread << ",\"args\":{\"name\":\"" << buffer.name << "\"}}";
+        std::size_t first = buffer.count > capacity ? buffer.count - capacity : 0;
+        for (std::size_t iInterval = first; iInterval < buffer.count; ++iInterval) {
+            const Interval & interval = buffer.ring[iInterval % capacity];
+            events << ",\n{\"name\":\"" << interval.name << "\",\"cat\":\"" << interval.category
+                   << "\",\"ph\":\"X\",\"ts\":" << (interval.begin + offset - origin) * 1.E6
+                   << ",\"dur\":" << (interval.end - interval.begin) * 1.E6
+                   << ",\"pid\":" << rank << ",\"tid\":" << iThread << "}";
+        }
+        counts[0] += buffer.count - first;
+        counts[1] += first;
+    }
+    std::string local = events.str();
+
+    // Rassemblé sur le premier processus
+    std::string all;
+    if (t_comm == MPI_COMM_NULL) {
+        all = std::move(local);
+    } else {
+        int length = int(local.size());
+        std::vector<int> lengths(rank == 0 ? size : 0), displacements(lengths.size(), 0);
+        MPI_Gather(&length, 1, MPI_INT, lengths.data(), 1, MPI_INT, 0, t_comm);
+        if (rank == 0) {
+            std::partial_sum(lengths.begin(), lengths.end() - 1, displacements.begin() + 1);
+            all.resize(std::size_t(displacements.back()) + lengths.back());
+        }
+        MPI_Gatherv(local.data(), length, MPI_CHAR, all.data(), lengths.data(),
+                    displacements.data(), MPI_CHAR, 0, t_comm);
+        // Chaque fragment commence par le nom de son processus
+        if (rank == 0)
+            for (int iRank = size - 1; iRank > 0; --iRank)
+                all.insert(std::size_t(displacements[iRank]), ",\n");
+        unsigned long long localCounts[2] = { counts[0], counts[1] };
+        MPI_Reduce(localCounts, counts, 2, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, t_comm);
+    }
+    if (rank != 0)
+        return;
+    std::ofstream output(t_fileName);
+    if (!output) {
+        std::cerr << "Cannot open " << t_fileName << ", the trace is not written" << std::endl;
+        return;
+    }
+    output << "{\"traceEvents\":[\n" << all << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    std::cout << "[trace] " << counts[0] << " intervals (" << counts[1]
+              << " overwritten) of " << size << " processes written in " << t_fileName
+              << std::endl;
+}
@@ -0,0 +1,96 @@
+#ifndef _TRACE_TRACER_HPP_
+#define _TRACE_TRACER_HPP_
+
+#include <cstddef>
+#include <mpi.h>
+#include <omp.h>
+#include <string>
+
+/**
+ * @brief Timeline of the work of every thread of every process, written as a
+ * Chrome trace (JSON) readable by chrome://tracing or ui.perfetto.dev
+ *
+ * Each thread records its intervals (name, category, begin and end) in its
+ * own ring buffer, allocated the first time it records : recording takes no
+ * lock, and when the buffer is full the oldest intervals are overwritten.
+ * The times are those of omp_get_wtime(), which the step pipeline already
+ * compares between threads ; the clocks of the processes are aligned on the
+ * one of the first process by synchronize().
+ *
+ * Until start() is called, recording is a test of a global flag.
+ */
+namespace Trace {
+    namespace detail {
+        inline bool isEnabled = false;
+        void push(const char * t_name, const char * t_category, double t_begin, double t_end);
+    } // namespace detail
+
+    inline bool isEnabled() { return detail::isEnabled; }
+    inline double now() { return omp_get_wtime(); }
+
+    /**
+     * @brief Enable the recording, with rings of t_capacity intervals per
+     * thread
+     *
+     * To be called once at startup, before the threads record anything.
+     */
+    void start(std::size_t t_capacity);
+
+    /**
+     * @brief Estimate the offset of the clock of this process from the one
+     * of the first process of t_comm (collective)
+     *
+     * Each process exchanges a few messages with the first one and keeps the
+     * estimate of the fastest round trip.
+     */
+    void synchronize(MPI_Comm t_comm);
+
+    /**
+     * @brief Record an interval of the calling thread, t_name and t_category
+     * being string literals
+     */
+    inline void record(const char * t_name,
+                       const char * t_category,
+                       double t_begin,
+                       double t_end) {
+        if (detail::isEnabled)
+            detail::push(t_name, t_category, t_begin, t_end);
+    }
+
+    /// Name of the calling thread in the timeline (string literal)
+    void setThreadName(const char * t_name);
+    /// Name of this process in the timeline
+    void setProcessName(const std::string & t_name);
+
+    /**
+     * @brief Record the interval between its construction and its destruction
+     */
+    class Scope {
+    public:
+        Scope(const char * t_name, const char * t_category)
+            : m_name(isEnabled() ? t_name : nullptr), m_category(t_category),
+              m_begin(m_name ? now() : 0.) {}
+        Scope(const Scope &) = delete;
+        Scope & operator=(const Scope &) = delete;
+        ~Scope() {
+            if (m_name)
+                detail::push(m_name, m_category, m_begin, now());
+        }
+
+    private:
+        const char * m_name;
+        const char * m_category;
+        double m_begin;
+    };
+
+    /**
+     * @brief Write the intervals of every thread of every process of t_comm
+     * in the file t_fileName (collective, written by the first process)
+     *
+     * With MPI_COMM_NULL, only the intervals of this process are written. To
+     * be called once no thread records anymore.
+     */
+    void write(const std::string & t_fileName, MPI_Comm t_comm);
+} // namespace Trace
+
+#endif
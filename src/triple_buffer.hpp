@@ -0,0 +1,111 @@
+#ifndef _TRIPLE_BUFFER_HPP_
+#define _TRIPLE_BUFFER_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Lock-free exchange of the slots of a triple buffer
+ *
+ * The writer owns a back slot, the reader owns a front slot and the third
+ * slot (the middle one) is stored in a single atomic byte together with a flag
+ * telling whether it holds a frame newer than the front one. Neither side ever
+ * waits for the other : the writer always has a slot to write in and the
+ * reader always gets the newest complete frame.
+ *
+ * The state only needs an atomic byte, so it may live in memory shared between
+ * processes (see SharedFrame).
+ */
+namespace TripleBufferState {
+    constexpr std::uint8_t INDEX_MASK = 0x3;
+    constexpr std::uint8_t FRESH = 0x4;
+
+    /**
+     * @brief Initial state : the middle slot is 1 and holds no new frame (the
+     * writer starts with slot 0 and the reader with slot 2)
+     */
+    constexpr std::uint8_t initial() { return 1; }
+
+    /**
+     * @brief Publish the back slot and return the slot to write next
+     */
+    inline std::uint8_t publish(std::atomic<std::uint8_t> & t_state, std::uint8_t t_back) {
+        return t_state.exchange(t_back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    /**
+     * @brief Take the newest published slot if any
+     *
+     * @param t_front The front slot, replaced by the newest published slot
+     * @return true if t_front changed
+     */
+    inline bool acquire(std::atomic<std::uint8_t> & t_state, std::uint8_t & t_front) {
+        if ((t_state.load(std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+        t_front = t_state.exchange(t_front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+} // namespace TripleBufferState
+
+/**
+ * @brief Triple buffer for one writer thread and one reader thread
+ *
+ * @tparam T Type of a frame
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+    /**
+     * @brief Initialize the three slots with the same frame
+     */
+    explicit TripleBuffer(const T & t_initial) : m_slots { t_initial, t_initial, t_initial } {}
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer & operator=(const TripleBuffer &) = delete;
+
+    //@name Writer side
+    //@{
+    /**
+     * @brief The slot being written, never read by the reader
+     */
+    T & back() { return m_slots[m_back]; }
+    /**
+     * @brief The last published slot
+     *
+     * The reader may be reading it concurrently, so it must only be read.
+     */
+    const T & lastPublished() const { return m_slots[m_lastPublished]; }
+    /**
+     * @brief Make the back slot the newest frame and switch to another slot
+     */
+    void publish() {
+        m_lastPublished = m_back;
+        m_back = TripleBufferState::publish(m_state, m_back);
+    }
+    //@}
+
+    //@name Reader side
+    //@{
+    /**
+     * @brief Switch the front slot to the newest published frame, if any
+     *
+     * @return true if a new frame is available
+     */
+    bool update() { return TripleBufferState::acquire(m_state, m_front); }
+    /**
+     * @brief The frame being displayed, never written by the writer
+     */
+    const T & front() const { return m_slots[m_front]; }
+    //@}
+
+private:
+    std::array<T, 3> m_slots;
+    std::atomic<std::uint8_t> m_state { TripleBufferState::initial() };
+    // Côté écrivain
+    std::uint8_t m_back = 0, m_lastPublished = 2;
+    // Côté lecteur
+    std::uint8_t m_front = 2;
+};
+
+#endif
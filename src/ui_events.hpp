@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <mpi.h>
 #include <ostream>
+#include <sstream>
+#include <string_view>
 
 template <typename E>
 constexpr typename std::underlying_type<E>::type to_underlying(E e) noexcept {
@@ -28,6 +30,11 @@ private:
 public:
     using enum EventType;
 
+    /// Every event but Noop
+    constexpr static EventType knownEvents[] = { CloseWindow,       AnimationStart,
+                                                 AnimationStop,     TimestepIncrement,
+                                                 TimestepDecrement, Advance };
+
     constexpr static int TAG = 'E';
 
     inline constexpr UiEvent() { data[0] = Noop; }
@@ -61,6 +68,17 @@ public:
     }
 };
 
+/// Event named as printed by operator<<, Noop if the name is not one of UiEvent::knownEvents
+inline UiEvent parseUiEvent(std::string_view t_name) {
+    for (UiEvent event : UiEvent::knownEvents) {
+        std::ostringstream name;
+        name << event;
+        if (name.str() == t_name)
+            return event;
+    }
+    return UiEvent::Noop;
+}
+
 constexpr const int TEST = sizeof(UiEvent::CloseWindow);
 
 #endif
@@ -29,6 +29,12 @@ namespace Geometry {
          * @param t_y Ordinate
          */
         Vector(RealType t_x, RealType t_y) : x(t_x), y(t_y) {}
+        /**
+         * @brief Convert a vector with another kind of real
+         */
+        template <typename OtherRealType>
+        explicit Vector(const Vector<OtherRealType> & t_vector)
+            : x(RealType(t_vector.x)), y(RealType(t_vector.y)) {}
         /**
          * @brief Construct a new Vector defined by two points
          *
@@ -0,0 +1,46 @@
+#ifndef _NUMERIC_VELOCITY_SOURCE_HPP_
+#define _NUMERIC_VELOCITY_SOURCE_HPP_
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace Numeric {
+    /**
+     * @brief Where the particles take their velocity from
+     *
+     * - Grid : interpolation in the velocity field of the grid ;
+     * - Direct : exact sum over the vortices (and their periodic images),
+     *   cheaper than the interpolation when there are few vortices ;
+     * - Automatic : the cheapest of both, chosen from their measured costs.
+     */
+    enum class VelocitySource { Grid, Direct, Automatic };
+
+    inline const char * velocitySourceName(VelocitySource t_source) {
+        switch (t_source) {
+        case VelocitySource::Grid:
+            return "grid";
+        case VelocitySource::Direct:
+            return "direct";
+        case VelocitySource::Automatic:
+            return "auto";
+        }
+        return "?";
+    }
+
+    /**
+     * @brief Velocity source named t_name (grid, direct or auto)
+     *
+     * Throw std::invalid_argument on an unknown name.
+     */
+    inline VelocitySource parseVelocitySource(std::string_view t_name) {
+        for (VelocitySource source :
+             { VelocitySource::Grid, VelocitySource::Direct, VelocitySource::Automatic }) {
+            if (t_name == velocitySourceName(source))
+                return source;
+        }
+        throw std::invalid_argument("Unknown velocity source " + std::string(t_name));
+    }
+} // namespace Numeric
+
+#endif
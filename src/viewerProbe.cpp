@@ -0,0 +1,147 @@
+#include "frame_socket.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct ProbeOptions {
+        std::string address;
+        /// Number of frames after which the probe disconnects (0 : never)
+        std::size_t nbFrames = 0;
+        /// Delay after each frame, to play a slow viewer
+        std::size_t slowMs = 0;
+        /// Orders sent once the given number of frames is received
+        std::multimap<std::size_t, UiEvent> orders;
+    };
+
+    void printUsage(const char * program) {
+        std::cout << "Usage : " << program << " <tcp:host:port | unix:path> [options]" << std::endl
+                  << "Viewer without window of a simulation run with --serve : receive its "
+                     "frames, send it orders and print what was received"
+                  << std::endl
+                  << "    --frames=N  disconnect after N frames (default : when the simulation "
+                     "stops)"
+                  << std::endl
+                  << "    --orders=K:O,...  send the order O (as in a session log : "
+                     "AnimationStart, Advance...) once K frames are received"
+                  << std::endl
+                  << "    --slow=MS  wait MS milliseconds after each frame" << std::endl;
+    }
+
+    ProbeOptions parseProbeOptions(int argc, char * argv[]) {
+        ProbeOptions options;
+        std::vector<std::string> positional;
+        for (int iArg = 1; iArg < argc; ++iArg) {
+            std::string_view arg { argv[iArg] };
+            if (!arg.starts_with("--")) {
+                positional.emplace_back(arg);
+                continue;
+            }
+            std::string_view name = arg.substr(2);
+            std::string value;
+            if (auto eq = name.find('='); eq != std::string_view::npos) {
+                value = std::string(name.substr(eq + 1));
+                name = name.substr(0, eq);
+            }
+            if (value.empty())
+                throw std::invalid_argument("--" + std::string(name) + " expects a value");
+            if (name == "frames") {
+                options.nbFrames = std::stoull(value);
+            } else if (name == "slow") {
+                options.slowMs = std::stoull(value);
+            } else if (name == "orders") {
+                std::istringstream list(value);
+                std::string item;
+                while (std::getline(list, item, ',')) {
+                    auto colon = item.find(':');
+                    if (colon == std::string::npos)
+                        throw std::invalid_argument("--orders expects <frames>:<order> items");
+                    UiEvent order = parseUiEvent(item.substr(colon + 1));
+                    if (order == UiEvent::Noop)
+                        throw std::invalid_argument("Unknown order " + item.substr(colon + 1));
+                    options.orders.emplace(std::stoull(item.substr(0, colon)), order);
+                }
+            } else {
+                throw std::invalid_argument("Unknown option --" + std::string(name));
+            }
+        }
+        if (positional.size() != 1)
+            throw std::invalid_argument("Expected the address of the simulation");
+        options.address = positional[0];
+        return options;
+    }
+} // namespace
+
+int main(int argc, char * argv[]) {
+    ProbeOptions options;
+    try {
+        options = parseProbeOptions(argc, argv);
+    } catch (std::exception & err) {
+        std::cout << err.what() << std::endl;
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    std::optional<Simulation::FrameClient> client;
+    try {
+        client.emplace(Simulation::SocketAddress::parse(options.address));
+    } catch (std::exception & err) {
+        std::cerr << err.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    const auto & geometry = client->geometry();
+    std::cout << "Connected to " << options.address << " : grid " << geometry.width << " x "
+              << geometry.height << " cells of " << geometry.step << std::endl;
+    Numeric::CartesianGridOfSpeed grid({ geometry.width, geometry.height },
+                                       { geometry.left, geometry.bottom }, geometry.step);
+    Simulation::Vortices vortices;
+    Geometry::CloudOfPoints cloud;
+
+    std::size_t nbFrames = 0, nbFields = 0, firstStep = 0, lastStep = 0, largestGap = 0;
+    auto sendOrders = [&]() {
+        auto [first, last] = options.orders.equal_range(nbFrames);
+        for (auto order = first; order != last; ++order)
+            client->send(order->second);
+    };
+    auto start = std::chrono::steady_clock::now();
+    sendOrders();
+    while (client->isConnected() && (options.nbFrames == 0 || nbFrames < options.nbFrames)) {
+        try {
+            if (!client->receive(100, vortices, grid, cloud))
+                continue;
+        } catch (std::runtime_error & err) {
+            std::cerr << err.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        // Seule la dernière des images arrivées ensemble est décodée
+        const auto & header = client->header();
+        if (nbFrames == 0)
+            firstStep = header.step;
+        else
+            largestGap = std::max<std::size_t>(largestGap, header.step - lastStep);
+        lastStep = header.step;
+        nbFields += header.hasField ? 1 : 0;
+        ++nbFrames;
+        sendOrders();
+        if (options.slowMs > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(options.slowMs));
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    if (client->isConnected())
+        client->send(UiEvent::CloseWindow);
+    std::cout << nbFrames << " frames received in " << seconds.count() << " s (" << nbFields
+              << " with the velocity field), steps " << firstStep << " to " << lastStep
+              << ", largest gap " << largestGap << " steps, " << vortices.numberOfVortices()
+              << " vortices and " << cloud.numberOfPoints() << " particles in the last one"
+              << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -1,5 +1,7 @@
 #include "vortex.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 using namespace Simulation;
@@ -101,3 +103,60 @@ auto Vortices::computeSpeed(const point & a_point) const -> vector {
     }
     return speed;
 }
+
+template <typename RealType>
+void Vortices::computeSpeeds(std::size_t t_nbPoints,
+                             const Geometry::Point<RealType> * t_points,
+                             Geometry::Vector<RealType> * t_speeds) const {
+    constexpr double thresholdDist = 1.E-5;
+    constexpr std::size_t blockSize = 64;
+    // Décalages des images périodiques, dans le même ordre que computeSpeed
+    const double shifts[9][2] = { { 0., 0. },
+                                  { m_domainSize.x, 0. },
+                                  { -m_domainSize.x, 0. },
+                                  { 0., m_domainSize.y },
+                                  { 0., -m_domainSize.y },
+                                  { m_domainSize.x, m_domainSize.y },
+                                  { -m_domainSize.x, m_domainSize.y },
+                                  { m_domainSize.x, -m_domainSize.y },
+                                  { -m_domainSize.x, -m_domainSize.y } };
+    alignas(64) double px[blockSize], py[blockSize], sx[blockSize], sy[blockSize];
+
+    for (std::size_t first = 0; first < t_nbPoints; first += blockSize) {
+        std::size_t count = std::min(blockSize, t_nbPoints - first);
+        for (std::size_t i = 0; i < count; ++i) {
+            px[i] = t_points[first + i].x;
+            py[i] = t_points[first + i].y;
+            sx[i] = 0.;
+            sy[i] = 0.;
+        }
+        for (std::size_t iVortex = 0; iVortex < 3 * numberOfVortices(); iVortex += 3) {
+            double intensity = m_centers_and_intensities[iVortex + 2];
+            for (const auto & shift : shifts) {
+                double cx = m_centers_and_intensities[iVortex + 0] + shift[0];
+                double cy = m_centers_and_intensities[iVortex + 1] + shift[1];
+#pragma omp simd
+                for (std::size_t i = 0; i < count; ++i) {
+                    double rx = px[i] - cx, ry = py[i] - cy;
+                    double dist = std::sqrt(rx * rx + ry * ry);
+                    // Sans branche : la contribution d'un vortex confondu
+                    // avec le point est annulée. Une seule division pour la
+                    // normalisation et l'intensité.
+                    bool isFar = dist > thresholdDist;
+                    double factor = isFar ? intensity / (std::max(dist, 1.) * dist) : 0.;
+                    sx[i] -= factor * ry;
+                    sy[i] += factor * rx;
+                }
+            }
+        }
+        for (std::size_t i = 0; i < count; ++i)
+            t_speeds[first + i] = Geometry::Vector<RealType>(RealType(sx[i]), RealType(sy[i]));
+    }
+}
+
+template void Vortices::computeSpeeds(std::size_t,
+                                      const Geometry::Point<float> *,
+                                      Geometry::Vector<float> *) const;
+template void Vortices::computeSpeeds(std::size_t,
+                                      const Geometry::Point<double> *,
+                                      Geometry::Vector<double> *) const;
@@ -63,6 +63,23 @@ namespace Simulation {
         }
 
         vector computeSpeed(const point & a_point) const;
+        /**
+         * @brief Same as computeSpeed for t_nbPoints points at once
+         *
+         * Vectorized kernel : the points are processed by blocks, the loop
+         * over the points of a block being the inner one. The sums are done in
+         * double whatever RealType (float or double).
+         */
+        template <typename RealType>
+        void computeSpeeds(std::size_t t_nbPoints,
+                           const Geometry::Point<RealType> * t_points,
+                           Geometry::Vector<RealType> * t_speeds) const;
+
+        /**
+         * @brief Centers and intensities, as (x, y, intensity) triplets
+         */
+        const double * data() const { return m_centers_and_intensities.data(); }
+        double * data() { return m_centers_and_intensities.data(); }
 
         Vortices & operator=(const Vortices &) = default;
         Vortices & operator=(Vortices &&) = default;
@@ -74,6 +91,11 @@ namespace Simulation {
                             MPI_DOUBLE, dest, Vortices::TAG, comm);
         }
 
+        inline int isend(int dest, MPI_Comm comm, MPI_Request * request) const {
+            return MPI_Isend(m_centers_and_intensities.data(), m_centers_and_intensities.size(),
+                             MPI_DOUBLE, dest, Vortices::TAG, comm, request);
+        }
+
         inline int recv(int source, MPI_Comm comm, MPI_Status * status) {
             return MPI_Recv(m_centers_and_intensities.data(), m_centers_and_intensities.size(),
                             MPI_DOUBLE, source, Vortices::TAG, comm, status);
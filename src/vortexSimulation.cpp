@@ -1,20 +1,39 @@
+#include "accuracy_benchmark.hpp"
 #include "cartesian_grid_of_speed.hpp"
 #include "cloud_of_points.hpp"
-#include "runge_kutta.hpp"
+#include "frame_channel.hpp"
+#include "ftle.hpp"
+#include "grid_benchmark.hpp"
+#include "interactive.hpp"
+#include "memory_benchmark.hpp"
+#include "mixing_statistics.hpp"
+#include "offscreen_mode.hpp"
+#include "options.hpp"
+#include "particle_balancer.hpp"
+#include "particle_sources.hpp"
+#include "precision_report.hpp"
+#include "remote_mode.hpp"
+#include "scenario.hpp"
 #include "screen.hpp"
+#include "session_log.hpp"
+#include "shared_frame.hpp"
+#include "step_pipeline.hpp"
+#include "storage_allocator.hpp"
+#include "threaded_mode.hpp"
+#include "tracer.hpp"
 #include "ui_events.hpp"
 #include "vortex.hpp"
 
-#include <SFML/Window/Keyboard.hpp>
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
 #include <fstream>
-#include <ios>
 #include <iostream>
 #include <mpi.h>
-#include <sstream>
+#include <optional>
 #include <string>
-#include <tuple>
+#include <stdexcept>
+#include <vector>
 
 constexpr int SCREEN_PROCESS = 0;
 constexpr int SIM_PROCESS = 1;
@@ -22,253 +41,507 @@ constexpr int SIM_PROCESS = 1;
 #define DISABLE_DEBUGGING // can be used to disable "DEBUG" statements
 #include "utils.hpp"
 
-auto readConfigFile(std::ifstream & input) {
-    using point = Simulation::Vortices::point;
-
-    int isMobile;
-    std::size_t nbVortices;
-    Numeric::CartesianGridOfSpeed cartesianGrid;
-    Geometry::CloudOfPoints cloudOfPoints;
-    constexpr std::size_t maxBuffer = 8192;
-    char buffer[maxBuffer];
-    std::string sbuffer;
-    std::stringstream ibuffer;
-    // Lit la première ligne de commentaire :
-    input.getline(buffer, maxBuffer); // Relit un commentaire
-    input.getline(buffer, maxBuffer); // Lecture de la grille cartésienne
-    sbuffer = std::string(buffer, maxBuffer);
-    ibuffer = std::stringstream(sbuffer);
-    double xleft, ybot, h;
-    std::size_t nx, ny;
-    ibuffer >> xleft >> ybot >> nx >> ny >> h;
-    cartesianGrid = Numeric::CartesianGridOfSpeed({ nx, ny }, point { xleft, ybot }, h);
-    input.getline(buffer, maxBuffer); // Relit un commentaire
-    input.getline(buffer, maxBuffer); // Lit mode de génération des particules
-    sbuffer = std::string(buffer, maxBuffer);
-    ibuffer = std::stringstream(sbuffer);
-    int modeGeneration;
-    ibuffer >> modeGeneration;
-    if (modeGeneration == 0) // Génération sur toute la grille
-    {
-        std::size_t nbPoints;
-        ibuffer >> nbPoints;
-        cloudOfPoints = Geometry::generatePointsIn(
-            nbPoints, { cartesianGrid.getLeftBottomVertex(), cartesianGrid.getRightTopVertex() });
-    } else {
-        std::size_t nbPoints;
-        double xl, xr, yb, yt;
-        ibuffer >> xl >> yb >> xr >> yt >> nbPoints;
-        cloudOfPoints =
-            Geometry::generatePointsIn(nbPoints, { point { xl, yb }, point { xr, yt } });
-    }
-    // Lit le nombre de vortex :
-    input.getline(buffer, maxBuffer); // Relit un commentaire
-    input.getline(buffer, maxBuffer); // Lit le nombre de vortex
-    sbuffer = std::string(buffer, maxBuffer);
-    ibuffer = std::stringstream(sbuffer);
-    try {
-        ibuffer >> nbVortices;
-    } catch (std::ios_base::failure & err) {
-        std::cout << "Error " << err.what() << " found" << std::endl;
-        std::cout << "Read line : " << sbuffer << std::endl;
-        throw err;
+/**
+ * @brief Event loop of the screen process
+ *
+ * @param ftle If not null, FTLE field displayed in place of the velocity field
+ * @param replay If not null, session replayed by the simulation process : the
+ * keyboard can only close the window
+ */
+void runScreenProcess(const Options & options,
+                      MPI_Comm comm,
+                      Simulation::SharedFrame & shared,
+                      Simulation::Vortices & vortices,
+                      bool isMobile,
+                      Numeric::CartesianGridOfSpeed & grid,
+                      Geometry::CloudOfPoints & cloud,
+                      const Numeric::FtleField * ftle,
+                      const Simulation::SessionReplay * replay) {
+    SimulationControl control;
+    UiEvent ui_event = UiEvent::Noop;
+    MPI_Status status;
+    Simulation::FrameChannel channel(comm, SIM_PROCESS);
+
+    Graphisme::Screen myScreen({ options.resx, options.resy },
+                               { grid.getLeftBottomVertex(), grid.getRightTopVertex() });
+    myScreen.setFieldArrows(options.fieldArrows);
+    myScreen.setTrails(options.trails, options.trailLength);
+    Trace::setThreadName("screen");
+
+    while (myScreen.isOpen()) {
+        auto start = std::chrono::system_clock::now();
+        control.advance = false;
+        // on inspecte tous les évènements de la fenêtre qui ont été émis depuis
+        // la précédente itération
+        sf::Event event;
+        {
+            Trace::Scope pollScope("poll events", "ui");
+            while (myScreen.pollEvent(event)) {
+                ui_event = translateEvent(myScreen, event);
+                if (ui_event == UiEvent::Noop || (replay && !(ui_event == UiEvent::CloseWindow)))
+                    continue;
+                DEBUG(ui_event, "[0] sending");
+                {
+                    Trace::Scope scope("send order", "mpi");
+                    ui_event.send(SIM_PROCESS, comm);
+                }
+                control.apply(ui_event);
+                // évènement "fermeture demandée" : on ferme la fenêtre
+                if (ui_event == UiEvent::CloseWindow)
+                    myScreen.close();
+            }
+        }
+
+        if (shared.isShared()) {
+            // on affiche sur place le dernier état publié
+            if (shared.update() && isMobile)
+                shared.readVortices(vortices);
+            if (replay)
+                control.dt = replay->controlAt(shared.frontStep()).dt;
+            if (myScreen.isOpen())
+                drawFrame(myScreen, shared.frontGrid(), vortices, shared.frontCloud(),
+                          control.dt, start, ftle);
+            continue;
+        }
+
+        // we don't have to receive every time ; the steps of a replayed
+        // session are only known by the simulation process
+        if (replay ? channel.hasFrame() : control.mustStep() && !control.closing) {
+            channel.recv(vortices, grid, cloud);
+            if (replay)
+                control.dt = replay->controlAt(channel.header().step).dt;
+        }
+
+        if (myScreen.isOpen())
+            drawFrame(myScreen, grid, vortices, cloud, control.dt, start, ftle);
     }
-    Simulation::Vortices vortices(
-        nbVortices, { cartesianGrid.getLeftBottomVertex(), cartesianGrid.getRightTopVertex() });
-    input.getline(buffer, maxBuffer); // Relit un commentaire
-    for (std::size_t iVortex = 0; iVortex < nbVortices; ++iVortex) {
-        input.getline(buffer, maxBuffer);
-        double x, y, force;
-        std::string sbuffer(buffer, maxBuffer);
-        std::stringstream ibuffer(sbuffer);
-        ibuffer >> x >> y >> force;
-        vortices.setVortex(iVortex, point { x, y }, force);
+
+    // Le processus de calcul a pu commencer des pas de temps avant de
+    // recevoir l'ordre de fermeture : on reçoit tout ce qu'il envoie jusqu'à
+    // son accusé de réception (l'ordre des messages est préservé)
+    while (true) {
+        MPI_Probe(SIM_PROCESS, MPI_ANY_TAG, comm, &status);
+        if (status.MPI_TAG == UiEvent::TAG) {
+            ui_event.recv(SIM_PROCESS, comm, &status);
+            break;
+        } else {
+            channel.recv(vortices, grid, cloud);
+        }
     }
-    input.getline(buffer, maxBuffer); // Relit un commentaire
-    input.getline(buffer, maxBuffer); // Lit le mode de déplacement des vortex
-    sbuffer = std::string(buffer, maxBuffer);
-    ibuffer = std::stringstream(sbuffer);
-    ibuffer >> isMobile;
-    return std::make_tuple(vortices, isMobile, cartesianGrid, cloudOfPoints);
 }
 
-int main(int argc, char * argv[]) {
-    const char * filename;
-    if (argc == 1) {
-        std::cout << "Usage : vortexsimulator <nom fichier configuration>" << std::endl;
-        return EXIT_FAILURE;
-    }
+/**
+ * @brief Orders of the session replayed at step t_step, if it is not over
+ */
+void replayOrders(std::optional<Simulation::SessionReplay> & t_replay,
+                  std::size_t t_step,
+                  SimulationControl & t_control) {
+    if (t_replay && !t_replay->isOver() && !t_replay->apply(t_step, t_control))
+        std::cout << "[replay] " << *t_replay << std::endl;
+}
 
-    filename = argv[1];
-    std::ifstream fich(filename);
-    auto config = readConfigFile(fich);
-    fich.close();
+/**
+ * @brief Computation loop of the simulation process
+ *
+ * @param replay If set, session whose orders are applied at their recorded
+ * steps
+ */
+void runSimulationProcess(const Options & options,
+                          MPI_Comm comm,
+                          Simulation::SharedFrame & shared,
+                          Simulation::Vortices & vortices,
+                          bool isMobile,
+                          Numeric::CartesianGridOfSpeed & grid,
+                          Geometry::CloudOfPoints & cloud,
+                          Simulation::ParticleSources & sources,
+                          std::optional<Simulation::SessionReplay> replay) {
+    SimulationControl control;
+    UiEvent ui_event = UiEvent::Noop;
+    MPI_Status status;
 
-    std::size_t resx = 800, resy = 600;
-    if (argc > 3) {
-        resx = std::stoull(argv[2]);
-        resy = std::stoull(argv[3]);
+    Numeric::StepPipeline pipeline;
+    pipeline.setScheme(options.scheme);
+    pipeline.setTimeInterpolation(options.interpolateField);
+    pipeline.setVelocitySource(options.particleVelocity);
+    pipeline.setLazyField(options.lazyField);
+    grid.setTiledLayout(options.tiledField);
+    if (sources.isActive())
+        pipeline.setSources(&sources);
+    std::optional<Simulation::MixingStatistics> statistics;
+    std::optional<Simulation::MixingLog> mixingLog;
+    if (options.mixingPeriod > 0) {
+        statistics.emplace(cloud, grid, options.mixingPeriod);
+        mixingLog.emplace(options.mixingLog, options.mixingHistogram);
+        pipeline.setMixingStatistics(&*statistics);
+    }
+    std::optional<Simulation::SessionRecorder> recorder;
+    if (!options.recordSession.empty())
+        recorder.emplace(options.recordSession);
+    Simulation::FrameChannel channel(comm, SCREEN_PROCESS);
+    std::size_t iStep = 0;
+    double time = 0.;
+    // Le dernier état des particules est-il le dernier publié ?
+    bool isCloudPublished = true;
+    if (!shared.isShared()) {
+        // L'envoi de l'image commence dès que le nouvel état est complet
+        pipeline.onFrameReady([&](const Simulation::Vortices & t_vortices,
+                                  const Numeric::CartesianGridOfSpeed & t_grid,
+                                  const Geometry::CloudOfPoints & t_cloud) {
+            Simulation::FrameHeader header;
+            header.step = iStep;
+            header.dt = control.dt;
+            header.time = time;
+            header.hasField = isMobile;
+            channel.startSend(header, t_vortices, t_grid, t_cloud);
+        });
     }
 
-    if (MPI_Init(&argc, &argv) != MPI_SUCCESS) {
-        return -1;
+    Trace::setThreadName("simulation");
+    int flag;
+    while (!control.closing) {
+        control.advance = false;
+
+        MPI_Iprobe(SCREEN_PROCESS, UiEvent::TAG, comm, &flag, &status);
+        if (flag) {
+            {
+                Trace::Scope scope("recv order", "mpi");
+                ui_event.recv(SCREEN_PROCESS, comm, &status);
+            }
+            DEBUG(ui_event, "[1] Received ui event");
+            control.apply(ui_event);
+            if (recorder)
+                recorder->record(iStep, ui_event);
+            if (control.closing) {
+                DEBUG(ui_event, "[1] breaking");
+                ui_event.send(SCREEN_PROCESS, comm);
+                break;
+            }
+        }
+        replayOrders(replay, iStep, control);
+
+        if (!control.mustStep())
+            continue;
+
+        ++iStep;
+        time += control.dt;
+        // Un pas demandé explicitement est toujours affiché
+        bool isDisplayFrame = control.advance || iStep % options.frameInterval == 0;
+        if (shared.isShared()) {
+            // Les nouvelles positions d'une image affichée sont calculées
+            // directement dans la mémoire partagée, celles des pas
+            // intermédiaires dans cloud
+            const Geometry::CloudOfPoints & input =
+                isCloudPublished ? shared.lastPublishedCloud() : cloud;
+            if (isDisplayFrame) {
+                pipeline.step(control.dt, grid, vortices, input, shared.backCloud(), isMobile);
+                shared.publish(vortices, grid, isMobile, iStep);
+            } else if (isCloudPublished) {
+                pipeline.step(control.dt, grid, vortices, input, cloud, isMobile, false);
+            } else {
+                pipeline.step(control.dt, grid, vortices, cloud, isMobile, false);
+            }
+            isCloudPublished = isDisplayFrame;
+        } else {
+            pipeline.step(control.dt, grid, vortices, cloud, isMobile, isDisplayFrame);
+            // Les tampons envoyés ne doivent pas être modifiés avant la fin
+            // de l'envoi
+            channel.waitSend();
+        }
+        if (mixingLog)
+            mixingLog->write(*statistics);
+        if (options.timings)
+            std::cout << "[timings] step " << iStep << " : " << pipeline.timings() << std::endl;
     }
+}
 
-    MPI_Comm comm = MPI_COMM_WORLD;
-    MPI_Comm_set_errhandler(comm, MPI_ERRORS_ARE_FATAL);
-    int rank = -1, size = -1;
-    MPI_Comm_rank(comm, &rank);
-    MPI_Comm_size(comm, &size);
+/**
+ * @brief Computation loop of the simulation processes when there are several
+ * of them
+ *
+ * The particles are split between the processes of t_computeComm and
+ * balanced according to their speeds (see Simulation::ParticleBalancer). The
+ * vortices and the velocity field are computed by every process. The first
+ * one (SIM_PROCESS) talks to the screen : it forwards the orders of the user
+ * to the other ones and sends the frames, whose particles are first gathered
+ * from every process. It also records or replays the session.
+ */
+void runDistributedSimulation(const Options & options,
+                              MPI_Comm comm,
+                              MPI_Comm computeComm,
+                              Simulation::SharedFrame & shared,
+                              Simulation::Vortices & vortices,
+                              bool isMobile,
+                              Numeric::CartesianGridOfSpeed & grid,
+                              Geometry::CloudOfPoints & cloud,
+                              std::optional<Simulation::SessionReplay> replay) {
+    SimulationControl control;
+    UiEvent ui_event = UiEvent::Noop;
+    MPI_Status status;
+    int computeRank;
+    MPI_Comm_rank(computeComm, &computeRank);
+    bool isRoot = computeRank == 0;
 
-    if (size != 2) {
-        if (rank == SCREEN_PROCESS)
-            std::cerr << "The program must be launched on two nodes!" << std::endl;
-        return -1;
+    Numeric::StepPipeline pipeline;
+    pipeline.setScheme(options.scheme);
+    pipeline.setTimeInterpolation(options.interpolateField);
+    pipeline.setVelocitySource(options.particleVelocity);
+    pipeline.setLazyField(options.lazyField);
+    grid.setTiledLayout(options.tiledField);
+    Simulation::ParticleBalancer balancer(computeComm, cloud.numberOfPoints(),
+                                          options.balancePeriod);
+    Geometry::CloudOfPoints points = balancer.localPoints(cloud);
+    std::optional<Simulation::SessionRecorder> recorder;
+    if (isRoot && !options.recordSession.empty())
+        recorder.emplace(options.recordSession);
+    Simulation::FrameChannel channel(comm, SCREEN_PROCESS);
+    std::size_t iStep = 0;
+    double time = 0.;
+
+    Trace::setThreadName("simulation");
+    int flag;
+    while (true) {
+        if (isRoot) {
+            control.advance = false;
+            MPI_Iprobe(SCREEN_PROCESS, UiEvent::TAG, comm, &flag, &status);
+            if (flag) {
+                Trace::Scope scope("recv order", "mpi");
+                ui_event.recv(SCREEN_PROCESS, comm, &status);
+                control.apply(ui_event);
+                if (recorder)
+                    recorder->record(iStep, ui_event);
+            }
+            if (!control.closing)
+                replayOrders(replay, iStep, control);
+            if (!control.closing && !control.mustStep())
+                continue;
+        }
+        // Les autres processus de calcul suivent les ordres du premier
+        {
+            Trace::Scope scope("bcast orders", "mpi");
+            MPI_Bcast(&control, sizeof(control), MPI_BYTE, 0, computeComm);
+        }
+        if (control.closing) {
+            if (isRoot)
+                ui_event.send(SCREEN_PROCESS, comm);
+            break;
+        }
+
+        ++iStep;
+        time += control.dt;
+        bool isDisplayFrame = control.advance || iStep % options.frameInterval == 0;
+        pipeline.step(control.dt, grid, vortices, points, isMobile, isDisplayFrame);
+        const auto & particles = pipeline.timings().particles;
+        balancer.record(particles.end - particles.begin);
+
+        if (isDisplayFrame) {
+            Geometry::CloudOfPoints * all = nullptr;
+            if (isRoot)
+                all = shared.isShared() ? &shared.backCloud() : &cloud;
+            balancer.gather(points, all);
+            if (isRoot && shared.isShared()) {
+                shared.publish(vortices, grid, isMobile, iStep);
+            } else if (isRoot) {
+                Simulation::FrameHeader header;
+                header.step = iStep;
+                header.dt = control.dt;
+                header.time = time;
+                header.hasField = isMobile;
+                channel.startSend(header, vortices, grid, cloud);
+                channel.waitSend();
+            }
+        }
+
+        if (balancer.balance(points) && isRoot)
+            std::cout << "[balance] step " << iStep << " : " << balancer << std::endl;
+        if (options.timings)
+            std::cout << "[timings] rank " << computeRank << " step " << iStep << " : "
+                      << pipeline.timings() << std::endl;
     }
+}
 
-    if (rank == SCREEN_PROCESS) {
-        std::cout << "######## Vortex simulator ########" << std::endl << std::endl;
-        std::cout << "Press P for play animation " << std::endl;
-        std::cout << "Press S to stop animation" << std::endl;
-        std::cout << "Press right cursor to advance step by step in time" << std::endl;
-        std::cout << "Press down cursor to halve the time step" << std::endl;
-        std::cout << "Press up cursor to double the time step" << std::endl;
+int main(int argc, char * argv[]) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (std::exception & err) {
+        std::cout << err.what() << std::endl;
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    // Avant toute allocation des particules et du champ
+    Memory::placement() = { .firstTouch = options.firstTouch, .hugePages = options.hugePages };
+    if (!options.traceFile.empty())
+        Trace::start(options.traceCapacity);
+    if (options.memoryBenchmark > 0)
+        return runMemoryBenchmark(options.memoryBenchmark);
+    if (!options.connect.empty()) {
+        Trace::setProcessName("viewer");
+        int status = runRemoteViewer(options);
+        Trace::write(options.traceFile, MPI_COMM_NULL);
+        return status;
     }
 
-    auto vortices = std::get<0>(config);
-    auto isMobile = std::get<1>(config);
-    auto grid = std::get<2>(config);
-    auto cloud = std::get<3>(config);
+    Simulation::Scenario scenario;
+    try {
+        scenario = Simulation::readScenario(options.configFile);
+    } catch (std::runtime_error & err) {
+        std::cerr << err.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    auto & vortices = scenario.vortices;
+    bool isMobile = scenario.isMobile;
+    auto & grid = scenario.grid;
+    auto & cloud = scenario.cloud;
+    auto & sources = scenario.sources;
 
     grid.updateVelocityField(vortices);
 
-    bool animate = false;
-    double dt = 0.1;
-    bool advance = false;
-
-    UiEvent ui_event = UiEvent::Noop;
-    MPI_Status status;
+    std::optional<Simulation::SessionReplay> replay;
+    if (!options.replaySession.empty()) {
+        try {
+            replay.emplace(options.replaySession);
+        } catch (std::runtime_error & err) {
+            std::cerr << err.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
 
-    if (rank == SCREEN_PROCESS) {
-        Graphisme::Screen myScreen({ resx, resy },
-                                   { grid.getLeftBottomVertex(), grid.getRightTopVertex() });
+    if (options.precisionReport > 0)
+        return runPrecisionReport(options.precisionReport, options.scheme, vortices, isMobile,
+                                  grid, cloud);
+    if (options.gridBenchmark > 0)
+        return runGridBenchmark(options.gridBenchmark, options.scheme, vortices, grid);
+    if (options.accuracyBenchmark > 0.)
+        return runAccuracyBenchmark(options.accuracyBenchmark, options.errorBudget,
+                                    options.accuracyOutput, vortices, isMobile, grid, cloud);
 
-        while (myScreen.isOpen()) {
-            auto start = std::chrono::system_clock::now();
-            advance = false;
-            // on inspecte tous les évènements de la fenêtre qui ont été émis depuis
-            // la précédente itération
-            sf::Event event;
-            while (myScreen.pollEvent(event)) {
-                // évènement "fermeture demandée" : on ferme la fenêtre
-                if (event.type == sf::Event::Closed) {
-                    DEBUG("[0] sending CLOSE");
-                    ui_event = UiEvent::CloseWindow;
-                    ui_event.send(SIM_PROCESS, comm);
-                    DEBUG("[0] sent!");
+    if (options.mixingPeriod > 0 && sources.isActive()) {
+        std::cerr << "Mixing statistics are not available with particle sources!" << std::endl;
+        return EXIT_FAILURE;
+    }
 
-                    myScreen.close();
-                } else if (event.type == sf::Event::Resized) {
-                    // on met à jour la vue, avec la nouvelle taille de la fenêtre
-                    myScreen.resize(event);
-                } else if (sf::Keyboard::isKeyPressed(sf::Keyboard::P)) {
-                    DEBUG(animate, "[0] sending START");
-                    ui_event = UiEvent::AnimationStart;
-                    ui_event.send(SIM_PROCESS, comm);
-                    animate = true;
-                    DEBUG(animate, "[0] sent!");
-                } else if (sf::Keyboard::isKeyPressed(sf::Keyboard::S)) {
-                    DEBUG(animate, "[0] sending STOP");
-                    ui_event = UiEvent::AnimationStop;
-                    ui_event.send(SIM_PROCESS, comm);
-                    animate = false;
-                    DEBUG(animate, "[0] sent!");
-                } else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up)) {
-                    DEBUG(dt, "[0] sending TIMESTEP_INCREMENT");
-                    ui_event = UiEvent::TimestepIncrement;
-                    ui_event.send(SIM_PROCESS, comm);
-                    dt *= 2;
-                    DEBUG(dt, "[0] sent!");
-                } else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down)) {
-                    DEBUG(dt, "[0] sending TIMESTEP_DECREMENT");
-                    ui_event = UiEvent::TimestepDecrement;
-                    ui_event.send(SIM_PROCESS, comm);
-                    dt /= 2;
-                    DEBUG(dt, "[0] sent!");
-                } else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) {
-                    DEBUG(advance, "[0] sending ADVANCE");
-                    ui_event = UiEvent::Advance;
-                    ui_event.send(SIM_PROCESS, comm);
-                    advance = true;
-                    DEBUG(advance, "[0] sent!");
-                }
-            }
+    // Champ FTLE de l'état initial, réparti entre les processus de t_comm et
+    // écrit par le premier d'entre eux
+    bool hasFtle = options.ftleDuration != 0.;
+    auto computeInitialFtle = [&](MPI_Comm t_comm) {
+        auto start = std::chrono::steady_clock::now();
+        auto ftle = Numeric::computeFtle(options.ftleDuration, SimulationControl {}.dt,
+                                         options.scheme, vortices, isMobile, grid,
+                                         options.ftleResolution, t_comm);
+        std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+        if (!ftle.values.empty()) {
+            std::ofstream output(options.ftleOutput);
+            output << ftle;
+            std::cout << "FTLE field : " << ftle.width << " x " << ftle.height
+                      << " seeds, integration time " << ftle.duration << ", computed in "
+                      << seconds.count() << " s, written in " << options.ftleOutput << std::endl;
+        }
+        return ftle;
+    };
 
-            // we don't have to receive every time
-            if (animate || advance) {
-                if (isMobile) {
-                    vortices.recv(SIM_PROCESS, comm, &status);
-                    grid.recv(SIM_PROCESS, comm, &status);
-                }
-                cloud.recv(SIM_PROCESS, comm, &status);
-            }
+    if (options.threaded || options.offscreenSteps > 0 || !options.serve.empty()) {
+        // Mode mono-processus : pas d'appel à MPI
+        std::optional<Numeric::FtleField> ftle;
+        if (hasFtle) {
+            ftle = computeInitialFtle(MPI_COMM_NULL);
+            if (!options.ftleDisplay)
+                return EXIT_SUCCESS;
+        }
+        const Numeric::FtleField * displayedFtle = ftle ? &*ftle : nullptr;
+        int status;
+        if (!options.serve.empty()) {
+            // Le champ FTLE n'est pas transmis aux spectateurs
+            Trace::setProcessName("server");
+            status = runServer(options, vortices, isMobile, grid, cloud, sources);
+        } else if (options.offscreenSteps > 0) {
+            Trace::setProcessName("offscreen");
+            status = runOffscreen(options, vortices, isMobile, grid, cloud, sources,
+                                  displayedFtle, replay);
+        } else {
+            Trace::setProcessName("threaded");
+            status = runThreaded(options, vortices, isMobile, grid, cloud, sources,
+                                 displayedFtle, replay);
+        }
+        Trace::write(options.traceFile, MPI_COMM_NULL);
+        return status;
+    }
 
-            myScreen.clear(sf::Color::Black);
-            std::string strDt = std::string("Time step : ") + std::to_string(dt);
-            myScreen.drawText(
-                strDt, Geometry::Point<double> { 50, double(myScreen.getGeometry().second - 96) });
+    // Les envois du processus de calcul sont faits depuis des tâches OpenMP,
+    // mais jamais simultanément (cf. StepPipeline)
+    int provided;
+    if (MPI_Init_thread(&argc, &argv, MPI_THREAD_SERIALIZED, &provided) != MPI_SUCCESS) {
+        return -1;
+    }
+    if (provided < MPI_THREAD_SERIALIZED) {
+        std::cerr << "MPI_THREAD_SERIALIZED is not supported by the MPI library!" << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
 
-            myScreen.displayVelocityField(grid, vortices);
-            myScreen.displayParticles(grid, vortices, cloud);
+    MPI_Comm comm = MPI_COMM_WORLD;
+    MPI_Comm_set_errhandler(comm, MPI_ERRORS_ARE_FATAL);
+    int rank = -1, size = -1;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    Trace::synchronize(comm);
+    Trace::setProcessName(rank == SCREEN_PROCESS ? "screen" : "simulation");
 
-            auto end = std::chrono::system_clock::now();
-            std::chrono::duration<double> diff = end - start;
-            std::string str_fps = std::string("FPS : ") + std::to_string(1. / diff.count());
-            myScreen.drawText(str_fps, Geometry::Point<double> {
-                                           300, double(myScreen.getGeometry().second - 96) });
-            myScreen.display();
+    // Calculé par tous les processus, rassemblé sur celui de l'affichage
+    Numeric::FtleField ftle;
+    if (hasFtle) {
+        ftle = computeInitialFtle(comm);
+        if (!options.ftleDisplay) {
+            MPI_Finalize();
+            return EXIT_SUCCESS;
         }
     }
 
-    if (rank == SIM_PROCESS) {
-        int flag;
-        while (ui_event != UiEvent::CloseWindow) {
-            advance = false;
+    if (size < 2) {
+        if (rank == SCREEN_PROCESS)
+            std::cerr << "The program must be launched on at least two nodes!" << std::endl;
+        return -1;
+    }
+    if (size > 2 && sources.isActive()) {
+        if (rank == SCREEN_PROCESS)
+            std::cerr << "Particle sources need a single simulation process!" << std::endl;
+        MPI_Finalize();
+        return -1;
+    }
+    if (size > 2 && options.mixingPeriod > 0) {
+        if (rank == SCREEN_PROCESS)
+            std::cerr << "Mixing statistics need a single simulation process!" << std::endl;
+        MPI_Finalize();
+        return -1;
+    }
+    // Processus de calcul, entre lesquels les particules sont réparties
+    MPI_Comm computeComm;
+    MPI_Comm_split(comm, rank == SCREEN_PROCESS ? MPI_UNDEFINED : 0, rank, &computeComm);
 
-            MPI_Iprobe(SCREEN_PROCESS, UiEvent::TAG, comm, &flag, &status);
-            if (flag) {
-                ui_event.recv(SCREEN_PROCESS, comm, &status);
-                DEBUG(ui_event, "[1] Received ui event");
-                if (ui_event == UiEvent::Advance) {
-                    advance = true;
-                } else if (ui_event == UiEvent::AnimationStart) {
-                    animate = true;
-                } else if (ui_event == UiEvent::AnimationStop) {
-                    animate = false;
-                } else if (ui_event == UiEvent::TimestepIncrement) {
-                    dt *= 2;
-                } else if (ui_event == UiEvent::TimestepDecrement) {
-                    dt /= 2;
-                } else if (ui_event == UiEvent::CloseWindow) {
-                    DEBUG(rank, "[1] breaking");
-                    break;
-                }
-            }
+    if (rank == SCREEN_PROCESS)
+        printKeyboardHelp();
 
-            if (animate || advance) {
-                if (isMobile) {
-                    cloud = Numeric::solve_RK4_movable_vortices(dt, grid, vortices, cloud);
-                    vortices.send(SCREEN_PROCESS, comm);
-                    grid.send(SCREEN_PROCESS, comm);
-                } else {
-                    cloud = Numeric::solve_RK4_fixed_vortices(dt, grid, cloud);
-                }
-                cloud.send(SCREEN_PROCESS, comm);
-            }
+    // Si les deux processus sont sur le même nœud, l'état de la simulation est
+    // échangé par mémoire partagée plutôt que par messages
+    {
+        Simulation::SharedFrame shared(comm, SIM_PROCESS, SCREEN_PROCESS, options.sharedMemory,
+                                       vortices, grid, cloud, sources.capacity());
+        if (rank == SCREEN_PROCESS) {
+            if (shared.isShared())
+                std::cout << "Screen and simulation share memory" << std::endl;
+            runScreenProcess(options, comm, shared, vortices, isMobile, grid, cloud,
+                             hasFtle ? &ftle : nullptr, replay ? &*replay : nullptr);
         }
+        if (rank != SCREEN_PROCESS && size == 2)
+            runSimulationProcess(options, comm, shared, vortices, isMobile, grid, cloud,
+                                 sources, replay);
+        if (rank != SCREEN_PROCESS && size > 2)
+            runDistributedSimulation(options, comm, computeComm, shared, vortices, isMobile,
+                                     grid, cloud, replay);
     }
+    if (computeComm != MPI_COMM_NULL)
+        MPI_Comm_free(&computeComm);
 
     MPI_Barrier(comm);
+    Trace::write(options.traceFile, comm);
     MPI_Finalize();
     return EXIT_SUCCESS;
 }